@@ -0,0 +1,197 @@
+/*
+ * Charge WifiAirtimeEnergyModel hands a battery against the airtime of the
+ * PHY it follows.
+ *
+ * Two Wi-Fi nodes DISTANCE_M apart, the first echoing UDP packets off the
+ * second every INTERVAL for DURATION_S seconds. The radio of the first is
+ * charged from a GenericBatteryModel (updated every second) in one run and
+ * from a PredictiveBatteryModel in the other, and both batteries are also
+ * updated at irregular times, 1 us to 1 s apart from a fixed seed, as the
+ * other device models of a drone would. The reference charge is the sum of
+ * current x duration over the intervals the "State" trace logs, plus the
+ * state in progress at the end.
+ *
+ * Fails when the charge drained plus the one the model still owes differs
+ * from the reference by more than CHARGE_TOLERANCE relative, when the owed
+ * charge passes OWED_TOLERANCE_AS, or when a reported current leaves the
+ * range of the state currents (a whole interval booked into a short window).
+ *
+ * airtime-check
+ */
+#include "../energy/predictive-battery-model.h"
+#include "../wifi/airtime-energy-model.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/energy-module.h"
+#include "ns3/generic-battery-model-helper.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace ns3;
+
+#define DISTANCE_M 10
+#define INTERVAL MilliSeconds(5)
+#define DURATION_S 20
+
+// Relative difference of drained plus owed against the airtime charge,
+// GenericBatteryModel rounds the charge of every update to a Time (1e-9 A s)
+#define CHARGE_TOLERANCE 1e-7
+// A s the predictive battery may trail the airtime by
+#define OWED_TOLERANCE_AS 0.05
+
+struct Run {
+    double airtime = 0;        //!< A s, from the "State" trace
+    Time loggedUntil;
+    double drained = 0;        //!< A s, from the battery
+    double owed = 0;
+    double lowest = 1e9;       //!< Reported currents
+    double highest = 0;
+    uint32_t updates = 0;
+};
+
+static double drainedCapacity(Ptr<EnergySource> source) {
+    Ptr<PredictiveBatteryModel> predictive = DynamicCast<PredictiveBatteryModel>(source);
+    if (predictive) {
+        return predictive->GetDrainedCapacity();
+    }
+    return DynamicCast<GenericBatteryModel>(source)->GetDrainedCapacity();
+}
+
+static void stateLogged(Ptr<WifiAirtimeEnergyModel> radio, Run* run, Time start, Time duration, WifiPhyState state) {
+    Time end = std::min(start + duration, Seconds(DURATION_S));
+    if (end > start) {
+        run->airtime += radio->GetStateA(state) * (end - start).GetSeconds();
+    }
+    run->loggedUntil = std::max(run->loggedUntil, start + duration);
+}
+
+// Every battery update, the periodic ones and those of update()
+static void updated(Ptr<WifiAirtimeEnergyModel> radio, Run* run, double, double) {
+    run->lowest = std::min(run->lowest, radio->GetReportedCurrentA());
+    run->highest = std::max(run->highest, radio->GetReportedCurrentA());
+    run->updates++;
+}
+
+static void update(Ptr<EnergySource> source) {
+    source->UpdateEnergySource();
+}
+
+static void finish(Ptr<EnergySource> source, Ptr<WifiAirtimeEnergyModel> radio, Ptr<WifiPhy> phy, Run* run) {
+    source->UpdateEnergySource();
+    if (run->loggedUntil < Simulator::Now()) {
+        run->airtime += radio->GetStateA(phy->GetState()->GetState()) *
+                        (Simulator::Now() - run->loggedUntil).GetSeconds();
+    }
+    run->drained = drainedCapacity(source) * 3600;
+    run->owed = radio->GetOwedCharge();
+    Simulator::Stop();
+}
+
+static Run simulate(bool predictive) {
+    Run run;
+    NodeContainer nodes;
+    nodes.Create(2);
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    positions->Add(Vector(0, 0, 0));
+    positions->Add(Vector(DISTANCE_M, 0, 0));
+    mobility.SetPositionAllocator(positions);
+    mobility.Install(nodes);
+
+    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+    YansWifiPhyHelper phy;
+    phy.SetChannel(channel.Create());
+    WifiMacHelper mac;
+    mac.SetType("ns3::AdhocWifiMac");
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211a);
+    NetDeviceContainer devices = wifi.Install(phy, mac, nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper addresses;
+    addresses.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = addresses.Assign(devices);
+
+    UdpEchoServerHelper server(9);
+    server.Install(nodes.Get(1)).Start(Seconds(0));
+    UdpEchoClientHelper client(interfaces.GetAddress(1), 9);
+    client.SetAttribute("MaxPackets", UintegerValue(DURATION_S * 1000));
+    client.SetAttribute("Interval", TimeValue(INTERVAL));
+    client.SetAttribute("PacketSize", UintegerValue(1024));
+    client.Install(nodes.Get(0)).Start(Seconds(0.1));
+
+    Ptr<EnergySource> source;
+    if (predictive) {
+        PredictiveBatteryModelHelper helper;
+        source = helper.Install(nodes.Get(0)).Get(0);
+    } else {
+        GenericBatteryModelHelper helper;
+        helper.Set("PeriodicEnergyUpdateInterval", TimeValue(Seconds(1)));
+        source = helper.Install(nodes.Get(0))->Get(0);
+    }
+    Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice>(devices.Get(0))->GetPhy();
+    Ptr<WifiAirtimeEnergyModel> radio = CreateObject<WifiAirtimeEnergyModel>();
+    radio->SetEnergySource(source);
+    source->AppendDeviceEnergyModel(radio);
+    radio->SetPhy(wifiPhy);
+    wifiPhy->GetState()->TraceConnectWithoutContext("State", MakeBoundCallback(&stateLogged, radio, &run));
+    source->TraceConnectWithoutContext("RemainingEnergy", MakeBoundCallback(&updated, radio, &run));
+
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> exponent(-6, 0);
+    for (double t = 0; t < DURATION_S; t += std::pow(10, exponent(random))) {
+        Simulator::Schedule(Seconds(t), &update, source);
+    }
+    Simulator::Schedule(Seconds(DURATION_S), &finish, source, radio, wifiPhy, &run);
+    Simulator::Run();
+    Simulator::Destroy();
+    return run;
+}
+
+int main() {
+    Ptr<WifiAirtimeEnergyModel> defaults = CreateObject<WifiAirtimeEnergyModel>();
+    double lowest = 1e9;
+    double highest = 0;
+    for (WifiPhyState state : {WifiPhyState::IDLE, WifiPhyState::CCA_BUSY, WifiPhyState::TX, WifiPhyState::RX,
+                               WifiPhyState::SWITCHING, WifiPhyState::SLEEP}) {
+        lowest = std::min(lowest, defaults->GetStateA(state));
+        highest = std::max(highest, defaults->GetStateA(state));
+    }
+
+    Run generic = simulate(false);
+    Run predictive = simulate(true);
+
+    bool passed = true;
+    std::cout << std::setprecision(6) << "State currents " << lowest << " to " << highest << " A" << std::endl;
+    std::cout << "  battery      updates  airtime A s  drained A s   owed A s   rel error  reported A" << std::endl;
+    for (const Run* run : {&generic, &predictive}) {
+        double error = std::fabs(run->drained + run->owed - run->airtime) / run->airtime;
+        std::cout << (run == &generic ? "  periodic  " : "  predictive") << std::setw(9) << run->updates
+                  << std::fixed << std::setprecision(6) << std::setw(13) << run->airtime << std::setw(13)
+                  << run->drained << std::setw(11) << run->owed << std::scientific << std::setprecision(2)
+                  << std::setw(12) << error << std::fixed << std::setprecision(3) << std::setw(7) << run->lowest
+                  << " to " << run->highest << std::defaultfloat << std::endl;
+        if (!(error <= CHARGE_TOLERANCE)) {
+            std::cerr << "Drained plus owed charge differs from the airtime by more than " << CHARGE_TOLERANCE
+                      << std::endl;
+            passed = false;
+        }
+        if (!(std::fabs(run->owed) <= OWED_TOLERANCE_AS)) {
+            std::cerr << "Owed charge past " << OWED_TOLERANCE_AS << " A s" << std::endl;
+            passed = false;
+        }
+        if (run->lowest < lowest - 1e-12 || run->highest > highest + 1e-12) {
+            std::cerr << "Reported current outside the state currents" << std::endl;
+            passed = false;
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/*
+ * PredictiveBatteryModel against the GenericBatteryModel it replaces.
+ *
+ * Both batteries (default Li-ion attributes, GenericBatteryModel updated
+ * every second) feed a SimpleDeviceEnergyModel through the same
+ * piecewise-constant load: LOW_A to HIGH_A held for 5 to 120 s, drawn from
+ * a fixed seed, until past the cutoff and the low battery threshold. Every
+ * SAMPLE_S up to the cutoff the voltage and the drained capacity of both are
+ * compared, as are the times of the low battery and cutoff crossings. The
+ * events of each run are counted.
+ *
+ * Fails past the tolerances below. They follow from the one second update:
+ * GenericBatteryModel charges the interval before a current change at the
+ * new current and only sees a crossing on its next update, the predictive
+ * model charges each interval at its own current and schedules the crossing.
+ *
+ * battery-check
+ */
+#include "../energy/predictive-battery-model.h"
+#include "ns3/core-module.h"
+#include "ns3/energy-module.h"
+#include "ns3/generic-battery-model-helper.h"
+#include "ns3/network-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+#define LOW_A 0.5
+#define HIGH_A 2.5
+#define DURATION_S 6000
+#define SAMPLE_S 10
+
+// Tolerances of the predictive model against the periodic one
+#define VOLTAGE_TOLERANCE_V 0.01
+#define DRAINED_TOLERANCE_AH 0.005
+#define CROSSING_TOLERANCE_S 2.0
+
+// Device recording the first cutoff notification
+class DrainedDevice : public SimpleDeviceEnergyModel {
+public:
+    double drainedAt = -1;
+
+    void HandleEnergyDepletion() override {
+        if (drainedAt < 0) {
+            drainedAt = Simulator::Now().GetSeconds();
+        }
+    }
+};
+
+struct Run {
+    std::vector<double> voltage;
+    std::vector<double> drained;
+    double lowAt = -1;
+    double drainedAt = -1;
+    uint64_t events = 0;
+};
+
+struct Step {
+    double at;
+    double current;
+};
+
+static void setCurrent(Ptr<SimpleDeviceEnergyModel> device, double current) {
+    device->SetCurrentA(current);
+}
+
+static double drainedCapacity(Ptr<EnergySource> source) {
+    Ptr<PredictiveBatteryModel> predictive = DynamicCast<PredictiveBatteryModel>(source);
+    if (predictive) {
+        return predictive->GetDrainedCapacity();
+    }
+    return DynamicCast<GenericBatteryModel>(source)->GetDrainedCapacity();
+}
+
+static void sample(Ptr<EnergySource> source, Run* run) {
+    run->voltage.push_back(source->GetSupplyVoltage());
+    run->drained.push_back(drainedCapacity(source));
+}
+
+// GenericBatteryModel has no low battery trace, its state of charge (in
+// percent) is read at every update instead
+static void genericUpdate(Ptr<GenericBatteryModel> battery, double threshold, Run* run, double, double) {
+    if (run->lowAt < 0 && battery->GetStateOfCharge() <= 100 * threshold) {
+        run->lowAt = Simulator::Now().GetSeconds();
+    }
+}
+
+static void predictiveLow(Run* run, double) {
+    if (run->lowAt < 0) {
+        run->lowAt = Simulator::Now().GetSeconds();
+    }
+}
+
+static Run simulate(const std::vector<Step>& load, bool predictive) {
+    Run run;
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<EnergySource> source;
+    if (predictive) {
+        PredictiveBatteryModelHelper helper;
+        source = helper.Install(node).Get(0);
+        source->TraceConnectWithoutContext("LowBattery", MakeBoundCallback(&predictiveLow, &run));
+    } else {
+        GenericBatteryModelHelper helper;
+        helper.Set("PeriodicEnergyUpdateInterval", TimeValue(Seconds(1)));
+        source = helper.Install(node)->Get(0);
+        Ptr<GenericBatteryModel> battery = DynamicCast<GenericBatteryModel>(source);
+        DoubleValue threshold;
+        battery->GetAttribute("LowBatteryThreshold", threshold);
+        battery->TraceConnectWithoutContext("RemainingEnergy",
+                                            MakeBoundCallback(&genericUpdate, battery, threshold.Get(), &run));
+    }
+
+    Ptr<DrainedDevice> device = CreateObject<DrainedDevice>();
+    device->SetNode(node);
+    device->SetEnergySource(source);
+    source->AppendDeviceEnergyModel(device);
+
+    for (const Step& step : load) {
+        Simulator::Schedule(Seconds(step.at), &setCurrent, device, step.current);
+    }
+    for (int t = SAMPLE_S; t < DURATION_S; t += SAMPLE_S) {
+        // Between two updates of the periodic model
+        Simulator::Schedule(Seconds(t + 0.5), &sample, source, &run);
+    }
+    Simulator::Stop(Seconds(DURATION_S));
+    Simulator::Run();
+    run.drainedAt = device->drainedAt;
+    run.events = Simulator::GetEventCount();
+    Simulator::Destroy();
+    return run;
+}
+
+int main() {
+    std::vector<Step> load;
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> current(LOW_A, HIGH_A);
+    std::uniform_real_distribution<double> hold(5, 120);
+    for (double t = 0; t < DURATION_S; t += hold(random)) {
+        load.push_back({t, current(random)});
+    }
+
+    Run generic = simulate(load, false);
+    Run predictive = simulate(load, true);
+
+    // Up to the cutoff: past it the curve runs into its pole, where the
+    // small difference of drained capacity is a large one of voltage
+    double cutoff = std::min(generic.drainedAt, predictive.drainedAt);
+    double voltageError = 0;
+    double drainedError = 0;
+    for (size_t i = 0; i < std::min(generic.voltage.size(), predictive.voltage.size()); i++) {
+        if ((i + 1) * SAMPLE_S + 0.5 >= cutoff) {
+            break;
+        }
+        voltageError = std::max(voltageError, std::fabs(generic.voltage[i] - predictive.voltage[i]));
+        drainedError = std::max(drainedError, std::fabs(generic.drained[i] - predictive.drained[i]));
+    }
+    double lowError = std::fabs(generic.lowAt - predictive.lowAt);
+    double cutoffError = std::fabs(generic.drainedAt - predictive.drainedAt);
+
+    std::cout << load.size() << " current steps, " << SAMPLE_S << " s samples up to the cutoff" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "                  periodic  predictive" << std::endl;
+    std::cout << "  low battery s " << std::setw(10) << generic.lowAt << std::setw(12) << predictive.lowAt << std::endl;
+    std::cout << "  cutoff s      " << std::setw(10) << generic.drainedAt << std::setw(12) << predictive.drainedAt
+              << std::endl;
+    std::cout << "  events        " << std::setw(10) << generic.events << std::setw(12) << predictive.events
+              << std::endl;
+    std::cout << std::setprecision(4) << "  max |dV| " << voltageError << " V, max |d drained| " << drainedError
+              << " Ah, |d low| " << std::setprecision(2) << lowError << " s, |d cutoff| " << cutoffError << " s"
+              << std::endl;
+
+    bool passed = true;
+    if (generic.drainedAt < 0 || predictive.drainedAt < 0 || generic.lowAt < 0 || predictive.lowAt < 0) {
+        std::cerr << "The load did not take both batteries past low battery and cutoff" << std::endl;
+        passed = false;
+    }
+    if (!(voltageError <= VOLTAGE_TOLERANCE_V && drainedError <= DRAINED_TOLERANCE_AH)) {
+        std::cerr << "Voltage or drained capacity past " << VOLTAGE_TOLERANCE_V << " V / " << DRAINED_TOLERANCE_AH
+                  << " Ah" << std::endl;
+        passed = false;
+    }
+    if (!(lowError <= CROSSING_TOLERANCE_S && cutoffError <= CROSSING_TOLERANCE_S)) {
+        std::cerr << "Low battery or cutoff more than " << CROSSING_TOLERANCE_S << " s apart" << std::endl;
+        passed = false;
+    }
+    if (predictive.events >= generic.events) {
+        std::cerr << "The predictive model ran no fewer events than the periodic one" << std::endl;
+        passed = false;
+    }
+    return passed ? 0 : 1;
+}
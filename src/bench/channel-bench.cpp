@@ -0,0 +1,153 @@
+/*
+ * Wi-Fi channel cost against the node count, YansWifiChannel against
+ * RangeCulledWifiChannel.
+ *
+ * Ad-hoc 802.11b at 1 Mb/s over LogDistance loss (exponent 3.5), the nodes
+ * spread over a square of 60 m per node on average, every node broadcasting
+ * a 100 byte packet per second for DURATION seconds. Both channels see the
+ * same positions and random streams, and culling must not change what is
+ * delivered: the run fails when the received packet counts differ.
+ *
+ * channel-bench [nodes...]      (default 50 200 800)
+ */
+#include "../wifi/range-culled-wifi-channel.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/propagation-module.h"
+#include "ns3/wifi-module.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+// Simulated seconds of every run
+#define DURATION 10
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double eventsPerSecond;
+    double wall;
+    uint64_t received;
+};
+
+static uint64_t received = 0;
+
+static void countRx(std::string, Ptr<const Packet>, const Address&) {
+    received++;
+}
+
+static Result run(uint32_t n, bool culled) {
+    received = 0;
+    NodeContainer nodes;
+    nodes.Create(n);
+
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> coordinate(0, std::sqrt(n) * 60);
+    for (uint32_t i = 0; i < n; i++) {
+        double x = coordinate(random);
+        positions->Add(Vector(x, coordinate(random), 0));
+    }
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(positions);
+    mobility.Install(nodes);
+
+    Ptr<LogDistancePropagationLossModel> loss = CreateObject<LogDistancePropagationLossModel>();
+    loss->SetAttribute("Exponent", DoubleValue(3.5));
+    Ptr<ConstantSpeedPropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel>();
+    YansWifiPhyHelper yansPhy;
+    RangeCulledWifiPhyHelper culledPhy;
+    YansWifiPhyHelper& phy = culled ? culledPhy : yansPhy;
+    if (culled) {
+        Ptr<RangeCulledWifiChannel> channel = CreateObject<RangeCulledWifiChannel>();
+        channel->SetPropagationLossModel(loss);
+        channel->SetPropagationDelayModel(delay);
+        phy.SetChannel(channel);
+    } else {
+        Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel>();
+        channel->SetPropagationLossModel(loss);
+        channel->SetPropagationDelayModel(delay);
+        phy.SetChannel(channel);
+    }
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211b);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager", "DataMode", StringValue("DsssRate1Mbps"),
+                                 "ControlMode", StringValue("DsssRate1Mbps"));
+    WifiMacHelper mac;
+    mac.SetType("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install(phy, mac, nodes);
+    wifi.AssignStreams(devices, 0);
+
+    PacketSocketHelper packetSocket;
+    packetSocket.Install(nodes);
+    for (uint32_t i = 0; i < n; i++) {
+        PacketSocketAddress broadcast;
+        broadcast.SetSingleDevice(devices.Get(i)->GetIfIndex());
+        broadcast.SetPhysicalAddress(devices.Get(i)->GetBroadcast());
+        broadcast.SetProtocol(1);
+        Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient>();
+        client->SetRemote(broadcast);
+        client->SetAttribute("Interval", TimeValue(Seconds(1)));
+        client->SetAttribute("PacketSize", UintegerValue(100));
+        client->SetAttribute("MaxPackets", UintegerValue(0));
+        client->SetStartTime(MilliSeconds(i * 7 % 1000));
+        nodes.Get(i)->AddApplication(client);
+
+        PacketSocketAddress local;
+        local.SetSingleDevice(devices.Get(i)->GetIfIndex());
+        local.SetProtocol(1);
+        Ptr<PacketSocketServer> server = CreateObject<PacketSocketServer>();
+        server->SetLocal(local);
+        nodes.Get(i)->AddApplication(server);
+    }
+    Config::Connect("/NodeList/*/ApplicationList/*/$ns3::PacketSocketServer/Rx", MakeCallback(&countRx));
+
+    Simulator::Stop(Seconds(DURATION));
+    auto start = Clock::now();
+    Simulator::Run();
+    Result result;
+    result.wall = std::chrono::duration<double>(Clock::now() - start).count();
+    result.eventsPerSecond = double(Simulator::GetEventCount()) / DURATION;
+    result.received = received;
+    Simulator::Destroy();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {50, 200, 800};
+    }
+
+    bool identical = true;
+    std::cout << "   nodes   Yans ev/sim s  culled ev/sim s   Yans wall s  culled wall s    received" << std::endl;
+    for (uint32_t n : sizes) {
+        Result yans = run(n, false);
+        Result culled = run(n, true);
+        std::cout << std::fixed << std::setw(8) << n << std::setprecision(0) << std::setw(16) << yans.eventsPerSecond
+                  << std::setw(17) << culled.eventsPerSecond << std::setprecision(2) << std::setw(14) << yans.wall
+                  << std::setw(15) << culled.wall << std::setw(12) << yans.received;
+        if (culled.received != yans.received) {
+            std::cout << " != " << culled.received;
+            identical = false;
+        }
+        std::cout << std::endl;
+    }
+    if (!identical) {
+        std::cerr << "RangeCulledWifiChannel delivered a different number of packets" << std::endl;
+        return 1;
+    }
+    return 0;
+}
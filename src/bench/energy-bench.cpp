@@ -0,0 +1,131 @@
+/*
+ * Batch energy kernels against the scalar functions they vectorize.
+ *
+ * P_UAV_batch and calcCompPower_batch are run over COUNT random drones in
+ * structure-of-arrays form (hovering, level, climbing and descending ones,
+ * 4 to 8 propellers) and compared with P_UAV and calcCompPower drone by
+ * drone. The evaluations per second of both paths are reported, the batch
+ * ones vectorized when energy.cpp is built with its CMake flags. Fails when
+ * a batch result is further than TOLERANCE relative from the scalar one.
+ *
+ * For P_UAV the error is taken relative to the magnitude of its terms: the
+ * climb term W*vz is negative while descending and can all but cancel the
+ * other two, where any rounding difference is large relative to the sum.
+ * The error relative to the sum itself is printed beside it.
+ *
+ * energy-bench [rounds]      (default 20)
+ */
+#include "../energy/energy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Drones of every round
+#define COUNT (1 << 20)
+// Relative difference allowed, Omega^1.5 is taken as Omega*sqrt(Omega)
+// and the mass scaled once
+#define TOLERANCE 5e-13
+
+using Clock = std::chrono::steady_clock;
+
+// Evaluations per second of rounds calls of f
+template <typename F>
+static double rate(int rounds, F f) {
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        f();
+    }
+    return double(COUNT) * rounds / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Largest |batch - scalar| / scale
+static double maxRelativeError(const std::vector<double>& batch, const std::vector<double>& scalar,
+                               const std::vector<double>& scale) {
+    double worst = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        worst = std::max(worst, std::fabs(batch[i] - scalar[i]) / std::max(1e-12, std::fabs(scale[i])));
+    }
+    return worst;
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    if (rounds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [rounds]" << std::endl;
+        return 1;
+    }
+
+    std::vector<double> mass(COUNT), drag(COUNT), radius(COUNT), props(COUNT), vx(COUNT), vy(COUNT), vz(COUNT);
+    std::vector<double> y(COUNT), v(COUNT), cycles(COUNT), ops(COUNT), data(COUNT), iters(COUNT);
+    std::mt19937_64 random(1);
+    std::uniform_real_distribution<double> unit(0, 1);
+    for (size_t i = 0; i < COUNT; i++) {
+        mass[i] = 500 + 2000 * unit(random);
+        drag[i] = 0.1 + 0.5 * unit(random);
+        radius[i] = 0.05 + 0.2 * unit(random);
+        props[i] = 4 + (i % 3) * 2;
+        vx[i] = i % 7 == 0 ? 0 : 30 * unit(random);
+        vy[i] = i % 5 == 0 ? 0 : 30 * unit(random);
+        vz[i] = 10 * unit(random) - 5;
+        y[i] = 1e-10 * (1 + unit(random));
+        v[i] = 1 + unit(random);
+        cycles[i] = 1 + 3 * unit(random);
+        ops[i] = 1e5 * (1 + unit(random));
+        data[i] = 10 + 100 * unit(random);
+        iters[i] = 100 + 1000 * unit(random);
+    }
+
+    // |P_level| + |P_vertical| + |P_drag|, the argument convention of P_UAV
+    std::vector<double> terms(COUNT);
+    for (size_t i = 0; i < COUNT; i++) {
+        terms[i] = std::fabs(P_level(mass[i] / 1000, radius[i], props[i], vx[i], vy[i])) +
+                   std::fabs(P_vertical(mass[i] / 1000, vz[i])) +
+                   std::fabs(P_drag(drag[i], radius[i], props[i], vx[i], vy[i]));
+    }
+
+    std::vector<double> scalar(COUNT), batch(COUNT);
+    double moveScalar = rate(rounds, [&] {
+        for (size_t i = 0; i < COUNT; i++) {
+            scalar[i] = P_UAV(mass[i], drag[i], radius[i], props[i], vx[i], vy[i], vz[i]);
+        }
+    });
+    double moveBatch = rate(rounds, [&] {
+        P_UAV_batch(mass.data(), drag.data(), radius.data(), props.data(), vx.data(), vy.data(), vz.data(),
+                    batch.data(), COUNT);
+    });
+    double moveError = maxRelativeError(batch, scalar, terms);
+    double moveResultError = maxRelativeError(batch, scalar, scalar);
+
+    double computeScalar = rate(rounds, [&] {
+        for (size_t i = 0; i < COUNT; i++) {
+            scalar[i] = calcCompPower(y[i], v[i], cycles[i], ops[i], data[i], iters[i]);
+        }
+    });
+    double computeBatch = rate(rounds, [&] {
+        calcCompPower_batch(y.data(), v.data(), cycles.data(), ops.data(), data.data(), iters.data(), batch.data(),
+                            COUNT);
+    });
+    double computeError = maxRelativeError(batch, scalar, scalar);
+
+    std::cout << COUNT << " drones, " << rounds << " rounds" << std::endl;
+    std::cout << "  kernel          scalar M/s   batch M/s  speedup  max rel error" << std::endl;
+    std::cout << "  P_UAV         " << std::fixed << std::setprecision(1) << std::setw(12) << moveScalar / 1e6
+              << std::setw(12) << moveBatch / 1e6 << std::setw(8) << moveBatch / moveScalar << "x" << std::scientific
+              << std::setprecision(2) << std::setw(15) << moveError << "  (" << moveResultError
+              << " of the sum)" << std::endl;
+    std::cout << "  calcCompPower " << std::fixed << std::setprecision(1) << std::setw(12) << computeScalar / 1e6
+              << std::setw(12) << computeBatch / 1e6 << std::setw(8) << computeBatch / computeScalar << "x"
+              << std::scientific << std::setprecision(2) << std::setw(15) << computeError << std::endl;
+
+    if (!(moveError <= TOLERANCE && computeError <= TOLERANCE)) {
+        std::cerr << "Batch kernels differ from the scalar functions by more than " << TOLERANCE << std::endl;
+        return 1;
+    }
+    return 0;
+}
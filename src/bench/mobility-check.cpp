@@ -0,0 +1,214 @@
+/*
+ * CustomMobilityModel segments against the stepped model they replace.
+ *
+ * The reference is the former UpdatePosition, moving the drone once every
+ * UPDATE_S through the climb/snake/descend pattern, run here without the
+ * simulator. Each scenario below flies one CustomMobilityModel (Horizon at
+ * its duration, as ScenarioBuilder sets it) and compares, at every step
+ * k * UPDATE_S, GetPosition with the stepped position, and half a step
+ * later the state, the computation flag and the number of course changes.
+ * The stepped model notified one on every snake step; the segments notify
+ * one when the velocity changes, so the reference counts the steps whose
+ * displacement differs from the previous one, plus the start.
+ *
+ * Fails when a position is further than POSITION_TOLERANCE_M or a state,
+ * flag or count differs. The last scenario ends before the drone lands,
+ * its plan is cut at the horizon.
+ *
+ * mobility-check
+ */
+#include "../mobility/custom-mobility-model.h"
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// m_updateInterval of the stepped model
+#define UPDATE_S 1.0
+#define POSITION_TOLERANCE_M 1e-6
+// Displacements closer than this (m) are the same course
+#define SAME_COURSE_M 1e-9
+
+struct Scenario {
+    double speed;
+    double maxHeight;
+    double turn;
+    Box aoi;
+    Box bounds;
+    Vector start;
+    double duration;
+};
+
+// The former UpdatePosition, its members and its step
+struct SteppedDrone {
+    Vector position;
+    int state = 0;
+    bool start = true;
+    bool atEight = false;
+    bool descend = false;
+    bool direction = true;
+    double tmpStr = -1;
+
+    void step(const Scenario& s) {
+        Vector oldPos = position;
+        Vector tmp = Vector(0.0, 0.0, 0.0);
+        if (atEight) {
+            if (!descend) {
+                tmp.x = s.speed;
+                position = direction ? position + tmp : position - tmp;
+                if (s.bounds.IsInside(position) && start) {
+                    state = s.aoi.IsInside(position) ? 2 : 1;
+                } else {
+                    state = 2;
+                    if (tmpStr <= 0) {
+                        tmpStr = s.turn;
+                    }
+                    position.y = position.y + s.speed;
+                    tmpStr = tmpStr - s.speed;
+                    position = direction ? position - tmp : position + tmp;
+                    if (s.bounds.IsInside(position)) {
+                        state = s.aoi.IsInside(position) ? 2 : 1;
+                        if (tmpStr <= 0) {
+                            start = true;
+                            direction = !direction;
+                        } else {
+                            start = false;
+                        }
+                    } else {
+                        descend = true;
+                        position = oldPos;
+                    }
+                }
+            } else {
+                state = 3;
+                position.z = position.z - s.speed > 0 ? position.z - s.speed : 0;
+            }
+        } else {
+            state = 0;
+            position = position + Vector(0.0, 0.0, 1.0);
+            if (s.maxHeight - position.z < s.speed) {
+                atEight = true;
+            }
+        }
+    }
+};
+
+struct Sample {
+    Vector position;
+    int state;
+    bool compute;
+    uint32_t courseChanges;
+};
+
+static void countCourseChange(uint32_t* count, Ptr<const MobilityModel>) {
+    (*count)++;
+}
+
+static void samplePosition(Ptr<CustomMobilityModel> model, std::vector<Sample>* samples, size_t k) {
+    (*samples)[k].position = model->GetPosition();
+}
+
+static void sampleState(Ptr<CustomMobilityModel> model, const uint32_t* count, std::vector<Sample>* samples,
+                        size_t k) {
+    (*samples)[k].state = model->getState();
+    (*samples)[k].compute = model->getCompState();
+    (*samples)[k].courseChanges = *count;
+}
+
+// Samples 0..steps of the stepped model
+static std::vector<Sample> stepped(const Scenario& s, size_t steps) {
+    std::vector<Sample> samples(steps + 1);
+    SteppedDrone drone;
+    drone.position = s.start;
+    Vector previous;
+    uint32_t courseChanges = 1;
+    for (size_t k = 0; k <= steps; k++) {
+        samples[k].position = drone.position;
+        samples[k].state = drone.state;
+        samples[k].compute = drone.start;
+        Vector from = drone.position;
+        drone.step(s);
+        Vector displacement = drone.position - from;
+        if (k > 0 && CalculateDistance(displacement, previous) >= SAME_COURSE_M) {
+            courseChanges++;
+        }
+        previous = displacement;
+        samples[k].courseChanges = courseChanges;
+    }
+    return samples;
+}
+
+static std::vector<Sample> segments(const Scenario& s, size_t steps) {
+    std::vector<Sample> samples(steps + 1);
+    uint32_t courseChanges = 0;
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<CustomMobilityModel> model = CreateObject<CustomMobilityModel>();
+    model->SetAttribute("maxHeight", DoubleValue(s.maxHeight));
+    model->SetAttribute("AoI", BoxValue(s.aoi));
+    model->SetAttribute("Bounds", BoxValue(s.bounds));
+    model->SetAttribute("AvgVelocity", DoubleValue(s.speed));
+    model->SetAttribute("TurnStrenght", DoubleValue(s.turn));
+    model->SetAttribute("Horizon", TimeValue(Seconds(s.duration)));
+    model->SetPosition(s.start);
+    model->TraceConnectWithoutContext("CourseChange", MakeBoundCallback(&countCourseChange, &courseChanges));
+    node->AggregateObject(model);
+
+    for (size_t k = 0; k <= steps; k++) {
+        Simulator::Schedule(Seconds(k * UPDATE_S), &samplePosition, model, &samples, k);
+        Simulator::Schedule(Seconds((k + 0.5) * UPDATE_S), &sampleState, model, &courseChanges, &samples, k);
+    }
+    Simulator::Stop(Seconds(s.duration));
+    Simulator::Run();
+    Simulator::Destroy();
+    return samples;
+}
+
+int main() {
+    Box wide = Box(0.0, 260.0, 0.0, 260.0, 0.0, 100.0);
+    std::vector<Scenario> scenarios = {
+        {5, 100, 50, Box(0.0, 260.0, 0.0, 260.0, 20.0, 80.0), wide, Vector(10, 10, 0), 3000},
+        {7, 60, 30, Box(50.0, 200.0, 50.0, 200.0, 5.0, 100.0), wide, Vector(100, 20, 0), 3000},
+        {3, 100, 50, Box(0.0, 260.0, 0.0, 260.0, 20.0, 80.0), wide, Vector(10, 10, 0), 200},
+    };
+
+    bool passed = true;
+    std::cout << "  speed  duration s  steps  course changes  max |d position| m  mismatches" << std::endl;
+    for (const Scenario& s : scenarios) {
+        // The last state sample is half a step before the end
+        size_t steps = static_cast<size_t>(s.duration / UPDATE_S) - 1;
+        std::vector<Sample> reference = stepped(s, steps);
+        std::vector<Sample> flown = segments(s, steps);
+
+        double positionError = 0;
+        size_t mismatches = 0;
+        for (size_t k = 0; k <= steps; k++) {
+            double error = CalculateDistance(reference[k].position, flown[k].position);
+            positionError = std::max(positionError, error);
+            if (!(error <= POSITION_TOLERANCE_M) || reference[k].state != flown[k].state ||
+                reference[k].compute != flown[k].compute ||
+                reference[k].courseChanges != flown[k].courseChanges) {
+                if (mismatches == 0) {
+                    std::cerr << "Speed " << s.speed << ", step " << k << ": stepped (" << reference[k].position
+                              << ") state " << reference[k].state << " compute " << reference[k].compute
+                              << " course changes " << reference[k].courseChanges << ", segments ("
+                              << flown[k].position << ") state " << flown[k].state << " compute "
+                              << flown[k].compute << " course changes " << flown[k].courseChanges << std::endl;
+                }
+                mismatches++;
+            }
+        }
+        std::cout << std::fixed << std::setprecision(0) << std::setw(7) << s.speed << std::setw(12) << s.duration
+                  << std::setw(7) << steps
+                  << std::setw(16) << flown[steps].courseChanges << std::scientific << std::setprecision(2)
+                  << std::setw(20) << positionError << std::defaultfloat << std::setw(12) << mismatches
+                  << std::endl;
+        passed = passed && mismatches == 0;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/*
+ * Per-tick power lookups of the drones, memoized against evaluated.
+ *
+ *  - direct: what DroneLogic did every tick, P_UAV for the mobility state
+ *    and calcCompPower from the drone parameters
+ *  - memoized: calcMovePower(state) and calculateComputePower(), reads of
+ *    the PowerProfile built on first use
+ *
+ * Every drone of the fleet (the scenario drone with its weight and speed
+ * spread a little, so that nothing folds into a constant) is asked for all
+ * four states ROUNDS times. The profile build itself, paid once per drone
+ * and again after a setter, is timed on its own. Fails when the two paths
+ * differ by more than TOLERANCE relative.
+ *
+ * power-bench [drones]      (default 1000)
+ */
+#include "../drone/Drone.h"
+#include "../energy/energy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Lookups of every drone and state
+#define ROUNDS 200
+// Relative difference allowed between the batch kernels and the scalar ones
+#define TOLERANCE 5e-13
+
+using Clock = std::chrono::steady_clock;
+
+// P_UAV velocity of a mobility state: climb, cruise, cruise in AoI, descend
+static void stateVelocity(int state, double speed, double& vx, double& vy, double& vz) {
+    vx = state < 3 ? speed : 0;
+    vy = state == 0 ? speed : 0;
+    vz = state == 0 || state == 3 ? speed : 0;
+}
+
+static double direct(const Drone& drone, int state) {
+    double vx, vy, vz;
+    stateVelocity(state, drone.getSpeed(), vx, vy, vz);
+    return P_UAV(drone.getWeight(), drone.getDragCoefficient(), drone.getPropellersRadius(),
+                 drone.getNumbPropellers(), vx, vy, vz) +
+           calcCompPower(drone.getSwitchCapacitance(), drone.getVoltage(), drone.getCpuCycleXop(),
+                         drone.getOpxData(), drone.getNumbTrainDataSet(), drone.getNumLocalIter());
+}
+
+static double memoized(const Drone& drone, int state) {
+    return drone.calcMovePower(state) + drone.calculateComputePower();
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+    if (n == 0) {
+        std::cerr << "Usage: " << argv[0] << " [drones]" << std::endl;
+        return 1;
+    }
+
+    // The drone of scenario/scenario.json
+    std::vector<Drone> drones(n);
+    for (size_t i = 0; i < n; i++) {
+        Drone& drone = drones[i];
+        drone.setWeight(1200.5 + 0.01 * i);
+        drone.setNumbPropellers(4);
+        drone.setPropellersRadius(0.1);
+        drone.setSpeed(15 + 1e-4 * i);
+        drone.setDragCoefficient(0.3);
+        drone.setHardware({{0.0, 1.0, 5.0, 5.0}, {2.0, 3.5, 7.5, 5.0}});
+        drone.setNumLocalIter(10000);
+        drone.setCpuCycleXop(3);
+        drone.setOpxData(200000);
+        drone.setNumbTrainDataSet(60);
+        drone.setSwitchCapacitance(8e-11);
+        drone.setVoltage(1.3);
+        drone.setCpuFreq(1.5);
+    }
+
+    auto start = Clock::now();
+    Drone::computePowerProfiles(drones.data(), n);
+    double buildNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / n;
+
+    double maxError = 0;
+    for (const Drone& drone : drones) {
+        for (int state = 0; state < 4; state++) {
+            double expected = direct(drone, state);
+            maxError = std::max(maxError, std::fabs(memoized(drone, state) - expected) / std::fabs(expected));
+        }
+    }
+
+    double lookups = double(n) * 4 * ROUNDS;
+    double directSum = 0;
+    start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const Drone& drone : drones) {
+            for (int state = 0; state < 4; state++) {
+                directSum += direct(drone, state);
+            }
+        }
+    }
+    double directNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups;
+
+    double memoizedSum = 0;
+    start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const Drone& drone : drones) {
+            for (int state = 0; state < 4; state++) {
+                memoizedSum += memoized(drone, state);
+            }
+        }
+    }
+    double memoizedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lookups;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << n << " drones, " << ROUNDS << " rounds of 4 states" << std::endl;
+    std::cout << "  direct     " << std::setw(8) << directNs << " ns/lookup" << std::endl;
+    std::cout << "  memoized   " << std::setw(8) << memoizedNs << " ns/lookup  (" << directNs / memoizedNs
+              << "x)" << std::endl;
+    std::cout << "  profile    " << std::setw(8) << buildNs << " ns/drone, once" << std::endl;
+    std::cout << std::scientific << std::setprecision(2) << "  max relative error " << maxError
+              << "  (sums " << directSum << " / " << memoizedSum << ")" << std::endl;
+
+    if (!(maxError <= TOLERANCE)) {
+        std::cerr << "Memoized power differs from P_UAV + calcCompPower by more than " << TOLERANCE << std::endl;
+        return 1;
+    }
+    return 0;
+}
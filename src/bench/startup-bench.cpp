@@ -0,0 +1,138 @@
+/*
+ * Scenario startup cost against the fleet size.
+ *
+ * For every size the drones of the base scenario are cycled into a fleet of
+ * that many drones (as sweep.py does for "drones"), written to a temporary
+ * file and loaded twice:
+ *
+ *  - per drone: the former JsonParser::parseJson, every drone opens the file
+ *    and stream-parses all of it before reading its own entry. The cost of
+ *    one drone does not depend on its index, so beyond SAMPLE drones it is
+ *    measured on the first SAMPLE and scaled (marked with a *).
+ *  - one document: a single ScenarioDocument and a view per drone.
+ *
+ * startup-bench <scenario.json> [sizes...]      (default 10 100 1000 10000)
+ */
+#include "../drone/Drone.h"
+#include "../parser/JsonParser.h"
+#include "../parser/ScenarioDocument.h"
+#include "rapidjson/document.h"
+#include "rapidjson/filereadstream.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Drones timed through the per-drone path before scaling
+#define SAMPLE 200
+
+using Clock = std::chrono::steady_clock;
+
+// Base scenario with its "Drones" cycled to count entries, written to path
+static bool writeFleet(const rapidjson::Document& base, int count, const std::string& path, size_t& bytes) {
+    rapidjson::Document fleet;
+    fleet.CopyFrom(base, fleet.GetAllocator());
+    rapidjson::Value& drones = fleet["Drones"];
+    drones.Clear();
+    const rapidjson::Value& source = base["Drones"];
+    for (int i = 0; i < count; i++) {
+        rapidjson::Value drone(source[i % source.Size()], fleet.GetAllocator());
+        drones.PushBack(drone, fleet.GetAllocator());
+    }
+    rapidjson::StringBuffer text;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(text);
+    fleet.Accept(writer);
+    FILE* fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    bytes = text.GetSize();
+    bool written = fwrite(text.GetString(), 1, bytes, fp) == bytes;
+    return fclose(fp) == 0 && written;
+}
+
+// The former per-drone load: the whole file parsed for one entry
+static bool parseOne(const std::string& path, int index, Drone& drone) {
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        return false;
+    }
+    char readBuffer[65536];
+    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+    rapidjson::Document document;
+    document.ParseStream(is);
+    fclose(fp);
+    if (!document.IsObject() || !document.HasMember("Drones") || !document["Drones"].IsArray() ||
+        index >= static_cast<int>(document["Drones"].Size())) {
+        return false;
+    }
+    JsonParser parser;
+    return parser.parseDrone(document["Drones"][index], drone);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <scenario.json> [sizes...]" << std::endl;
+        return 1;
+    }
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; i++) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {10, 100, 1000, 10000};
+    }
+
+    ScenarioDocument base;
+    if (!base.load(argv[1]) || base.droneCount() == 0) {
+        std::cerr << "Could not load the drones of " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "  drones   file MB  per drone ms  one document ms  speedup" << std::endl;
+    std::cout << std::fixed;
+    for (int count : sizes) {
+        std::string path = "startup-bench-" + std::to_string(count) + ".json";
+        size_t bytes = 0;
+        if (count <= 0 || !writeFleet(base.getDocument(), count, path, bytes)) {
+            std::cerr << "Could not write " << path << std::endl;
+            return 1;
+        }
+
+        int sampled = count < SAMPLE ? count : SAMPLE;
+        Drone drone;
+        auto start = Clock::now();
+        for (int i = 0; i < sampled; i++) {
+            if (!parseOne(path, i, drone)) {
+                std::cerr << "Could not parse drone " << i << " of " << path << std::endl;
+                return 1;
+            }
+        }
+        double perDrone = std::chrono::duration<double, std::milli>(Clock::now() - start).count() * count / sampled;
+
+        start = Clock::now();
+        ScenarioDocument scenario;
+        bool loaded = scenario.load(path);
+        for (int i = 0; loaded && i < count; i++) {
+            loaded = scenario.loadDrone(i, drone);
+        }
+        double once = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        remove(path.c_str());
+        if (!loaded) {
+            std::cerr << "Could not load " << path << std::endl;
+            return 1;
+        }
+
+        std::cout << std::setw(8) << count << std::setw(10) << std::setprecision(2) << bytes / 1e6 << std::setw(13)
+                  << std::setprecision(1) << perDrone << (sampled < count ? "*" : " ") << std::setw(16)
+                  << std::setprecision(3) << once << std::setw(8) << std::setprecision(0) << perDrone / once << "x"
+                  << std::endl;
+    }
+    return 0;
+}
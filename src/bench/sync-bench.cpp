@@ -0,0 +1,93 @@
+/*
+ * Synchronization time of a two-rank run, as SyncMonitor reports it.
+ *
+ * Two nodes, one per rank, joined by a point-to-point link of LINK_DELAY
+ * (the lookahead), the first echoing UDP packets off the second every
+ * INTERVAL for DURATION seconds. Each rank prints its SyncMonitor line and
+ * fails when no time was accounted to the MPI calls, which is what happens
+ * when the PMPI wrappers are not linked in.
+ *
+ * mpiexec -n 2 sync-bench [granted|nullmsg]      (default granted)
+ */
+#include "../scenario/SyncMonitor.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace ns3;
+
+#define LINK_DELAY MilliSeconds(5)
+#define INTERVAL MilliSeconds(10)
+#define DURATION 10
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    SyncMonitor::Synchronizer synchronizer = SyncMonitor::GRANTED_TIME_WINDOW;
+    if (argc > 1 && !SyncMonitor::parse(argv[1], synchronizer)) {
+        std::cerr << "Usage: mpiexec -n 2 " << argv[0] << " [granted|nullmsg]" << std::endl;
+        return 1;
+    }
+    SyncMonitor::select(synchronizer);
+    MpiInterface::Enable(&argc, &argv);
+    uint32_t systemId = MpiInterface::GetSystemId();
+    uint32_t systemCount = MpiInterface::GetSize();
+    if (systemCount != 2) {
+        if (systemId == 0) {
+            std::cerr << "Needs two ranks: mpiexec -n 2 " << argv[0] << std::endl;
+        }
+        MpiInterface::Disable();
+        return 1;
+    }
+
+    Ptr<Node> client = CreateObject<Node>(0);
+    Ptr<Node> server = CreateObject<Node>(1);
+    NodeContainer nodes(client, server);
+    PointToPointHelper link;
+    link.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    link.SetChannelAttribute("Delay", TimeValue(LINK_DELAY));
+    NetDeviceContainer devices = link.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper addresses;
+    addresses.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = addresses.Assign(devices);
+
+    if (systemId == 1) {
+        UdpEchoServerHelper echo(9);
+        ApplicationContainer apps = echo.Install(server);
+        apps.Start(Seconds(0));
+        apps.Stop(Seconds(DURATION));
+    } else {
+        UdpEchoClientHelper echo(interfaces.GetAddress(1), 9);
+        echo.SetAttribute("MaxPackets", UintegerValue(DURATION * 1000));
+        echo.SetAttribute("Interval", TimeValue(INTERVAL));
+        echo.SetAttribute("PacketSize", UintegerValue(512));
+        ApplicationContainer apps = echo.Install(client);
+        apps.Start(Seconds(0.1));
+        apps.Stop(Seconds(DURATION));
+    }
+
+    Simulator::Stop(Seconds(DURATION));
+    SyncMonitor::arm();
+    auto start = Clock::now();
+    Simulator::Run();
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    SyncMonitor::disarm();
+    SyncMonitor::report(std::cout, systemId, systemCount, LINK_DELAY, wall);
+    bool measured = SyncMonitor::stallCalls() > 0 && SyncMonitor::stallSeconds() > 0;
+
+    Simulator::Destroy();
+    MpiInterface::Disable();
+    if (!measured) {
+        std::cerr << "Rank " << systemId << ": no MPI time measured, the PMPI wrappers are not in use" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Cost of the per-drone tick events at fleet scale, before and after the
+ * fleet registry.
+ *
+ *  - by value: the former DroneLogic event, carrying the socket, the packet
+ *    settings, a copy of the whole Drone (hardware vector, boxes, node and
+ *    energy model Ptr) and the voltage
+ *  - by handle: the DroneFleet::droneLogic event, the fleet and a handle
+ *
+ * Both ticks only reschedule themselves, so what is measured is the event
+ * itself: the MakeEvent allocation, the argument copies and the scheduler.
+ * Every size runs TICKS ticks per drone twice: plainly for the time per
+ * tick, then under ProfilingSimulatorImpl for the heap allocations and bytes
+ * per tick (those need -DCOUNT_ALLOCATIONS=ON, "-" otherwise).
+ *
+ * tick-bench [sizes...]      (default 100 1000 10000)
+ */
+#include "../drone/Drone.h"
+#include "../scenario/AllocationCounter.h"
+#include "../scenario/profiling-simulator-impl.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/simple-device-energy-model.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// Ticks per drone of every run
+#define TICKS 100
+
+using Clock = std::chrono::steady_clock;
+
+// The former tick, rescheduled with a copy of everything it was given
+static void byValueTick(Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval, Drone drone,
+                        double volt) {
+    if (pktCount > 1) {
+        Simulator::Schedule(pktInterval, &byValueTick, socket, pktSize, pktCount - 1, pktInterval, drone, volt);
+    }
+}
+
+// The registry tick, the drones stay where they are
+class FleetTicks {
+public:
+    FleetTicks(size_t drones, Time interval) : remaining(drones, TICKS), interval(interval) {}
+
+    void tick(uint32_t handle) {
+        if (--remaining[handle] > 0) {
+            Simulator::Schedule(interval, &FleetTicks::tick, this, handle);
+        }
+    }
+
+private:
+    std::vector<uint32_t> remaining;
+    Time interval;
+};
+
+// The drones of scenario/scenario.json, one node and energy model shared
+static std::vector<Drone> makeFleet(size_t n) {
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<SimpleDeviceEnergyModel> energyModel = CreateObject<SimpleDeviceEnergyModel>();
+    Drone drone;
+    drone.setNode(node);
+    drone.setEnergyModel(energyModel);
+    drone.setWeight(1200.5);
+    drone.setNumbPropellers(4);
+    drone.setPropellersRadius(0.1);
+    drone.setSpeed(15);
+    drone.setDragCoefficient(0.3);
+    drone.setHardware({{0.0, 1.0, 5.0, 5.0}, {2.0, 3.5, 7.5, 5.0}});
+    drone.setBounds(Box(0, 250, 0, 250, 0, 100));
+    drone.setAoI(Box(50, 200, 50, 200, 5, 100));
+    return std::vector<Drone>(n, drone);
+}
+
+// One run of n drones, the wall time of Run() in seconds
+static double run(size_t n, bool byValue, Ptr<ProfilingSimulatorImpl>* profiler) {
+    if (profiler) {
+        *profiler = ProfilingSimulatorImpl::Enable("");
+    }
+    Time interval = Seconds(1);
+    std::vector<Drone> drones = makeFleet(n);
+    FleetTicks fleet(n, interval);
+    for (uint32_t i = 0; i < n; i++) {
+        if (byValue) {
+            Simulator::Schedule(interval, &byValueTick, Ptr<Socket>(), 1024, TICKS, interval, drones[i], 3.7);
+        } else {
+            Simulator::Schedule(interval, &FleetTicks::tick, &fleet, i);
+        }
+    }
+    auto start = Clock::now();
+    Simulator::Run();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) {
+        sizes.push_back(strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {100, 1000, 10000};
+    }
+
+    std::cout << "Drone copy " << sizeof(Drone) << " bytes plus its hardware vector, handle event arguments "
+              << sizeof(FleetTicks*) + sizeof(uint32_t) << " bytes" << std::endl;
+    std::cout << "  drones  event      ns/tick  allocs/tick  bytes/tick" << std::endl;
+    for (size_t n : sizes) {
+        for (bool byValue : {true, false}) {
+            double ticks = double(n) * TICKS;
+            double wall = run(n, byValue, nullptr);
+            Simulator::Destroy();
+
+            Ptr<ProfilingSimulatorImpl> profiler;
+            run(n, byValue, &profiler);
+            ProfilingSimulatorImpl::Entry sum = profiler->Sum(byValue ? "function" : "FleetTicks");
+            Simulator::Destroy();
+
+            std::cout << std::setw(8) << n << "  " << std::left << std::setw(9)
+                      << (byValue ? "by value" : "by handle") << std::right << std::fixed << std::setw(9)
+                      << std::setprecision(0) << wall * 1e9 / ticks;
+            if (AllocationCounter::isEnabled() && sum.events > 0) {
+                std::cout << std::setw(13) << std::setprecision(2) << double(sum.allocations) / sum.events
+                          << std::setw(12) << std::setprecision(0) << double(sum.bytes) / sum.events;
+            } else {
+                std::cout << std::setw(13) << "-" << std::setw(12) << "-";
+            }
+            std::cout << std::defaultfloat << std::endl;
+        }
+    }
+    return 0;
+}
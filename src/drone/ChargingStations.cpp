@@ -0,0 +1,385 @@
+#include "ChargingStations.h"
+#include "../energy/predictive-battery-model.h"
+#include "../mobility/custom-mobility-model.h"
+#include "../parser/ScenarioDocument.h"
+#include "ns3/callback.h"
+#include "ns3/energy-source-container.h"
+#include "ns3/generic-battery-model.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+using namespace ns3;
+
+namespace {
+
+// Number member of a scenario object, fallback when missing
+double member(const rapidjson::Value& object, const char* key, double fallback) {
+    rapidjson::Value::ConstMemberIterator it = object.FindMember(key);
+    return it != object.MemberEnd() && it->value.IsNumber() ? it->value.GetDouble() : fallback;
+}
+
+// Battery replaced by a full one, the model keeps its curve
+void resetBattery(Ptr<EnergySource> battery) {
+    if (Ptr<GenericBatteryModel> generic = DynamicCast<GenericBatteryModel>(battery)) {
+        generic->UpdateEnergySource();
+        generic->SetDrainedCapacity(0);
+        generic->UpdateEnergySource();
+    } else if (Ptr<PredictiveBatteryModel> predictive = DynamicCast<PredictiveBatteryModel>(battery)) {
+        predictive->SetDrainedCapacity(0);
+    }
+}
+
+} // namespace
+
+ChargingStations::ChargingStations(DroneFleet& droneFleet)
+    : fleet(droneFleet), config(Config{{}, 10, Seconds(1)}), returns(0), missionsOver(0), stranded(0) {}
+
+bool ChargingStations::parse(const std::string& name, Service& service) {
+    if (name == "charge") {
+        service = CHARGE;
+    } else if (name == "swap") {
+        service = SWAP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string ChargingStations::name(Service service) {
+    return service == SWAP ? "swap" : "charge";
+}
+
+ChargingStations::Config ChargingStations::configFrom(const ScenarioDocument& scenario) {
+    Config config;
+    config.reserve = scenario.getDouble("StationReserve", 10);
+    config.checkInterval = Seconds(scenario.getDouble("StationCheckInterval", 1));
+    double chargeA = scenario.getDouble("StationChargeCurrent", 10);
+    double swapTime = scenario.getDouble("StationSwapTime", 60);
+
+    const rapidjson::Document& document = scenario.getDocument();
+    if (!document.IsObject()) {
+        return config;
+    }
+    rapidjson::Value::ConstMemberIterator it = document.FindMember("Stations");
+    if (it == document.MemberEnd() || !it->value.IsArray()) {
+        return config;
+    }
+    for (rapidjson::SizeType i = 0; i < it->value.Size(); i++) {
+        const rapidjson::Value& entry = it->value[i];
+        Station station;
+        station.service = CHARGE;
+        bool valid = entry.IsObject() && entry.HasMember("x") && entry["x"].IsNumber() && entry.HasMember("y") &&
+                     entry["y"].IsNumber();
+        if (valid && entry.HasMember("service")) {
+            valid = entry["service"].IsString() && parse(entry["service"].GetString(), station.service);
+        }
+        if (!valid) {
+            std::cerr << "Skipping malformed entry " << i << " of Stations" << std::endl;
+            continue;
+        }
+        station.position = Vector(entry["x"].GetDouble(), entry["y"].GetDouble(), member(entry, "z", 0));
+        station.pads = static_cast<uint32_t>(std::max(1.0, member(entry, "pads", 1)));
+        station.chargeA = member(entry, "chargeCurrent", chargeA);
+        station.swapTime = Seconds(member(entry, "swapTime", swapTime));
+        config.stations.push_back(station);
+    }
+    return config;
+}
+
+void ChargingStations::install(const Config& stationConfig) {
+    config = stationConfig;
+    queues.assign(config.stations.size(), Queue{{}, 0, 0, 0, 0, 0});
+    trackers.assign(fleet.size(), Tracker());
+    if (config.stations.empty()) {
+        return;
+    }
+    for (Handle handle = 0; handle < fleet.size(); ++handle) {
+        Tracker& tracker = trackers[handle];
+        tracker.phase = MISSION;
+        std::fill(tracker.seconds, tracker.seconds + PHASES, 0.0);
+        Ptr<Node> node = fleet.get(handle).getNode();
+        Ptr<EnergySourceContainer> sources = node->GetObject<EnergySourceContainer>();
+        if (!sources || sources->GetN() == 0) {
+            continue;
+        }
+        tracker.battery = sources->Get(0);
+        tracker.monitor = CreateObject<BatteryMonitor>();
+        tracker.monitor->SetEnergySource(tracker.battery);
+        tracker.battery->AppendDeviceEnergyModel(tracker.monitor);
+        tracker.monitor->SetRechargedCallback(MakeCallback(&ChargingStations::recharged, this).Bind(handle));
+        tracker.monitor->SetDepletionCallback(MakeCallback(&ChargingStations::depleted, this).Bind(handle));
+    }
+}
+
+void ChargingStations::start(Time at) {
+    started = at;
+    if (config.stations.empty()) {
+        return;
+    }
+    for (Handle handle = 0; handle < fleet.size(); ++handle) {
+        Tracker& tracker = trackers[handle];
+        if (!tracker.battery || !fleet.getSocket(handle)) {
+            continue;
+        }
+        tracker.since = at;
+        Simulator::ScheduleWithContext(fleet.get(handle).getNode()->GetId(),
+                                       at,
+                                       &ChargingStations::check,
+                                       this,
+                                       handle);
+    }
+}
+
+uint32_t ChargingStations::size() const { return config.stations.size(); }
+
+double ChargingStations::returnEnergy(Handle handle, const Vector& position, const Station& station) const {
+    Ptr<CustomMobilityModel> mobility = fleet.get(handle).getNode()->GetObject<CustomMobilityModel>();
+    const Drone::PowerProfile& power = fleet.get(handle).getPowerProfile();
+    // Same legs as CustomMobilityModel::ReturnTo, flown at AvgVelocity
+    double altitude = position.z > 0 ? position.z : mobility->GetMaxHeight();
+    double climb = altitude - position.z;
+    double horizontal = std::hypot(station.position.x - position.x, station.position.y - position.y);
+    double descent = std::fabs(altitude - station.position.z);
+    return (climb * power.moveW[0] + horizontal * power.moveW[1] + descent * power.moveW[3]) /
+           mobility->GetAvgVelocity();
+}
+
+Time ChargingStations::travelTime(Handle handle, const Vector& position, const Station& station) const {
+    Ptr<CustomMobilityModel> mobility = fleet.get(handle).getNode()->GetObject<CustomMobilityModel>();
+    double altitude = position.z > 0 ? position.z : mobility->GetMaxHeight();
+    double horizontal = std::hypot(station.position.x - position.x, station.position.y - position.y);
+    double path = altitude - position.z + horizontal + std::fabs(altitude - station.position.z);
+    return Seconds(path / mobility->GetAvgVelocity());
+}
+
+void ChargingStations::check(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    if (tracker.phase != MISSION) {
+        return;
+    }
+    const Drone& drone = fleet.get(handle);
+    Ptr<CustomMobilityModel> mobility = drone.getNode()->GetObject<CustomMobilityModel>();
+    double capacity = drone.getMaxCapacity();
+    double used = fleet.getUsedEnergy(handle);
+    if (used >= capacity) {
+        // DroneLogic stops reporting, nothing left to fly back with
+        stranded++;
+        enter(handle, STRANDED);
+        return;
+    }
+    if (mobility->GetMissionEnd() <= Simulator::Now()) {
+        dispatch(handle, true);
+        return;
+    }
+
+    Vector position = mobility->GetPosition();
+    double nearest = std::numeric_limits<double>::infinity();
+    for (const Station& station : config.stations) {
+        nearest = std::min(nearest, returnEnergy(handle, position, station));
+    }
+    // Drawn until the next check, at the present current and voltage
+    double ahead = fleet.getEnergyController().getDraw(handle).total * tracker.battery->GetSupplyVoltage() *
+                   config.checkInterval.GetSeconds();
+    double left = capacity - used - ahead - config.reserve / 100 * capacity;
+    if (left <= nearest) {
+        dispatch(handle, false);
+        return;
+    }
+    tracker.check = Simulator::Schedule(config.checkInterval, &ChargingStations::check, this, handle);
+}
+
+void ChargingStations::dispatch(Handle handle, bool missionOver) {
+    Tracker& tracker = trackers[handle];
+    const Drone& drone = fleet.get(handle);
+    Ptr<CustomMobilityModel> mobility = drone.getNode()->GetObject<CustomMobilityModel>();
+    Vector position = mobility->GetPosition();
+    double left = drone.getMaxCapacity() - fleet.getUsedEnergy(handle);
+
+    // Least travel plus expected wait among the stations in reach, the
+    // closest one if none is
+    uint32_t best = 0;
+    double bestScore = std::numeric_limits<double>::infinity();
+    uint32_t closest = 0;
+    double closestEnergy = std::numeric_limits<double>::infinity();
+    for (uint32_t s = 0; s < config.stations.size(); s++) {
+        const Station& station = config.stations[s];
+        const Queue& queue = queues[s];
+        double energy = returnEnergy(handle, position, station);
+        if (energy < closestEnergy) {
+            closestEnergy = energy;
+            closest = s;
+        }
+        if (energy > left) {
+            continue;
+        }
+        double wait = 0;
+        size_t ahead = queue.busy + queue.waiting.size();
+        if (ahead >= station.pads && queue.served > 0) {
+            wait = (ahead - station.pads + 1) * (queue.serviceSeconds / queue.served) / station.pads;
+        }
+        double score = travelTime(handle, position, station).GetSeconds() + wait;
+        if (score < bestScore) {
+            bestScore = score;
+            best = s;
+        }
+    }
+    if (std::isinf(bestScore)) {
+        best = closest;
+    }
+
+    if (missionOver) {
+        missionsOver++;
+    } else {
+        returns++;
+    }
+    tracker.station = best;
+    Time landing = mobility->ReturnTo(config.stations[best].position);
+    enter(handle, RETURNING);
+    tracker.next = Simulator::Schedule(landing - Simulator::Now(), &ChargingStations::arrive, this, handle);
+}
+
+void ChargingStations::arrive(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    const Station& station = config.stations[tracker.station];
+    Queue& queue = queues[tracker.station];
+    fleet.getEnergyController().setDocked(handle, true);
+    tracker.queuedAt = Simulator::Now();
+    if (queue.busy < station.pads) {
+        queue.busy++;
+        serve(handle);
+        return;
+    }
+    queue.waiting.push_back(handle);
+    queue.longest = std::max(queue.longest, queue.waiting.size());
+    enter(handle, QUEUED);
+}
+
+void ChargingStations::serve(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    const Station& station = config.stations[tracker.station];
+    queues[tracker.station].waitSeconds += (Simulator::Now() - tracker.queuedAt).GetSeconds();
+    enter(handle, SERVICE);
+    if (station.service == SWAP) {
+        tracker.next = Simulator::Schedule(station.swapTime, &ChargingStations::finish, this, handle);
+        return;
+    }
+    // Charged until the battery model reports its full voltage
+    fleet.getEnergyController().setDocked(handle, true, station.chargeA);
+}
+
+void ChargingStations::recharged(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    if (tracker.phase != SERVICE || config.stations[tracker.station].service != CHARGE || tracker.next.IsRunning()) {
+        return;
+    }
+    // Out of the battery update that notified it
+    tracker.next = Simulator::ScheduleNow(&ChargingStations::finish, this, handle);
+}
+
+void ChargingStations::depleted(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    if (tracker.phase == MISSION || tracker.phase == RETURNING || tracker.phase == REJOINING) {
+        tracker.check.Cancel();
+        tracker.next.Cancel();
+        stranded++;
+        enter(handle, STRANDED);
+    }
+}
+
+void ChargingStations::finish(Handle handle) {
+    Tracker& tracker = trackers[handle];
+    if (tracker.phase != SERVICE) {
+        return;
+    }
+    const Station& station = config.stations[tracker.station];
+    Queue& queue = queues[tracker.station];
+    queue.served++;
+    queue.serviceSeconds += (Simulator::Now() - tracker.since).GetSeconds();
+    // Out of SERVICE first, the current changes below notify the battery
+    // state again
+    enter(handle, REJOINING);
+    if (station.service == SWAP) {
+        resetBattery(tracker.battery);
+    }
+
+    fleet.setFullCharge(handle);
+    Time back = fleet.get(handle).getNode()->GetObject<CustomMobilityModel>()->Resume();
+    fleet.getEnergyController().setDocked(handle, false);
+    fleet.watchMission(handle);
+    tracker.next = Simulator::Schedule(back - Simulator::Now(), &ChargingStations::rejoined, this, handle);
+
+    // The pad goes to the next drone of the queue
+    if (queue.waiting.empty()) {
+        queue.busy--;
+        return;
+    }
+    Handle next = queue.waiting.front();
+    queue.waiting.pop_front();
+    serve(next);
+}
+
+void ChargingStations::rejoined(Handle handle) {
+    enter(handle, MISSION);
+    check(handle);
+}
+
+void ChargingStations::enter(Handle handle, Phase phase) {
+    Tracker& tracker = trackers[handle];
+    Time now = Simulator::Now();
+    tracker.seconds[tracker.phase] += (now - tracker.since).GetSeconds();
+    tracker.phase = phase;
+    tracker.since = now;
+}
+
+void ChargingStations::report(std::ostream& os) const {
+    uint32_t pads = 0;
+    for (const Station& station : config.stations) {
+        pads += station.pads;
+    }
+    Time now = Simulator::Now();
+    double seconds[PHASES] = {0};
+    double area = 0;
+    for (Handle handle = 0; handle < trackers.size(); ++handle) {
+        const Tracker& tracker = trackers[handle];
+        if (!tracker.battery || !fleet.getSocket(handle)) {
+            continue;
+        }
+        for (int p = 0; p < PHASES; p++) {
+            seconds[p] += tracker.seconds[p];
+        }
+        seconds[tracker.phase] += (now - tracker.since).GetSeconds();
+        area += fleet.get(handle).getNode()->GetObject<CustomMobilityModel>()->GetCoveredArea(now);
+    }
+    double total = 0;
+    for (int p = 0; p < PHASES; p++) {
+        total += seconds[p];
+    }
+
+    os << "Stations: " << config.stations.size() << " stations, " << pads << " pads; " << returns
+       << " returns on low energy, " << missionsOver << " after the mission, " << stranded << " stranded";
+    if (total > 0) {
+        os << "; availability " << 100 * seconds[MISSION] / total << "% (returning "
+           << 100 * seconds[RETURNING] / total << "%, queued " << 100 * seconds[QUEUED] / total << "%, service "
+           << 100 * seconds[SERVICE] / total << "%, rejoining " << 100 * seconds[REJOINING] / total << "%)";
+    }
+    double hours = (now - started).GetHours();
+    if (hours > 0) {
+        os << "; throughput " << area / hours << " m^2/h of AoI covered";
+    }
+    os << std::endl;
+
+    for (uint32_t s = 0; s < config.stations.size(); s++) {
+        const Station& station = config.stations[s];
+        const Queue& queue = queues[s];
+        os << "  station " << s << " (" << name(station.service) << ", " << station.pads << " pads): " << queue.served
+           << " served";
+        if (queue.served > 0) {
+            os << ", wait " << queue.waitSeconds / queue.served << " s mean, service "
+               << queue.serviceSeconds / queue.served << " s mean";
+        }
+        os << ", queue " << queue.longest << " max" << std::endl;
+    }
+}
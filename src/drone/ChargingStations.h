@@ -0,0 +1,132 @@
+#ifndef CHARGINGSTATIONS_H
+#define CHARGINGSTATIONS_H
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/energy-source.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/vector.h"
+#include "../energy/battery-monitor.h"
+#include "DroneFleet.h"
+
+class ScenarioDocument;
+
+/*
+ * Charging and battery swap stations of the fleet.
+ *
+ * Every CheckInterval a drone on its mission compares the energy left
+ * (maxCapacity minus what it drew since its battery was last full) with
+ * the cost of reaching the nearest station: transit at the cruise power,
+ * then the descent, plus Reserve % of the capacity and the draw until the
+ * next check. When it runs short, or once its mission is over, it flies to
+ * the reachable station with the least travel plus expected waiting time.
+ *
+ * A station serves Pads drones at once, the others wait landed in a FIFO
+ * queue drawing nothing. Charging feeds ChargeCurrent into the battery, so
+ * the battery model charge curve decides when it is full (its recharged
+ * notification); a swap resets the battery after SwapTime. The drone then
+ * flies back to where it left its plan and goes on with it, or flies its
+ * mission again if it was over.
+ *
+ * Stations are per rank: with several MPI ranks the drones of each rank
+ * only queue behind each other.
+ */
+class ChargingStations {
+public:
+    typedef DroneFleet::Handle Handle;
+
+    enum Service { CHARGE, SWAP };
+
+    struct Station {
+        ns3::Vector position;
+        uint32_t pads;          // Drones served at once
+        Service service;
+        double chargeA;         // CHARGE current (A)
+        ns3::Time swapTime;     // SWAP duration
+    };
+
+    struct Config {
+        std::vector<Station> stations;
+        double reserve;             // Capacity (%) kept on arrival
+        ns3::Time checkInterval;
+    };
+
+    explicit ChargingStations(DroneFleet& fleet);
+
+    // "charge" or "swap"
+    static bool parse(const std::string& name, Service& service);
+    static std::string name(Service service);
+
+    // Scenario "Stations" array of {x, y, z, pads (1), service ("charge"),
+    // chargeCurrent, swapTime (s)}, the last two defaulting to
+    // "StationChargeCurrent" (10 A) and "StationSwapTime" (60 s); plus
+    // "StationReserve" (%, 10) and "StationCheckInterval" (s, 1)
+    static Config configFrom(const ScenarioDocument& scenario);
+
+    // Attach a BatteryMonitor to the battery of every drone, nothing to do
+    // without stations
+    void install(const Config& config);
+    // Follow the started drones from at
+    void start(ns3::Time at);
+
+    uint32_t size() const;
+
+    // Prints the returns, the fleet availability, the AoI throughput and
+    // the queueing at every station
+    void report(std::ostream& os) const;
+
+private:
+    // Where a drone spends its time
+    enum Phase { MISSION, RETURNING, QUEUED, SERVICE, REJOINING, STRANDED, PHASES };
+
+    struct Tracker {
+        Phase phase;
+        ns3::Time since;            // Of the phase
+        uint32_t station;
+        ns3::Time queuedAt;
+        ns3::Ptr<ns3::EnergySource> battery;
+        ns3::Ptr<ns3::BatteryMonitor> monitor;
+        ns3::EventId check;
+        ns3::EventId next;          // Arrival, end of service or rejoin
+        double seconds[PHASES];
+    };
+
+    struct Queue {
+        std::deque<Handle> waiting;
+        uint32_t busy;              // Pads in use
+        uint64_t served;
+        size_t longest;
+        double waitSeconds;
+        double serviceSeconds;
+    };
+
+    void check(Handle handle);
+    // Energy (J) to reach the station from position
+    double returnEnergy(Handle handle, const ns3::Vector& position, const Station& station) const;
+    ns3::Time travelTime(Handle handle, const ns3::Vector& position, const Station& station) const;
+    void dispatch(Handle handle, bool missionOver);
+    void arrive(Handle handle);
+    void serve(Handle handle);
+    void recharged(Handle handle);
+    void depleted(Handle handle);
+    void finish(Handle handle);
+    void rejoined(Handle handle);
+    void enter(Handle handle, Phase phase);
+
+    DroneFleet& fleet;
+    Config config;
+    std::vector<Tracker> trackers;
+    std::vector<Queue> queues;
+    ns3::Time started;
+
+    uint64_t returns;           // Low on energy
+    uint64_t missionsOver;      // Back after a completed mission
+    uint64_t stranded;
+};
+
+#endif // CHARGINGSTATIONS_H
@@ -1,17 +1,19 @@
 #include "Drone.h"
 #include "../energy/energy.h"
 #include "../parser/JsonParser.h"
+#include "../parser/ScenarioDocument.h"
 #include <iostream>
 
 // Default Constructor
 Drone::Drone() : weight(0), numbPropellers(0), propellersRadius(0), speed(0), energy(0), 
                  maxHeight(0), avgVelocity(0), initialX(0), initialY(0), initialZ(0), 
                  numLocalIter(0), numbTrainDataSet(0), switchCapacitance(0), cpuFreq(0),
-                 hoverPower(0), vertPower(0), pDrag(0), commPower(0), commEnergy(0) {}
+                 hoverPower(0), vertPower(0), pDrag(0), commPower(0), commEnergy(0),
+                 powerProfileValid(false) {}
 
 // Constructor that initializes the drone with node, energy model, and data from JSON
 Drone::Drone(ns3::Ptr<ns3::Node> nodeRef, ns3::Ptr<ns3::SimpleDeviceEnergyModel> energyModelRef, double maxCapacityJ, const std::string& jsonFilePath, int index)
-    : node(nodeRef), energyModel(energyModelRef), maxCapacity(maxCapacityJ) {
+    : node(nodeRef), energyModel(energyModelRef), maxCapacity(maxCapacityJ), powerProfileValid(false) {
     // Initialize the fields using the JSON parser
     JsonParser parser;
     if (!parser.parseJson(jsonFilePath, *this, index)) {
@@ -19,14 +21,22 @@ Drone::Drone(ns3::Ptr<ns3::Node> nodeRef, ns3::Ptr<ns3::SimpleDeviceEnergyModel>
     }
 }
 
+// Constructor that initializes the drone from an already parsed scenario
+Drone::Drone(ns3::Ptr<ns3::Node> nodeRef, ns3::Ptr<ns3::SimpleDeviceEnergyModel> energyModelRef, double maxCapacityJ, const ScenarioDocument& scenario, int index)
+    : node(nodeRef), energyModel(energyModelRef), maxCapacity(maxCapacityJ), powerProfileValid(false) {
+    if (!scenario.loadDrone(index, *this)) {
+        std::cerr << "Error parsing JSON for Drone at index " << index << std::endl;
+    }
+}
+
 // Setters for drone-specific fields
-void Drone::setWeight(double wt) { weight = wt; }
-void Drone::setNumbPropellers(double numProp) { numbPropellers = numProp; }
-void Drone::setPropellersRadius(double propRadius) { propellersRadius = propRadius; }
-void Drone::setDragCoefficient(double dragCoeff) { pDrag = dragCoeff; }
-void Drone::setSpeed(double spd) { speed = spd; }
+void Drone::setWeight(double wt) { weight = wt; powerProfileValid = false; }
+void Drone::setNumbPropellers(double numProp) { numbPropellers = numProp; powerProfileValid = false; }
+void Drone::setPropellersRadius(double propRadius) { propellersRadius = propRadius; powerProfileValid = false; }
+void Drone::setDragCoefficient(double dragCoeff) { pDrag = dragCoeff; powerProfileValid = false; }
+void Drone::setSpeed(double spd) { speed = spd; powerProfileValid = false; }
 void Drone::setEnergy(double eng) { energy = eng; }
-void Drone::setHardware(const std::vector<std::vector<double>>& hw) { hardware = hw; }
+void Drone::setHardware(const std::vector<std::vector<double>>& hw) { hardware = hw; powerProfileValid = false; }
 
 // Setters for mobility and bounds-related fields
 void Drone::setMaxHeight(double height) { maxHeight = height; }
@@ -42,13 +52,13 @@ void Drone::setInitialCoordinates(double x, double y, double z) {
 }
 
 // Setters for computing power fields
-void Drone::setNumLocalIter(double numIter) { numLocalIter = numIter; }
-void Drone::setCpuCycleXop(double cxo) { cpuCyclexop = cxo; }
-void Drone::setOpxData(double oxd) { opxdata = oxd; }
-void Drone::setVoltage(double v) { voltage = v; }
-void Drone::setNumbTrainDataSet(double numTrainData) { numbTrainDataSet = numTrainData; }
-void Drone::setSwitchCapacitance(double switchCap) { switchCapacitance = switchCap; }
-void Drone::setCpuFreq(double freq) { cpuFreq = freq; }
+void Drone::setNumLocalIter(double numIter) { numLocalIter = numIter; powerProfileValid = false; }
+void Drone::setCpuCycleXop(double cxo) { cpuCyclexop = cxo; powerProfileValid = false; }
+void Drone::setOpxData(double oxd) { opxdata = oxd; powerProfileValid = false; }
+void Drone::setVoltage(double v) { voltage = v; powerProfileValid = false; }
+void Drone::setNumbTrainDataSet(double numTrainData) { numbTrainDataSet = numTrainData; powerProfileValid = false; }
+void Drone::setSwitchCapacitance(double switchCap) { switchCapacitance = switchCap; powerProfileValid = false; }
+void Drone::setCpuFreq(double freq) { cpuFreq = freq; powerProfileValid = false; }
 
 void Drone::setBandwidth(double b) { bandwidth = b; }
 void Drone::setWirelessTransmissionPower(double p) { power = p; }
@@ -119,12 +129,76 @@ double Drone::calculatePDrag() {
 }
 */
 
-double Drone::calcMovePower(int state) {
-    if (state == 0) return P_UAV(weight, pDrag, propellersRadius, numbPropellers, speed, speed, speed);
-    if (state == 1) return P_UAV(weight, pDrag, propellersRadius, numbPropellers, speed, 0, 0);
-    if (state == 2) return P_UAV(weight, pDrag, propellersRadius, numbPropellers, speed, 0, 0);
-    if (state == 3) return P_UAV(weight, pDrag, propellersRadius, numbPropellers, 0, 0, speed);
-    return 0;
+double Drone::calcMovePower(int state) const {
+    if (state < 0 || state > 3) return 0;
+    return getPowerProfile().moveW[state];
+}
+
+const Drone::PowerProfile& Drone::getPowerProfile() const {
+    if (!powerProfileValid) {
+        computePowerProfile();
+    }
+    return powerProfile;
+}
+
+void Drone::computePowerProfile() const {
+    computePowerProfiles(this, 1);
+}
+
+void Drone::computePowerProfiles(const Drone* drones, size_t n) {
+    // Three P_UAV lanes per drone: climb, cruise (in or out of the AoI) and
+    // descend
+    size_t lanes = 3 * n;
+    std::vector<double> mass(lanes), drag(lanes), radius(lanes), props(lanes), vx(lanes), vy(lanes), vz(lanes);
+    std::vector<double> moveW(lanes);
+    std::vector<double> y(n), v(n), cycles(n), ops(n), data(n), iters(n), computeW(n);
+    for (size_t i = 0; i < n; i++) {
+        const Drone& drone = drones[i];
+        for (size_t k = 0; k < 3; k++) {
+            size_t lane = 3 * i + k;
+            mass[lane] = drone.weight;
+            drag[lane] = drone.pDrag;
+            radius[lane] = drone.propellersRadius;
+            props[lane] = drone.numbPropellers;
+            vx[lane] = k < 2 ? drone.speed : 0;
+            vy[lane] = k == 0 ? drone.speed : 0;
+            vz[lane] = k != 1 ? drone.speed : 0;
+        }
+        y[i] = drone.switchCapacitance;
+        v[i] = drone.voltage;
+        cycles[i] = drone.cpuCyclexop;
+        ops[i] = drone.opxdata;
+        data[i] = drone.numbTrainDataSet;
+        iters[i] = drone.numLocalIter;
+    }
+    P_UAV_batch(mass.data(), drag.data(), radius.data(), props.data(), vx.data(), vy.data(), vz.data(), moveW.data(),
+                lanes);
+    calcCompPower_batch(y.data(), v.data(), cycles.data(), ops.data(), data.data(), iters.data(), computeW.data(), n);
+
+    for (size_t i = 0; i < n; i++) {
+        drones[i].fillPowerProfile(&moveW[3 * i], computeW[i]);
+    }
+}
+
+void Drone::fillPowerProfile(const double* move, double computeW) const {
+    powerProfile.moveW[0] = move[0];
+    powerProfile.moveW[1] = move[1];
+    powerProfile.moveW[2] = move[1];
+    powerProfile.moveW[3] = move[2];
+
+    powerProfile.computeW = computeW;
+    powerProfile.computeS = calcCompTime(cpuCyclexop, opxdata, numbTrainDataSet, numLocalIter, cpuFreq);
+
+    // hardware entries are [id, idle W, active W, voltage]
+    powerProfile.hwOffA = 0;
+    powerProfile.hwOnA = 0;
+    for (const auto& hwElement : hardware) {
+        if (hwElement.size() > 3) {
+            powerProfile.hwOffA += hwElement[1]/hwElement[3];
+            powerProfile.hwOnA += hwElement[2]/hwElement[3];
+        }
+    }
+    powerProfileValid = true;
 }
 
 //***********************************************************************************************************************
@@ -133,11 +207,25 @@ double Drone::calculateCommEnergy(double distance) {
     return calcCommEnergy(power, MLsize, bandwidth, frequency, distance);
 }
 
-double Drone::calculateComputePower(){
-    return calcCompPower(switchCapacitance, voltage, cpuCyclexop, opxdata, numbTrainDataSet, numLocalIter);
+double Drone::calculateUploadRate(const AirToGroundParams& channel, double horizontal, double vertical) const {
+    AirToGroundParams params = channel;
+    params.frequency = frequency;
+    return calculate_rn_a2g(bandwidth, power, params, horizontal, vertical);
+}
+
+double Drone::calculateUploadEnergy(const AirToGroundParams& channel, double horizontal, double vertical) const {
+    return calcCommPower(power, MLsize, calculateUploadRate(channel, horizontal, vertical));
+}
+
+double Drone::calculateComputePower() const {
+    return getPowerProfile().computeW;
     //return calcCompPower(8e-11, 1.3, 2, 1000000, 60, 10000);
 }
 
+double Drone::calculateComputeTime() const {
+    return getPowerProfile().computeS;
+}
+
 
 
 double Drone::getMaxHeight() const{ return maxHeight;}
@@ -9,8 +9,23 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/mobility-model.h"
 #include "../mobility/custom-mobility-model.h"
+#include "../propagation/air-to-ground.h"
+
+class ScenarioDocument;
 
 class Drone {
+public:
+    // Power draw of the drone for every CustomMobilityModel state (0-3).
+    // Everything here only depends on parsed parameters, so it is computed
+    // once and reused by every tick until a setter changes an input.
+    struct PowerProfile {
+        double moveW[4];    // P_UAV for climb, cruise, cruise in AoI, descend
+        double computeW;    // Local training power
+        double computeS;    // Local training time of one FL round
+        double hwOffA;      // Hardware idle draw (A)
+        double hwOnA;       // Hardware active draw (A)
+    };
+
 private:
     // Drone-specific fields
     double weight;
@@ -58,6 +73,15 @@ private:
     ns3::Ptr<ns3::SimpleDeviceEnergyModel> energyModel;  // Pointer to SimpleDeviceEnergyModel
     double maxCapacity;
 
+    // Memoized power table, rebuilt lazily after a setter invalidates it
+    mutable PowerProfile powerProfile;
+    mutable bool powerProfileValid;
+
+    void computePowerProfile() const;
+    // Power table from the batch kernel outputs: climb, cruise and descend
+    // W, then the compute W
+    void fillPowerProfile(const double* moveW, double computeW) const;
+
 public:
     // Default Constructor
     Drone();
@@ -65,6 +89,9 @@ public:
     // Constructor that initializes the drone with node, energy model, and data from JSON
     Drone(ns3::Ptr<ns3::Node> nodeRef, ns3::Ptr<ns3::SimpleDeviceEnergyModel> energyModelRef, double maxCapacityJ, const std::string& jsonFilePath, int index);
 
+    // Constructor that initializes the drone from an already parsed scenario
+    Drone(ns3::Ptr<ns3::Node> nodeRef, ns3::Ptr<ns3::SimpleDeviceEnergyModel> energyModelRef, double maxCapacityJ, const ScenarioDocument& scenario, int index);
+
     // Setters for drone-specific fields
     void setWeight(double wt);
     void setNumbPropellers(double numProp);
@@ -141,13 +168,25 @@ public:
     ns3::Ptr<ns3::Node> getNode() const;
     ns3::Ptr<ns3::SimpleDeviceEnergyModel> getEnergyModel() const;
 
+    // Per-state power table
+    const PowerProfile& getPowerProfile() const;
+    // Fill the tables of n drones at once, one batch energy kernel call per
+    // model over all of them
+    static void computePowerProfiles(const Drone* drones, size_t n);
+
     // Energy calculation-related functions
     double calculateHoverPower();
     double calculateVertPower();
     double calculatePDrag();
+    // Model upload energy (J) over a free-space link of the given length
     double calculateCommEnergy(double distance);
-    double calculateComputePower();
-    double calcMovePower(int state);
+    // Model upload rate (bit/s) and energy (J) over the air-to-ground link
+    // to a server at the given horizontal and vertical separation
+    double calculateUploadRate(const AirToGroundParams& channel, double horizontal, double vertical) const;
+    double calculateUploadEnergy(const AirToGroundParams& channel, double horizontal, double vertical) const;
+    double calculateComputePower() const;
+    double calculateComputeTime() const;
+    double calcMovePower(int state) const;
 };
 
 #endif // DRONE_H
@@ -0,0 +1,295 @@
+#include "DroneFleet.h"
+#include "../telemetry/drone-telemetry-header.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+using namespace ns3;
+
+DroneFleet::DroneFleet()
+    : airToGround(urbanAirToGround()), pktInterval(Seconds(1.0)), numPackets(10000), textTelemetry(false),
+      started(false), ticks(0), tickSeconds(0) {}
+
+void DroneFleet::reserve(uint32_t count) {
+    drones.reserve(count);
+    sockets.reserve(count);
+    remainingPackets.reserve(count);
+    missionEnd.reserve(count);
+    missionEnergy.reserve(count);
+    missionArea.reserve(count);
+    missionWatch.reserve(count);
+    fullMark.reserve(count);
+    radios.reserve(count);
+}
+
+DroneFleet::Handle DroneFleet::add(const Drone& drone) {
+    NS_ASSERT_MSG(!started, "Drones cannot be added once the fleet is started");
+    drones.push_back(drone);
+    sockets.push_back(nullptr);
+    remainingPackets.push_back(0);
+    missionEnd.push_back(-1);
+    missionEnergy.push_back(0);
+    missionArea.push_back(0);
+    missionWatch.push_back(EventId());
+    fullMark.push_back(0);
+    radios.push_back(nullptr);
+    return drones.size() - 1;
+}
+
+uint32_t DroneFleet::size() const { return drones.size(); }
+
+Drone& DroneFleet::get(Handle handle) { return drones[handle]; }
+const Drone& DroneFleet::get(Handle handle) const { return drones[handle]; }
+
+void DroneFleet::setSocket(Handle handle, Ptr<Socket> socket) { sockets[handle] = socket; }
+Ptr<Socket> DroneFleet::getSocket(Handle handle) const { return sockets[handle]; }
+
+void DroneFleet::setRadio(Handle handle, Ptr<DeviceEnergyModel> radio) { radios[handle] = radio; }
+
+double DroneFleet::getRadioEnergy(Handle handle) const {
+    return radios[handle] ? radios[handle]->GetTotalEnergyConsumption() : 0;
+}
+
+void DroneFleet::setAccessPoint(Ptr<MobilityModel> ap) { apMobility = ap; }
+void DroneFleet::setAirToGround(const AirToGroundParams& params) { airToGround = params; }
+
+Vector DroneFleet::getPosition(Handle handle) const {
+    return drones[handle].getNode()->GetObject<MobilityModel>()->GetPosition();
+}
+
+void DroneFleet::apSeparation(const Vector& drone, double& horizontal, double& vertical) const {
+    Vector ap = apMobility ? apMobility->GetPosition() : Vector(0, 0, 0);
+    horizontal = std::hypot(drone.x - ap.x, drone.y - ap.y);
+    vertical = drone.z - ap.z;
+}
+
+double DroneFleet::uploadEnergy(Handle handle) const { return uploadEnergy(handle, getPosition(handle)); }
+Time DroneFleet::uploadTime(Handle handle) const { return uploadTime(handle, getPosition(handle)); }
+
+double DroneFleet::uploadEnergy(Handle handle, const Vector& position) const {
+    double horizontal, vertical;
+    apSeparation(position, horizontal, vertical);
+    return drones[handle].calculateUploadEnergy(airToGround, horizontal, vertical);
+}
+
+Time DroneFleet::uploadTime(Handle handle, const Vector& position) const {
+    double horizontal, vertical;
+    apSeparation(position, horizontal, vertical);
+    const Drone& drone = drones[handle];
+    return Seconds(drone.getLocalModelSize() / drone.calculateUploadRate(airToGround, horizontal, vertical));
+}
+
+void DroneFleet::setPacketInterval(Time interval) { pktInterval = interval; }
+void DroneFleet::setPacketCount(uint32_t count) { numPackets = count; }
+void DroneFleet::setVoltage(double volt) { energy.setVoltage(volt); }
+void DroneFleet::setTextTelemetry(bool enable) { textTelemetry = enable; }
+
+void DroneFleet::setExhaustedCallback(Callback<void, Handle> callback) { exhausted = callback; }
+
+void DroneFleet::start(Time at) {
+    started = true;
+    // Every power table in one pass of the batch kernels
+    Drone::computePowerProfiles(drones.data(), drones.size());
+    for (Handle handle = 0; handle < drones.size(); ++handle) {
+        if (!sockets[handle]) {
+            continue;
+        }
+        remainingPackets[handle] = numPackets;
+        energy.attach(handle, &drones[handle], at);
+        Simulator::ScheduleWithContext(sockets[handle]->GetNode()->GetId(),
+                                       at,
+                                       &DroneFleet::watchMission,
+                                       this,
+                                       handle);
+        Simulator::ScheduleWithContext(sockets[handle]->GetNode()->GetId(),
+                                       at,
+                                       &DroneFleet::droneLogic,
+                                       this,
+                                       handle);
+    }
+}
+
+double DroneFleet::getUsedEnergy(Handle handle) const {
+    return drones[handle].getEnergyModel()->GetTotalEnergyConsumption() - fullMark[handle];
+}
+
+void DroneFleet::setFullCharge(Handle handle) {
+    fullMark[handle] = drones[handle].getEnergyModel()->GetTotalEnergyConsumption();
+}
+
+EnergyController& DroneFleet::getEnergyController() { return energy; }
+
+void DroneFleet::reportTickCost(std::ostream& os) const {
+    os << "DroneLogic: " << ticks << " ticks";
+    if (ticks > 0) {
+        os << ", " << (tickSeconds * 1e6) / ticks << " us/tick";
+    }
+    // A tick event used to carry a copy of the whole Drone
+    os << ", event arguments " << sizeof(DroneFleet*) + sizeof(Handle)
+       << " bytes (a Drone copy is " << sizeof(Drone) << " bytes plus its hardware vector)" << std::endl;
+}
+
+void DroneFleet::reportCoverage(std::ostream& os) const {
+    uint32_t landed = 0;
+    double longest = 0;
+    double totalTime = 0;
+    double totalEnergy = 0;
+    double totalArea = 0;
+    for (Handle handle = 0; handle < drones.size(); ++handle) {
+        if (missionEnd[handle] < 0) {
+            continue;
+        }
+        landed++;
+        longest = std::max(longest, missionEnd[handle]);
+        totalTime += missionEnd[handle];
+        totalEnergy += missionEnergy[handle];
+        totalArea += missionArea[handle];
+    }
+    os << "Coverage: " << landed << "/" << drones.size() << " missions completed";
+    if (landed > 0) {
+        os << ", mission time " << totalTime / landed << " s mean, " << longest << " s max, covered "
+           << totalArea << " m^2 with " << totalEnergy << " J";
+        if (totalArea > 0) {
+            os << " (" << totalEnergy / totalArea << " J/m^2)";
+        }
+    }
+    os << std::endl;
+
+    // Planned time inside no-fly boxes and buildings, whole fleet
+    double restricted = 0;
+    for (Handle handle = 0; handle < drones.size(); ++handle) {
+        restricted += drones[handle].getNode()->GetObject<CustomMobilityModel>()->GetRestrictedTime().GetSeconds();
+    }
+    os << "Restricted airspace: " << restricted << " s in no-fly zones or buildings" << std::endl;
+}
+
+void DroneFleet::reportRadio(std::ostream& os) const {
+    double radioEnergy = 0;
+    double upload = 0;
+    double uploadSeconds = 0;
+    uint32_t uploading = 0;
+    for (Handle handle = 0; handle < drones.size(); ++handle) {
+        radioEnergy += getRadioEnergy(handle);
+        if (!sockets[handle]) {
+            continue;
+        }
+        uploading++;
+        upload += uploadEnergy(handle);
+        uploadSeconds += uploadTime(handle).GetSeconds();
+    }
+    os << "Radio: " << radioEnergy << " J of Wi-Fi airtime";
+    if (!drones.empty()) {
+        os << " (" << radioEnergy / drones.size() << " J per drone)";
+    }
+    if (uploading > 0) {
+        os << ", model upload " << upload / uploading << " J in " << uploadSeconds / uploading
+           << " s per round at the current AP distance";
+    }
+    os << std::endl;
+}
+
+void DroneFleet::watchMission(Handle handle) {
+    missionWatch[handle].Cancel();
+    Time end = drones[handle].getNode()->GetObject<CustomMobilityModel>()->GetMissionEnd();
+    if (end == Time::Max()) {
+        return;
+    }
+    // A replanned flight (SetPosition) is not followed
+    missionWatch[handle] = Simulator::Schedule(end > Simulator::Now() ? end - Simulator::Now() : Seconds(0),
+                                               &DroneFleet::missionDone,
+                                               this,
+                                               handle);
+}
+
+void DroneFleet::missionDone(Handle handle) {
+    if (drones[handle].getNode()->GetObject<CustomMobilityModel>()->GetMissionEnd() != Simulator::Now()) {
+        // Diverted to a station since, watched again when it resumes
+        watchMission(handle);
+        return;
+    }
+    if (missionEnd[handle] >= 0) {
+        // A mission flown again after a recharge, the first one is reported
+        return;
+    }
+    missionEnd[handle] = Simulator::Now().GetSeconds();
+    missionEnergy[handle] = drones[handle].getEnergyModel()->GetTotalEnergyConsumption() + getRadioEnergy(handle);
+    missionArea[handle] = drones[handle].getNode()->GetObject<CustomMobilityModel>()->GetCoveredArea(Simulator::Now());
+}
+
+/**
+ * Drone logic. This function sends the coordinate of the node to the server.
+ *
+ * \param handle The drone to run.
+ */
+void DroneFleet::droneLogic(Handle handle) {
+
+    auto tickStart = std::chrono::steady_clock::now();
+    Drone& drone = drones[handle];
+    Ptr<Socket> socket = sockets[handle];
+    uint32_t pktCount = remainingPackets[handle];
+
+    //MOBILITY FIRST AND GATHER DATA
+    // Get the Ptr to the MobilityModel from the Drone
+    Ptr<CustomMobilityModel> mobilityModel = drone.getNode()->GetObject<CustomMobilityModel>();
+    Ptr<SimpleDeviceEnergyModel> battery = drone.getEnergyModel();
+
+    Vector pos = mobilityModel->GetPosition();
+
+    // The current is set by the EnergyController on state transitions,
+    // here it is only read back for the report
+    const EnergyController::CurrentDraw& draw = energy.getDraw(handle);
+    double ampere = draw.total;
+    double mobilityA = draw.mobilityA;
+    double computingA = draw.computingA;
+    double hwA = draw.hardwareA;
+
+    double percentage = (getUsedEnergy(handle) / drone.getMaxCapacity())*100;
+
+    //MESSAGE TO SERVER
+    if (percentage < 100) {
+        Ptr<Packet> packet;
+        if (textTelemetry) {
+            // Debug encoder, the old space separated payload
+            std::ostringstream msgx;
+            Time now = Simulator::Now();
+            msgx << drone.getNode()->GetId() << " " << pos.x << " " << pos.y << " " << pos.z << " " << battery->GetTotalEnergyConsumption()<< " " << now << " " << mobilityModel->getAoI() << " " << ampere << " " << 100-percentage << " " << mobilityA << " " << hwA << " " << computingA << " " << mobilityModel->getState() << '\0';
+            std::string msg = msgx.str();
+            packet = Create<Packet>((const uint8_t *)msg.c_str(), msg.length() + 1);
+        } else {
+            DroneTelemetryHeader header;
+            header.SetDroneId(drone.getNode()->GetId());
+            header.SetState(mobilityModel->getState());
+            header.SetTimestamp(Simulator::Now());
+            header.SetPosition(pos);
+            header.SetEnergyConsumed(battery->GetTotalEnergyConsumption());
+            header.SetPercentage(100-percentage);
+            header.SetCurrents(ampere, mobilityA, hwA, computingA);
+            // Refresh the AoI at the edge every 10 packets
+            if (pktCount % 10 == 0) {
+                header.SetAoI(mobilityModel->GetAoI());
+            }
+            packet = Create<Packet>();
+            packet->AddHeader(header);
+        }
+        socket->Send(packet);
+
+        remainingPackets[handle] = pktCount - 1;
+        if (pktCount > 1) {
+            Simulator::Schedule(pktInterval, &DroneFleet::droneLogic, this, handle);
+        }
+    }
+    else {
+        socket->Close();
+        if (!exhausted.IsNull()) {
+            exhausted(handle);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - tickStart;
+    tickSeconds += elapsed.count();
+    ticks++;
+}  //DroneLogic()
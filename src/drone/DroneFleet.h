@@ -0,0 +1,127 @@
+#ifndef DRONEFLEET_H
+#define DRONEFLEET_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/device-energy-model.h"
+#include "ns3/event-id.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/socket.h"
+#include "../propagation/air-to-ground.h"
+#include "Drone.h"
+#include "EnergyController.h"
+
+/*
+ * Owner of every Drone of the simulation.
+ *
+ * Drones are stored once and addressed by a stable handle (their index),
+ * scheduled DroneLogic events only carry the fleet pointer and that handle
+ * instead of a copy of the Drone. The fleet is filled during setup and
+ * must not grow after start(), otherwise references would move. Battery
+ * current is owned by the EnergyController, DroneLogic only reports it.
+ */
+class DroneFleet {
+public:
+    typedef uint32_t Handle;
+
+    DroneFleet();
+
+    void reserve(uint32_t count);
+    Handle add(const Drone& drone);
+    uint32_t size() const;
+
+    Drone& get(Handle handle);
+    const Drone& get(Handle handle) const;
+
+    // Socket used by the drone to reach the edge server
+    void setSocket(Handle handle, ns3::Ptr<ns3::Socket> socket);
+    ns3::Ptr<ns3::Socket> getSocket(Handle handle) const;
+
+    // Radio energy model of the drone Wi-Fi device, charged by its TX/RX
+    // airtime on the same battery
+    void setRadio(Handle handle, ns3::Ptr<ns3::DeviceEnergyModel> radio);
+    double getRadioEnergy(Handle handle) const;
+
+    // Edge server the drones upload their model to, and the air-to-ground
+    // channel of the analytic upload cost
+    void setAccessPoint(ns3::Ptr<ns3::MobilityModel> ap);
+    void setAirToGround(const AirToGroundParams& params);
+
+    // Analytic cost of one FL round model upload at the current distance
+    // to the AP: energy (J) and airtime
+    double uploadEnergy(Handle handle) const;
+    ns3::Time uploadTime(Handle handle) const;
+    // Same from a given drone position (the one of its last telemetry)
+    double uploadEnergy(Handle handle, const ns3::Vector& position) const;
+    ns3::Time uploadTime(Handle handle, const ns3::Vector& position) const;
+
+    // Reporting parameters shared by the whole fleet
+    void setPacketInterval(ns3::Time interval);
+    void setPacketCount(uint32_t count);
+    void setVoltage(double volt);
+    void setTextTelemetry(bool enable);
+
+    // Schedule the first DroneLogic of every drone and start the
+    // energy accounting at the same time
+    void start(ns3::Time at);
+
+    // Energy drawn from the battery since it was last full (J), the state
+    // of charge of the telemetry is relative to the drone maxCapacity
+    double getUsedEnergy(Handle handle) const;
+    // Recharged or swapped battery, the state of charge is back to 100%
+    void setFullCharge(Handle handle);
+
+    // Called once when a drone used its maxCapacity and stops reporting
+    void setExhaustedCallback(ns3::Callback<void, Handle> callback);
+
+    // Record the landing of the present plan, again after a diverted
+    // drone resumed it
+    void watchMission(Handle handle);
+
+    EnergyController& getEnergyController();
+
+    // Prints the cost of the DroneLogic ticks
+    void reportTickCost(std::ostream& os) const;
+
+    // Prints mission time and energy per covered m^2 of the landed drones
+    void reportCoverage(std::ostream& os) const;
+
+    // Prints the radio energy of the simulated airtime and the analytic
+    // upload cost at the current AP distances
+    void reportRadio(std::ostream& os) const;
+
+private:
+    void droneLogic(Handle handle);
+    void missionDone(Handle handle);
+    ns3::Vector getPosition(Handle handle) const;
+    // Horizontal and vertical separation from the AP
+    void apSeparation(const ns3::Vector& drone, double& horizontal, double& vertical) const;
+
+    std::vector<Drone> drones;
+    std::vector<ns3::Ptr<ns3::Socket>> sockets;
+    std::vector<uint32_t> remainingPackets;
+    EnergyController energy;
+    std::vector<double> missionEnd;     // Landing time (s), negative while flying
+    std::vector<double> missionEnergy;  // Energy consumed at landing (J)
+    std::vector<double> missionArea;    // Covered at landing (m^2)
+    std::vector<ns3::EventId> missionWatch;
+    std::vector<double> fullMark;       // Consumption when the battery was last full (J)
+    std::vector<ns3::Ptr<ns3::DeviceEnergyModel>> radios;
+    ns3::Ptr<ns3::MobilityModel> apMobility;
+    AirToGroundParams airToGround;
+
+    ns3::Time pktInterval;
+    uint32_t numPackets;
+    bool textTelemetry;
+    bool started;
+    ns3::Callback<void, Handle> exhausted;
+
+    uint64_t ticks;
+    double tickSeconds;  // Wall-clock time spent in droneLogic
+};
+
+#endif // DRONEFLEET_H
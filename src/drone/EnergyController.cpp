@@ -0,0 +1,102 @@
+#include "EnergyController.h"
+#include "ns3/callback.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+EnergyController::EnergyController() : volt(12.6), updates(0) {}
+
+void EnergyController::setVoltage(double v) { volt = v; }
+
+void EnergyController::attach(uint32_t handle, Drone* drone, Time at) {
+    if (handle >= drones.size()) {
+        drones.resize(handle + 1, nullptr);
+        draws.resize(handle + 1, CurrentDraw{0, 0, 0, 0});
+        training.resize(handle + 1, 0);
+        docked.resize(handle + 1, 0);
+        chargeA.resize(handle + 1, 0);
+    }
+    drones[handle] = drone;
+    Simulator::ScheduleWithContext(drone->getNode()->GetId(),
+                                   at,
+                                   &EnergyController::activate,
+                                   this,
+                                   handle);
+}
+
+const EnergyController::CurrentDraw& EnergyController::getDraw(uint32_t handle) const {
+    return draws[handle];
+}
+
+void EnergyController::setTraining(uint32_t handle, bool on) {
+    if (training[handle] != on) {
+        training[handle] = on;
+        update(handle);
+    }
+}
+
+void EnergyController::setDocked(uint32_t handle, bool on, double current) {
+    docked[handle] = on;
+    chargeA[handle] = on ? current : 0;
+    update(handle);
+}
+
+void EnergyController::report(std::ostream& os) const {
+    os << "Energy controller: " << updates << " current updates for " << drones.size() << " drones"
+       << std::endl;
+}
+
+void EnergyController::activate(uint32_t handle) {
+    Ptr<CustomMobilityModel> mobilityModel = drones[handle]->getNode()->GetObject<CustomMobilityModel>();
+    mobilityModel->TraceConnectWithoutContext(
+        "State",
+        MakeCallback(&EnergyController::stateChanged, this).Bind(handle));
+    mobilityModel->TraceConnectWithoutContext(
+        "ComputeState",
+        MakeCallback(&EnergyController::computeStateChanged, this).Bind(handle));
+    update(handle);
+}
+
+void EnergyController::stateChanged(uint32_t handle, int oldState, int newState) {
+    update(handle);
+}
+
+void EnergyController::computeStateChanged(uint32_t handle, bool oldValue, bool newValue) {
+    // Only the cruise draw depends on the computation flag
+    if (drones[handle]->getNode()->GetObject<CustomMobilityModel>()->getState() == 1) {
+        update(handle);
+    }
+}
+
+void EnergyController::update(uint32_t handle) {
+    Drone& drone = *drones[handle];
+    Ptr<CustomMobilityModel> mobilityModel = drone.getNode()->GetObject<CustomMobilityModel>();
+    int state = mobilityModel->getState();
+    if (state < 0 || state > 3) {
+        return;
+    }
+
+    // Every term below comes from the drone's precomputed power table
+    const Drone::PowerProfile& power = drone.getPowerProfile();
+    CurrentDraw draw{0, 0, 0, 0};
+    if (!docked[handle]) {
+        draw.mobilityA = power.moveW[state]/volt;
+        if (state == 1 && mobilityModel->getCompState()) { //COMP STARTED BUT NO IN AOI
+            draw.computingA = power.computeW/1.3;
+            draw.hardwareA = power.hwOffA;
+        }
+        if (state == 2) {  // IN AOI AND COMPUTE
+            draw.computingA = power.computeW/1.3;
+            draw.hardwareA = power.hwOnA;  //HARDWARE ON
+        }
+    }
+    if (training[handle]) {  // FL LOCAL TRAINING, SAME CPU
+        draw.computingA = power.computeW/1.3;
+    }
+    // Charging on a station
+    draw.total = draw.computingA + draw.mobilityA + draw.hardwareA - chargeA[handle];
+
+    draws[handle] = draw;
+    drone.getEnergyModel()->SetCurrentA(draw.total); // Set the actual draw of energy
+    updates++;
+}
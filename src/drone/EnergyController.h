@@ -0,0 +1,65 @@
+#ifndef ENERGYCONTROLLER_H
+#define ENERGYCONTROLLER_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "ns3/nstime.h"
+#include "Drone.h"
+
+/*
+ * Event-driven battery accounting of the fleet.
+ *
+ * The controller listens to the "State" and "ComputeState" trace sources of
+ * every drone's CustomMobilityModel and sets the SimpleDeviceEnergyModel
+ * current only when one of them changes. Between transitions the draw is
+ * constant, so the battery integrates it exactly without any periodic
+ * event; telemetry just reads the last breakdown through getDraw().
+ */
+class EnergyController {
+public:
+    // Current breakdown (A) applied for the present state
+    struct CurrentDraw {
+        double total;
+        double mobilityA;
+        double hardwareA;
+        double computingA;
+    };
+
+    EnergyController();
+
+    void setVoltage(double volt);
+
+    // Start following the drone at the given time, the draw of its state
+    // at that moment is applied immediately
+    void attach(uint32_t handle, Drone* drone, ns3::Time at);
+
+    const CurrentDraw& getDraw(uint32_t handle) const;
+
+    // Local FL training in progress, it draws the compute current whatever
+    // the flight state
+    void setTraining(uint32_t handle, bool training);
+
+    // Landed on a station: no flight, hardware or mission computing draw,
+    // chargeA flows into the battery instead (negative current)
+    void setDocked(uint32_t handle, bool docked, double chargeA = 0);
+
+    // Prints how many times the battery current was updated
+    void report(std::ostream& os) const;
+
+private:
+    void activate(uint32_t handle);
+    void stateChanged(uint32_t handle, int oldState, int newState);
+    void computeStateChanged(uint32_t handle, bool oldValue, bool newValue);
+    void update(uint32_t handle);
+
+    std::vector<Drone*> drones;
+    std::vector<CurrentDraw> draws;
+    std::vector<uint8_t> training;
+    std::vector<uint8_t> docked;
+    std::vector<double> chargeA;
+    double volt;
+    uint64_t updates;
+};
+
+#endif // ENERGYCONTROLLER_H
@@ -0,0 +1,70 @@
+#include "battery-monitor.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("BatteryMonitor");
+
+NS_OBJECT_ENSURE_REGISTERED(BatteryMonitor);
+
+TypeId BatteryMonitor::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::BatteryMonitor")
+        .SetParent<DeviceEnergyModel>()
+        .SetGroupName("Energy")
+        .AddConstructor<BatteryMonitor>();
+    return tid;
+}
+
+BatteryMonitor::BatteryMonitor() {}
+
+void BatteryMonitor::SetDepletionCallback(Callback<void> callback) {
+    m_depleted = callback;
+}
+
+void BatteryMonitor::SetRechargedCallback(Callback<void> callback) {
+    m_recharged = callback;
+}
+
+void BatteryMonitor::SetEnergySource(Ptr<EnergySource> source) {
+    NS_ASSERT(source);
+    m_source = source;
+}
+
+Ptr<EnergySource> BatteryMonitor::GetEnergySource(void) const {
+    return m_source;
+}
+
+double BatteryMonitor::GetTotalEnergyConsumption(void) const {
+    return 0;
+}
+
+void BatteryMonitor::ChangeState(int newState) {}
+
+void BatteryMonitor::HandleEnergyDepletion(void) {
+    NS_LOG_DEBUG("Energy depleted");
+    if (!m_depleted.IsNull()) {
+        m_depleted();
+    }
+}
+
+void BatteryMonitor::HandleEnergyRecharged(void) {
+    NS_LOG_DEBUG("Energy recharged");
+    if (!m_recharged.IsNull()) {
+        m_recharged();
+    }
+}
+
+void BatteryMonitor::HandleEnergyChanged(void) {}
+
+double BatteryMonitor::DoGetCurrentA(void) const {
+    return 0;
+}
+
+void BatteryMonitor::DoDispose(void) {
+    m_source = nullptr;
+    m_depleted = MakeNullCallback<void>();
+    m_recharged = MakeNullCallback<void>();
+    DeviceEnergyModel::DoDispose();
+}
+
+} // namespace ns3
@@ -0,0 +1,46 @@
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include "ns3/callback.h"
+#include "ns3/device-energy-model.h"
+#include "ns3/energy-source.h"
+
+namespace ns3 {
+
+/**
+ * Device drawing nothing, attached to a battery to hear its notifications.
+ *
+ * SimpleDeviceEnergyModel ignores the depleted and recharged notifications
+ * of its source; this model forwards them to callbacks. The battery models
+ * notify on their own updates: GenericBatteryModel on every periodic update
+ * past the cutoff (or full) voltage, PredictiveBatteryModel once per
+ * crossing, so the callbacks have to be idempotent.
+ */
+class BatteryMonitor : public DeviceEnergyModel {
+public:
+  static TypeId GetTypeId(void);
+  BatteryMonitor();
+
+  void SetDepletionCallback(Callback<void> callback);
+  void SetRechargedCallback(Callback<void> callback);
+
+  void SetEnergySource(Ptr<EnergySource> source) override;
+  Ptr<EnergySource> GetEnergySource(void) const;
+  double GetTotalEnergyConsumption(void) const override;
+  void ChangeState(int newState) override;
+  void HandleEnergyDepletion(void) override;
+  void HandleEnergyRecharged(void) override;
+  void HandleEnergyChanged(void) override;
+
+private:
+  double DoGetCurrentA(void) const override;
+  void DoDispose(void) override;
+
+  Ptr<EnergySource> m_source;
+  Callback<void> m_depleted;
+  Callback<void> m_recharged;
+};
+
+} // namespace ns3
+
+#endif // BATTERY_MONITOR_H
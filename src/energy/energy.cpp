@@ -46,6 +46,26 @@ double P_UAV(double mass, double dragCoeff, double radiusPropellers, double numb
     return P_level((mass/1000), radiusPropellers, numbProp, vx, vy) + P_vertical((mass/1000), vz) + P_drag(dragCoeff, radiusPropellers, numbProp, vx, vy);
 }
 
+// P_UAV feeds mass/1000 to P_level and P_vertical, that divide by 1000
+// again: the weight below is the one of the scalar path. The hovering
+// speed is only used squared, 4 V_h^4 = (W / (rho A))^2
+void P_UAV_batch(const double* __restrict mass, const double* __restrict dragCoeff,
+                 const double* __restrict radiusPropellers, const double* __restrict numbProp,
+                 const double* __restrict vx, const double* __restrict vy, const double* __restrict vz,
+                 double* __restrict power, size_t n) {
+    const double level = 1 / (sqrt(2) * AIR_DENSITY);
+    #pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        double W = (mass[i] / 1e6) * GRAV;
+        double A = 2 * PI * radiusPropellers[i] * radiusPropellers[i] * numbProp[i];
+        double Omega = vx[i] * vx[i] + vy[i] * vy[i];
+        double hover = W / (AIR_DENSITY * A);
+        double P_lvl = level * W * W / (A * sqrt(Omega + sqrt(Omega * Omega + hover * hover)));
+        double P_drg = (1.0 / 8.0) * dragCoeff[i] * AIR_DENSITY * A * Omega * sqrt(Omega);
+        power[i] = P_lvl + W * vz[i] + P_drg;
+    }
+}
+
 //*******************************************************************************************************************************
 
 //Calculate the computing power ()
@@ -60,6 +80,23 @@ double calcCompPower(double y, double v, double cyclexop, double opxdata, double
     return ((y*pow(v, 2)*cyclexop)*opxdata*Dn*I)/v;
 }
 
+void calcCompPower_batch(const double* __restrict y, const double* __restrict v, const double* __restrict cyclexop,
+                         const double* __restrict opxdata, const double* __restrict Dn, const double* __restrict I,
+                         double* __restrict power, size_t n) {
+    // y v^2 / v = y v
+    #pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        power[i] = y[i] * v[i] * cyclexop[i] * opxdata[i] * Dn[i] * I[i];
+    }
+}
+
+//Calculate computation time (s)
+// cyclexop, opxdata, Dn, I as above
+// f = CPU frequency (GHz)
+double calcCompTime(double cyclexop, double opxdata, double Dn, double I, double f){
+    return f > 0 ? (cyclexop*opxdata*Dn*I)/(f*1e9) : 0;
+}
+
 //Calculate data transmission rate
 // B = Allocated bandwidth
 // pn = Wireless transmission power
@@ -107,7 +144,7 @@ double test(double numCycle, double switchc, double freq){
 double calculate_rn(double B, double p_n, double f_c, double d) {
 
     // Calculate PL_LoS
-    double PL_LoS = 20 * log10((4 * PI * f_c * d) / C);
+    double PL_LoS = freeSpaceLoss(f_c, d);
 
     // Calculate G_n
     double G_n = pow(10, -(PL_LoS / 10));
@@ -118,10 +155,27 @@ double calculate_rn(double B, double p_n, double f_c, double d) {
     return r_n;
 }
 
+double calculate_rn_a2g(double B, double p_n, const AirToGroundParams& params, double horizontal, double vertical) {
+    double r_n;
+    calculate_rn_batch(B, p_n, params, &horizontal, &vertical, &r_n, 1);
+    return r_n;
+}
+
+void calculate_rn_batch(double B, double p_n, const AirToGroundParams& params, const double* horizontal,
+                        const double* vertical, double* r_n, size_t n) {
+    // Path loss of every link first, then the Shannon rate, both plain loops
+    airToGroundLoss(params, horizontal, vertical, r_n, n);
+    const double snr = p_n / (N_0 * B);
+    for (size_t i = 0; i < n; i++) {
+        double G_n = pow(10, -(r_n[i] / 10));
+        r_n[i] = B * log2(1 + snr * G_n);
+    }
+}
+
 
-// Function to calculate (p_n * s_n) / r_n
+// Function to calculate (p_n * s_n) / r_n, in Joules
 //p_n = wireless transmission power = 0.1;      // Transmission power in watts (100 mW)
 //s_n = size of local ML model      = 1e6 (1MB)
 double calcCommEnergy(double p_n, double s_n, double B, double f_c, double d) {
-    return ((p_n * s_n) / calculate_rn(B, p_n, f_c, d))/12.6;
+    return calcCommPower(p_n, s_n, calculate_rn(B, p_n, f_c, d));
 }
@@ -5,6 +5,9 @@
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <cstddef>
+
+#include "../propagation/air-to-ground.h"
 
 
 //Calculate the hovering power (Watts)
@@ -27,6 +30,13 @@ double P_drag(double dragCoeff, double radiusPropellers, double numbProp, double
 
 double P_UAV(double mass, double dragCoeff, double radiusPropellers, double numbProp, double vx, double vy, double vz);
 
+// P_UAV of n drones at once, one array per argument (structure of arrays).
+// Same model as the scalar functions with Omega^1.5 as Omega*sqrt(Omega),
+// in a loop vectorized under -fopenmp-simd -fno-math-errno (the flags of
+// energy.cpp in CMakeLists.txt), a scalar loop without them
+void P_UAV_batch(const double* mass, const double* dragCoeff, const double* radiusPropellers, const double* numbProp,
+                 const double* vx, const double* vy, const double* vz, double* power, size_t n);
+
 //*******************************************************************************************************************
 
 //Calculate data transmission rate (rn)
@@ -67,12 +77,22 @@ double test(double numCycle, double switchc, double freq);
 // p_n = 0.1;      // Transmission power in watts (100 mW)
 // f_c = 2.4e9 carrier distance freq
 // d = 1000; distance
-// xi_LoS = 3 excessive path loss in dB
-// N_0 = 1e-9 power spectral density W/Hz
-double calculate_rn(double B, double p_n, double f_c, double d, double xi_LoS, double N_0);
+// Free-space path loss, N_0 = 1e-9 W/Hz
+double calculate_rn(double B, double p_n, double f_c, double d);
+
+//DATA TRANSMISSION RATE OVER THE AIR-TO-GROUND CHANNEL
+// Same path loss as UavAirToGroundLossModel (LoS probability from the
+// elevation, excess loss xi_LoS / xi_NLoS)
+// horizontal, vertical = separation drone -> server (m)
+double calculate_rn_a2g(double B, double p_n, const AirToGroundParams& params, double horizontal, double vertical);
 
+// Rates of n links at once (arrays of separations)
+void calculate_rn_batch(double B, double p_n, const AirToGroundParams& params, const double* horizontal,
+                        const double* vertical, double* r_n, size_t n);
 
-// Function to calculate (p_n * s_n) / r_n
+
+// Function to calculate (p_n * s_n) / r_n, in Joules (divide by the
+// battery voltage for the charge)
 //p_n = wireless transmission power = 0.1;      // Transmission power in watts (100 mW)
 //s_n = size of local ML model      = 1e6 (1MB)
 double calcCommEnergy(double p_n, double s_n, double B, double f_c, double d);
@@ -81,5 +101,13 @@ double calcCommEnergy(double p_n, double s_n, double B, double f_c, double d);
 //Comp power
 double calcCompPower(double y, double v, double cyclexop, double opxdata, double Dn, double I);
 
+// calcCompPower of n drones at once
+void calcCompPower_batch(const double* y, const double* v, const double* cyclexop, const double* opxdata,
+                         const double* Dn, const double* I, double* power, size_t n);
+
+//Comp time of one local training (s)
+// f = CPU frequency (GHz)
+double calcCompTime(double cyclexop, double opxdata, double Dn, double I, double f);
+
 
 #endif // ENERGY_H
\ No newline at end of file
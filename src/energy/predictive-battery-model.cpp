@@ -0,0 +1,272 @@
+#include "predictive-battery-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("PredictiveBatteryModel");
+
+NS_OBJECT_ENSURE_REGISTERED(PredictiveBatteryModel);
+
+TypeId PredictiveBatteryModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::PredictiveBatteryModel")
+        .SetParent<EnergySource>()
+        .SetGroupName("Energy")
+        .AddConstructor<PredictiveBatteryModel>()
+        .AddAttribute("LowBatteryThreshold",
+                      "Remaining capacity fraction of the low battery event.",
+                      DoubleValue(0.10),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_lowBatteryTh),
+                      MakeDoubleChecker<double>(0.0, 1.0))
+        .AddAttribute("FullVoltage",
+                      "(Q_full) The voltage of the cell when fully charged (V).",
+                      DoubleValue(4.18),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_vFull),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("MaxCapacity",
+                      "(Q) The maximum capacity of the cell (Ah).",
+                      DoubleValue(2.45),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_qMax),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("NominalVoltage",
+                      "(V_nom) Nominal voltage of the cell (V).",
+                      DoubleValue(3.59),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_vNom),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("NominalCapacity",
+                      "(Q_nom) Cell capacity at the end of the nominal zone (Ah)",
+                      DoubleValue(1.3),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_qNom),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("ExponentialVoltage",
+                      "(V_exp) Cell voltage at the end of the exponential zone (V).",
+                      DoubleValue(3.75),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_vExp),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("ExponentialCapacity",
+                      "(Q_exp) Cell Capacity at the end of the exponential zone (Ah).",
+                      DoubleValue(0.39),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_qExp),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("InternalResistance",
+                      "(R) Internal resistance of the cell (Ohms)",
+                      DoubleValue(0.083),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_internalResistance),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("TypicalDischargeCurrent",
+                      "Typical discharge current used in manufacters datasheets (A)",
+                      DoubleValue(2.33),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_typicalCurrent),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("CutoffVoltage",
+                      "The voltage where the battery is considered depleted (V).",
+                      DoubleValue(3.3),
+                      MakeDoubleAccessor(&PredictiveBatteryModel::m_cutoffVoltage),
+                      MakeDoubleChecker<double>())
+        .AddTraceSource("RemainingEnergy",
+                        "Remaining energy of the battery",
+                        MakeTraceSourceAccessor(&PredictiveBatteryModel::m_remainingEnergyJ),
+                        "ns3::TracedValueCallback::Double")
+        .AddTraceSource("LowBattery",
+                        "The remaining capacity went below LowBatteryThreshold",
+                        MakeTraceSourceAccessor(&PredictiveBatteryModel::m_lowBattery),
+                        "ns3::PredictiveBatteryModel::LowBatteryTracedCallback");
+    return tid;
+}
+
+PredictiveBatteryModel::PredictiveBatteryModel()
+    : m_drained(0), m_current(0), m_lastUpdate(Seconds(0)), m_depleted(false), m_full(false), m_low(false),
+      m_updates(0) {}
+
+double PredictiveBatteryModel::GetInitialEnergy(void) const {
+    return m_qMax * m_vFull * 3600;
+}
+
+double PredictiveBatteryModel::DrainedAt(Time t) const {
+    return m_drained + m_current * (t - m_lastUpdate).GetHours();
+}
+
+double PredictiveBatteryModel::VoltageAt(double drained, double current, Time t) const {
+    // GenericBatteryModel LION_LIPO curve, i* filtered from the start of the
+    // simulation as there
+    double A = m_vFull - m_vExp;
+    double B = 3 / m_qExp;
+    double E0 = m_vFull + m_internalResistance * m_typicalCurrent - A;
+    double expZoneFull = A * std::exp(-B * m_qNom);
+    double K = (E0 - m_vNom - m_internalResistance * m_typicalCurrent + expZoneFull) /
+               (m_qMax / (m_qMax - m_qNom) * (m_qNom + m_typicalCurrent));
+    double filtered = current * (1 - std::exp(-t.GetSeconds() / 30));
+    double polVoltage = K * m_qMax / (m_qMax - drained);
+    // Charging polarizes on the charged capacity instead
+    double polResistance = current < 0 ? K * m_qMax / (drained + 0.1 * m_qMax) : polVoltage;
+    return E0 - m_internalResistance * current - polResistance * filtered - polVoltage * drained +
+           A * std::exp(-B * drained);
+}
+
+double PredictiveBatteryModel::GetSupplyVoltage(void) const {
+    Time now = Simulator::Now();
+    return VoltageAt(DrainedAt(now), m_current, now);
+}
+
+double PredictiveBatteryModel::GetRemainingEnergy(void) {
+    UpdateEnergySource();
+    return m_remainingEnergyJ;
+}
+
+double PredictiveBatteryModel::GetEnergyFraction(void) {
+    return 1 - DrainedAt(Simulator::Now()) / m_qMax;
+}
+
+double PredictiveBatteryModel::GetDrainedCapacity(void) const {
+    return DrainedAt(Simulator::Now());
+}
+
+void PredictiveBatteryModel::SetDrainedCapacity(double drained) {
+    NS_ASSERT(drained >= 0 && drained < m_qMax);
+    // Close the interval of the old battery, then predict for the new one
+    UpdateEnergySource();
+    m_drained = drained;
+    UpdateEnergySource();
+}
+
+uint64_t PredictiveBatteryModel::GetUpdateCount(void) const {
+    return m_updates;
+}
+
+void PredictiveBatteryModel::UpdateEnergySource(void) {
+    if (Simulator::IsFinished()) {
+        return;
+    }
+    m_updates++;
+    Time now = Simulator::Now();
+    // The interval since the last update at the current drawn during it
+    m_drained = DrainedAt(now);
+    m_lastUpdate = now;
+    m_current = CalculateTotalCurrent();
+
+    double voltage = VoltageAt(m_drained, m_current, now);
+    m_remainingEnergyJ = (m_qMax - m_drained) * voltage * 3600;
+    NS_LOG_DEBUG(now.As(Time::S) << " i " << m_current << " it " << m_drained << " V " << voltage);
+
+    if (voltage <= m_cutoffVoltage) {
+        if (!m_depleted) {
+            m_depleted = true;
+            NotifyEnergyDrained();
+        }
+    } else {
+        m_depleted = false;
+    }
+    if (voltage >= m_vFull) {
+        if (!m_full) {
+            m_full = true;
+            NotifyEnergyRecharged();
+        }
+    } else {
+        m_full = false;
+    }
+    double fraction = 1 - m_drained / m_qMax;
+    if (fraction <= m_lowBatteryTh) {
+        if (!m_low) {
+            m_low = true;
+            m_lowBattery(fraction);
+        }
+    } else {
+        m_low = false;
+    }
+    Predict();
+}
+
+double PredictiveBatteryModel::Crossing(double target, bool falling) const {
+    Time now = Simulator::Now();
+    auto past = [&](double t) {
+        Time at = Seconds(t);
+        double v = VoltageAt(DrainedAt(at), m_current, at);
+        return falling ? v <= target : v >= target;
+    };
+    // The curve has a pole where the drained capacity reaches Q (discharge)
+    // or -0.1 Q (charge), the search stays before it
+    double pole = std::numeric_limits<double>::infinity();
+    if (m_current > 0) {
+        pole = now.GetSeconds() + (m_qMax - m_drained) * 3600 / m_current;
+    } else if (m_current < 0) {
+        pole = now.GetSeconds() + (m_drained + 0.1 * m_qMax) * 3600 / -m_current;
+    }
+    double lo = now.GetSeconds();
+    double hi = lo;
+    for (double step = 1; ; step *= 2) {
+        hi = lo + step;
+        if (hi >= pole) {
+            hi = lo + (pole - lo) * (1 - 1e-9);
+            if (!past(hi)) {
+                return -1;
+            }
+            break;
+        }
+        if (past(hi)) {
+            break;
+        }
+        if (step > 1e9) {
+            return -1;
+        }
+    }
+    // Monotonic under a constant current, bisect to the nanosecond
+    while (hi - lo > 1e-9 * std::max(1.0, hi)) {
+        double mid = 0.5 * (lo + hi);
+        if (past(mid)) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return hi;
+}
+
+void PredictiveBatteryModel::Predict(void) {
+    m_predicted.Cancel();
+    double now = Simulator::Now().GetSeconds();
+    double next = -1;
+    if (m_current > 0) {
+        if (!m_depleted) {
+            next = Crossing(m_cutoffVoltage, true);
+        }
+        if (!m_low) {
+            // Linear in the drained capacity
+            double low = now + ((1 - m_lowBatteryTh) * m_qMax - m_drained) * 3600 / m_current;
+            if (low > now && (next < 0 || low < next)) {
+                next = low;
+            }
+        }
+    } else if (m_current < 0 && !m_full) {
+        next = Crossing(m_vFull, false);
+    }
+    if (next > now) {
+        // Rounded up, the update lands past the crossing
+        Time at = NanoSeconds(static_cast<int64_t>(std::ceil(next * 1e9)));
+        m_predicted = Simulator::Schedule(at - Simulator::Now(), &PredictiveBatteryModel::UpdateEnergySource, this);
+    }
+}
+
+void PredictiveBatteryModel::DoDispose(void) {
+    m_predicted.Cancel();
+    BreakDeviceEnergyModelRefCycle();
+}
+
+PredictiveBatteryModelHelper::PredictiveBatteryModelHelper() {
+    m_battery.SetTypeId("ns3::PredictiveBatteryModel");
+}
+
+void PredictiveBatteryModelHelper::Set(std::string name, const AttributeValue& v) {
+    m_battery.Set(name, v);
+}
+
+Ptr<EnergySource> PredictiveBatteryModelHelper::DoInstall(Ptr<Node> node) const {
+    Ptr<EnergySource> source = m_battery.Create<EnergySource>();
+    source->SetNode(node);
+    return source;
+}
+
+} // namespace ns3
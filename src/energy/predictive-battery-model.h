@@ -0,0 +1,109 @@
+#ifndef PREDICTIVE_BATTERY_MODEL_H
+#define PREDICTIVE_BATTERY_MODEL_H
+
+#include "ns3/energy-model-helper.h"
+#include "ns3/energy-source.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+
+namespace ns3 {
+
+/**
+ * Li-ion GenericBatteryModel without the periodic update.
+ *
+ * GenericBatteryModel recomputes every battery on a PeriodicEnergyUpdateInterval
+ * tick. Between two current changes the drawn current is constant, so the
+ * drained capacity is linear in time and the voltage of the same discharge
+ * (or charge) curve is a closed form of it. This source integrates on
+ * demand, when a device changes its current or the battery is read, and
+ * schedules a single event at the predicted crossing of the cutoff voltage
+ * (the full voltage while charging) or of the LowBatteryThreshold state of
+ * charge. The next current change replaces the prediction.
+ *
+ * Same attributes and curve as GenericBatteryModel with BatteryType
+ * LION_LIPO (the NiMH/NiCd and lead acid curves integrate their exponential
+ * zone step by step). Unlike it, the elapsed interval is charged at the
+ * current it was drawn at, and drained/recharged are notified once per
+ * crossing. A device reporting the mean current of the interval since the
+ * previous update would be charged it over the next interval instead;
+ * WifiAirtimeEnergyModel reports a current of the interval to come for it.
+ */
+class PredictiveBatteryModel : public EnergySource {
+public:
+  static TypeId GetTypeId(void);
+  PredictiveBatteryModel();
+
+  /**
+   * TracedCallback signature of the low battery crossing.
+   *
+   * \param [in] stateOfCharge Remaining capacity fraction.
+   */
+  typedef void (*LowBatteryTracedCallback)(double stateOfCharge);
+
+  double GetInitialEnergy(void) const override;
+  // Closed form at the current time
+  double GetSupplyVoltage(void) const override;
+  double GetRemainingEnergy(void) override;
+  // Remaining capacity fraction
+  double GetEnergyFraction(void) override;
+  void UpdateEnergySource(void) override;
+
+  double GetDrainedCapacity(void) const;   //!< Ah, at the current time
+  // Battery replaced by one with the given drained capacity (Ah)
+  void SetDrainedCapacity(double drained);
+  uint64_t GetUpdateCount(void) const;
+
+private:
+  void DoDispose(void) override;
+
+  double DrainedAt(Time t) const;
+  double VoltageAt(double drained, double current, Time t) const;
+  // First time after now the voltage goes past target (falling or rising),
+  // negative if it never does under the present current
+  double Crossing(double target, bool falling) const;
+  void Predict(void);
+
+  double m_vFull;
+  double m_qMax;
+  double m_vNom;
+  double m_qNom;
+  double m_vExp;
+  double m_qExp;
+  double m_internalResistance;
+  double m_typicalCurrent;
+  double m_cutoffVoltage;
+  double m_lowBatteryTh;
+
+  double m_drained;                 //!< Ah at m_lastUpdate
+  double m_current;                 //!< A drawn since m_lastUpdate
+  Time m_lastUpdate;
+  bool m_depleted;
+  bool m_full;
+  bool m_low;
+  uint64_t m_updates;
+  EventId m_predicted;
+  TracedValue<double> m_remainingEnergyJ;
+  TracedCallback<double> m_lowBattery;
+};
+
+/**
+ * Installs a PredictiveBatteryModel on nodes, the attributes are the
+ * GenericBatteryModelHelper ones.
+ */
+class PredictiveBatteryModelHelper : public EnergySourceHelper {
+public:
+  PredictiveBatteryModelHelper();
+  void Set(std::string name, const AttributeValue& v) override;
+
+private:
+  Ptr<EnergySource> DoInstall(Ptr<Node> node) const override;
+
+  ObjectFactory m_battery;
+};
+
+} // namespace ns3
+
+#endif // PREDICTIVE_BATTERY_MODEL_H
@@ -0,0 +1,201 @@
+#include "ClientSelector.h"
+#include "../parser/ScenarioDocument.h"
+#include <algorithm>
+
+using namespace ns3;
+
+ClientSelector::ClientSelector(DroneFleet& droneFleet)
+    : fleet(droneFleet), config(Config{ALL, 0, 20, 0, Time()}), selections(0), offered(0), selected(0),
+      unknown(0), overDeadline(0), lowEnergy(0) {}
+
+bool ClientSelector::parse(const std::string& name, Policy& policy) {
+    if (name == "all") {
+        policy = ALL;
+    } else if (name == "deadline") {
+        policy = DEADLINE;
+    } else if (name == "energy") {
+        policy = ENERGY;
+    } else if (name == "poc") {
+        policy = POWER_OF_CHOICE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string ClientSelector::name(Policy policy) {
+    switch (policy) {
+    case DEADLINE:
+        return "deadline";
+    case ENERGY:
+        return "energy";
+    case POWER_OF_CHOICE:
+        return "poc";
+    default:
+        return "all";
+    }
+}
+
+ClientSelector::Config ClientSelector::configFrom(const ScenarioDocument& scenario, Time deadline) {
+    Config config;
+    if (!parse(scenario.getString("FlSelection", "all"), config.policy)) {
+        config.policy = ALL;
+    }
+    config.perRound = static_cast<uint32_t>(scenario.getDouble("FlClientsPerRound", 0));
+    config.minCharge = scenario.getDouble("FlMinCharge", 20);
+    config.choices = static_cast<uint32_t>(scenario.getDouble("FlChoices", 0));
+    config.deadline = deadline;
+    return config;
+}
+
+void ClientSelector::install(const Config& selectorConfig) {
+    config = selectorConfig;
+    table.assign(fleet.size(), Entry{false, 0, Vector(), 0, 0});
+    handles.clear();
+    for (Handle handle = 0; handle < fleet.size(); ++handle) {
+        handles[fleet.get(handle).getNode()->GetId()] = handle;
+    }
+    random = CreateObject<UniformRandomVariable>();
+}
+
+void ClientSelector::observe(const TelemetryRecord& record) {
+    auto found = handles.find(record.droneId);
+    if (found == handles.end()) {
+        return;
+    }
+    Entry& entry = table[found->second];
+    entry.seen = true;
+    entry.charge = record.percentage;
+    entry.position = Vector(record.x, record.y, record.z);
+    entry.time = record.time;
+}
+
+void ClientSelector::uploaded(Handle handle, Time duration) {
+    Entry& entry = table[handle];
+    double analytic = fleet.uploadTime(handle, entry.position).GetSeconds();
+    if (!entry.seen || !duration.IsStrictlyPositive() || !(analytic > 0)) {
+        return;
+    }
+    double scale = analytic / duration.GetSeconds();
+    entry.rateScale = entry.rateScale > 0 ? 0.5 * entry.rateScale + 0.5 * scale : scale;
+}
+
+bool ClientSelector::candidate(Handle handle, Candidate& out) const {
+    const Entry& entry = table[handle];
+    if (!entry.seen) {
+        return false;
+    }
+    const Drone& drone = fleet.get(handle);
+    out.handle = handle;
+    out.seconds = drone.calculateComputeTime();
+    out.joules = drone.calculateComputePower() * out.seconds;
+    if (entry.rateScale > 0) {
+        out.seconds += fleet.uploadTime(handle, entry.position).GetSeconds() / entry.rateScale;
+        out.joules += fleet.uploadEnergy(handle, entry.position) / entry.rateScale;
+    }
+    out.chargeAfter = entry.charge - 100 * out.joules / drone.getMaxCapacity();
+    return true;
+}
+
+bool ClientSelector::predict(Handle handle, double& seconds, double& joules) const {
+    Candidate prediction;
+    if (!candidate(handle, prediction)) {
+        return false;
+    }
+    seconds = prediction.seconds;
+    joules = prediction.joules;
+    return true;
+}
+
+bool ClientSelector::faster(const Candidate& a, const Candidate& b) {
+    return a.seconds < b.seconds || (a.seconds == b.seconds && a.handle < b.handle);
+}
+
+void ClientSelector::select(const std::vector<Handle>& candidates, uint32_t count, std::vector<Handle>& out) {
+    selections++;
+    offered += candidates.size();
+    size_t first = out.size();
+    size_t limit = count > 0 ? count : config.perRound > 0 ? config.perRound : candidates.size();
+
+    if (config.policy == ALL) {
+        out.insert(out.end(), candidates.begin(), candidates.begin() + std::min(limit, candidates.size()));
+        selected += out.size() - first;
+        return;
+    }
+
+    std::vector<Candidate> known;
+    known.reserve(candidates.size());
+    for (Handle handle : candidates) {
+        Candidate c;
+        if (candidate(handle, c)) {
+            known.push_back(c);
+        } else {
+            unknown++;
+        }
+    }
+
+    switch (config.policy) {
+    case DEADLINE: {
+        double budget = config.deadline.GetSeconds();
+        if (budget <= 0 && !known.empty()) {
+            // Same straggler rule as the rounds without a deadline
+            std::vector<double> seconds;
+            for (const Candidate& c : known) {
+                seconds.push_back(c.seconds);
+            }
+            std::nth_element(seconds.begin(), seconds.begin() + seconds.size() / 2, seconds.end());
+            budget = 1.5 * seconds[seconds.size() / 2];
+        }
+        auto late = std::remove_if(known.begin(), known.end(), [budget](const Candidate& c) {
+            return c.seconds > budget;
+        });
+        overDeadline += known.end() - late;
+        known.erase(late, known.end());
+        std::sort(known.begin(), known.end(), faster);
+        break;
+    }
+    case ENERGY: {
+        double floor = config.minCharge;
+        auto poor = std::remove_if(known.begin(), known.end(), [floor](const Candidate& c) {
+            return c.chargeAfter < floor;
+        });
+        lowEnergy += known.end() - poor;
+        known.erase(poor, known.end());
+        std::sort(known.begin(), known.end(), [](const Candidate& a, const Candidate& b) {
+            return a.chargeAfter > b.chargeAfter || (a.chargeAfter == b.chargeAfter && a.handle < b.handle);
+        });
+        break;
+    }
+    case POWER_OF_CHOICE: {
+        size_t choices = config.choices > 0 ? config.choices : 2 * limit;
+        if (choices < known.size()) {
+            // Partial Fisher-Yates, the first choices entries are the draw
+            for (size_t i = 0; i < choices; ++i) {
+                size_t j = random->GetInteger(i, known.size() - 1);
+                std::swap(known[i], known[j]);
+            }
+            known.resize(choices);
+        }
+        std::sort(known.begin(), known.end(), faster);
+        break;
+    }
+    default:
+        break;
+    }
+
+    for (size_t i = 0; i < known.size() && i < limit; ++i) {
+        out.push_back(known[i].handle);
+    }
+    selected += out.size() - first;
+}
+
+void ClientSelector::report(std::ostream& os) const {
+    os << "FL selection " << name(config.policy) << ": ";
+    if (selections == 0) {
+        os << "no selection" << std::endl;
+        return;
+    }
+    os << double(selected) / selections << " of " << double(offered) / selections << " idle drones per selection ("
+       << selections << " selections); " << unknown << " unheard, " << overDeadline << " past the deadline, "
+       << lowEnergy << " short of energy" << std::endl;
+}
@@ -0,0 +1,113 @@
+#ifndef CLIENTSELECTOR_H
+#define CLIENTSELECTOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
+#include "../drone/DroneFleet.h"
+#include "../telemetry/TelemetrySink.h"
+
+class ScenarioDocument;
+
+/*
+ * Server-side choice of the FL round participants.
+ *
+ * The edge server keeps a table of the drones it hears from: state of
+ * charge and position of the last telemetry sample, so nothing is read
+ * from the drones themselves. From it every candidate gets a predicted
+ * round time and energy: local training from calculateComputeTime() and
+ * calculateComputePower(), upload from the air-to-ground rate at the
+ * reported AP distance. The analytic rate is only trusted relative to
+ * itself: every measured upload rescales it (EWMA of analytic over measured
+ * time), and until the first one the upload is predicted free.
+ *
+ *  - ALL: every idle drone, the former behaviour.
+ *  - DEADLINE: the fastest predictions that fit the round deadline (the
+ *    SYNC one, else 1.5 times the median prediction).
+ *  - ENERGY: drones above MinCharge that can afford the round, the most
+ *    charge left after it first.
+ *  - POWER_OF_CHOICE: Choices drones drawn at random, the fastest
+ *    predictions of them.
+ * A drone never heard from is only picked by ALL.
+ */
+class ClientSelector {
+public:
+    typedef DroneFleet::Handle Handle;
+
+    enum Policy { ALL, DEADLINE, ENERGY, POWER_OF_CHOICE };
+
+    struct Config {
+        Policy policy;
+        uint32_t perRound;     // Participants per round, zero for every eligible one
+        double minCharge;      // ENERGY floor (%)
+        uint32_t choices;      // POWER_OF_CHOICE candidates, zero for twice perRound
+        ns3::Time deadline;    // DEADLINE budget, zero for the median rule
+    };
+
+    explicit ClientSelector(DroneFleet& fleet);
+
+    // "all", "deadline", "energy" or "poc"
+    static bool parse(const std::string& name, Policy& policy);
+    static std::string name(Policy policy);
+
+    // Scenario "FlSelection" ("all"), "FlClientsPerRound" (0), "FlMinCharge"
+    // (%, 20) and "FlChoices" (0); the deadline is the FL one
+    static Config configFrom(const ScenarioDocument& scenario, ns3::Time deadline);
+
+    // Map the telemetry drone ids (node ids) to fleet handles
+    void install(const Config& config);
+
+    // Telemetry sample received by the edge server
+    void observe(const TelemetryRecord& record);
+    // Measured upload of the drone model
+    void uploaded(Handle handle, ns3::Time duration);
+
+    // Appends up to count participants (zero for perRound) among candidates
+    void select(const std::vector<Handle>& candidates, uint32_t count, std::vector<Handle>& selected);
+
+    // Predictions from the table, false for a drone never heard from
+    bool predict(Handle handle, double& seconds, double& joules) const;
+
+    // Prints the selections and the exclusions of every policy filter
+    void report(std::ostream& os) const;
+
+private:
+    struct Entry {
+        bool seen;
+        double charge;          // Remaining battery (%)
+        ns3::Vector position;
+        double time;            // Of the sample (s)
+        double rateScale;       // Analytic over measured upload time, zero before the first upload
+    };
+
+    struct Candidate {
+        Handle handle;
+        double seconds;
+        double joules;
+        double chargeAfter;     // % left after the round
+    };
+
+    bool candidate(Handle handle, Candidate& out) const;
+    static bool faster(const Candidate& a, const Candidate& b);
+
+    DroneFleet& fleet;
+    Config config;
+    std::unordered_map<uint32_t, Handle> handles;  // Node id -> handle
+    std::vector<Entry> table;
+    ns3::Ptr<ns3::UniformRandomVariable> random;
+
+    uint64_t selections;        // select() calls
+    uint64_t offered;
+    uint64_t selected;
+    uint64_t unknown;           // Never heard from
+    uint64_t overDeadline;
+    uint64_t lowEnergy;
+};
+
+#endif // CLIENTSELECTOR_H
@@ -0,0 +1,422 @@
+#include "FlOrchestrator.h"
+#include "../parser/ScenarioDocument.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+
+using namespace ns3;
+
+FlOrchestrator::FlOrchestrator(DroneFleet& droneFleet)
+    : fleet(droneFleet), selector(droneFleet), config(), refillPending(false), version(0), round(0), dispatchedCount(0),
+      pending(0), roundOpen(false), uploadFailures(0), lateUpdates(0), lostJ(0) {}
+
+bool FlOrchestrator::parse(const std::string& name, Mode& mode) {
+    if (name == "sync") {
+        mode = SYNC;
+    } else if (name == "fedasync") {
+        mode = FED_ASYNC;
+    } else if (name == "fedbuff") {
+        mode = FED_BUFF;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string FlOrchestrator::name(Mode mode) {
+    return mode == FED_ASYNC ? "fedasync" : mode == FED_BUFF ? "fedbuff" : "sync";
+}
+
+FlOrchestrator::Config FlOrchestrator::configFrom(const ScenarioDocument& scenario, Mode mode,
+                                                  ClientSelector::Policy policy) {
+    Config config;
+    config.mode = mode;
+    config.rounds = static_cast<uint32_t>(scenario.getDouble("FlRounds", 10));
+    config.deadline = Seconds(scenario.getDouble("FlDeadline", 0));
+    config.aggregationTime = Seconds(scenario.getDouble("FlAggregationTime", 0.05));
+    config.aggregationPerUpdate = Seconds(scenario.getDouble("FlAggregationPerUpdate", 0.01));
+    config.bufferSize = std::max(1.0, scenario.getDouble("FlBufferSize", 2));
+    config.maxStaleness = static_cast<uint32_t>(scenario.getDouble("FlMaxStaleness", 4));
+    config.port = 5000;
+    config.selection = ClientSelector::configFrom(scenario, config.deadline);
+    config.selection.policy = policy;
+    return config;
+}
+
+void FlOrchestrator::install(const Config& flConfig, Ptr<Node> node, Ipv4Address address) {
+    config = flConfig;
+    server = node;
+    serverAddress = address;
+    selector.install(config.selection);
+    listener = Socket::CreateSocket(server, TcpSocketFactory::GetTypeId());
+    listener->Bind(InetSocketAddress(Ipv4Address::GetAny(), config.port));
+    listener->Listen();
+    listener->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
+                                MakeCallback(&FlOrchestrator::accepted, this));
+}
+
+void FlOrchestrator::start(Time at) {
+    NS_ASSERT_MSG(server, "FlOrchestrator::install must come first");
+    clients.assign(fleet.size(), Client{IDLE, 0, 0, Time(), Time(), 0, 0, 0, 0, 0, nullptr});
+    started = at;
+    lastAggregation = at;
+    serverFree = at;
+    Simulator::ScheduleWithContext(server->GetId(), at, &FlOrchestrator::startRound, this);
+}
+
+const std::vector<FlOrchestrator::Round>& FlOrchestrator::getRounds() const { return rounds; }
+ClientSelector& FlOrchestrator::getSelector() { return selector; }
+
+void FlOrchestrator::selectClients(std::vector<Handle>& selected, uint32_t count) {
+    // Among the drones of this rank that are not still busy with an older round
+    std::vector<Handle> idle;
+    for (Handle handle = 0; handle < clients.size(); ++handle) {
+        if (fleet.getSocket(handle) && clients[handle].phase == IDLE) {
+            idle.push_back(handle);
+        }
+    }
+    if (!idle.empty()) {
+        selector.select(idle, count, selected);
+    }
+}
+
+void FlOrchestrator::startRound() {
+    if (config.mode != SYNC) {
+        refill();
+        return;
+    }
+    std::vector<Handle> selected;
+    selectClients(selected, 0);
+    if (selected.empty()) {
+        // Nobody heard from yet, or nobody fits
+        Simulator::Schedule(Seconds(1), &FlOrchestrator::startRound, this);
+        return;
+    }
+    round = version;
+    roundStart = Simulator::Now();
+    dispatchedCount = selected.size();
+    pending = selected.size();
+    roundOpen = true;
+    updates.clear();
+    if (config.deadline.IsStrictlyPositive()) {
+        Simulator::Schedule(config.deadline, &FlOrchestrator::closeRound, this, round);
+    }
+    for (Handle handle : selected) {
+        dispatch(handle);
+    }
+}
+
+void FlOrchestrator::refill() {
+    refillPending = false;
+    if (finished()) {
+        return;
+    }
+    uint32_t busy = 0;
+    for (const Client& client : clients) {
+        busy += client.phase != IDLE;
+    }
+    uint32_t slots = config.selection.perRound;
+    if (slots > 0 && busy >= slots) {
+        return;
+    }
+    std::vector<Handle> selected;
+    selectClients(selected, slots > 0 ? slots - busy : 0);
+    for (Handle handle : selected) {
+        dispatch(handle);
+    }
+    if (busy + selected.size() == 0) {
+        // Nobody heard from yet, or nobody fits
+        refillPending = true;
+        Simulator::Schedule(Seconds(1), &FlOrchestrator::refill, this);
+    }
+}
+
+void FlOrchestrator::closeRound(uint32_t closing) {
+    if (!roundOpen || closing != round) {
+        return;
+    }
+    roundOpen = false;
+    uint32_t stragglers = dispatchedCount - updates.size();
+    if (!config.deadline.IsStrictlyPositive() && !updates.empty()) {
+        // Everyone made it, the stragglers are the slow tail
+        std::vector<Time> durations;
+        for (const Update& update : updates) {
+            durations.push_back(update.arrived - update.dispatched);
+        }
+        std::nth_element(durations.begin(), durations.begin() + durations.size() / 2, durations.end());
+        Time median = durations[durations.size() / 2];
+        for (const Time& duration : durations) {
+            if (duration > median * 1.5) {
+                stragglers++;
+            }
+        }
+    }
+    std::vector<Update> merged;
+    merged.swap(updates);
+    aggregate(merged, roundStart, dispatchedCount, stragglers);
+}
+
+void FlOrchestrator::dispatch(Handle handle) {
+    Client& client = clients[handle];
+    const Drone& drone = fleet.get(handle);
+    double seconds = drone.calculateComputeTime();
+    client.phase = TRAINING;
+    client.version = version;
+    client.round = round;
+    client.dispatched = Simulator::Now();
+    client.trainingJ = drone.calculateComputePower() * seconds;
+    fleet.getEnergyController().setTraining(handle, true);
+    Simulator::ScheduleWithContext(drone.getNode()->GetId(),
+                                   Seconds(seconds),
+                                   &FlOrchestrator::trainingDone,
+                                   this,
+                                   handle);
+}
+
+void FlOrchestrator::trainingDone(Handle handle) {
+    Client& client = clients[handle];
+    fleet.getEnergyController().setTraining(handle, false);
+    if (finished()) {
+        client.phase = IDLE;
+        return;
+    }
+
+    // The model goes up behind the 4-byte fleet handle of the drone
+    client.phase = UPLOADING;
+    client.uploadStart = Simulator::Now();
+    client.size = 4 + static_cast<uint64_t>(fleet.get(handle).getLocalModelSize());
+    client.sent = 0;
+    client.radioStart = fleet.getRadioEnergy(handle);
+    client.analyticJ = fleet.uploadEnergy(handle);
+    client.socket = Socket::CreateSocket(fleet.get(handle).getNode(), TcpSocketFactory::GetTypeId());
+    client.socket->SetAttribute("SegmentSize", UintegerValue(1448));
+    client.socket->Bind();
+    client.socket->SetConnectCallback(MakeCallback(&FlOrchestrator::connected, this).Bind(handle),
+                                      MakeCallback(&FlOrchestrator::connectFailed, this).Bind(handle));
+    client.socket->SetCloseCallbacks(MakeNullCallback<void, Ptr<Socket>>(),
+                                     MakeCallback(&FlOrchestrator::connectFailed, this).Bind(handle));
+    client.socket->SetSendCallback(MakeCallback(&FlOrchestrator::sendMore, this).Bind(handle));
+    client.socket->Connect(InetSocketAddress(serverAddress, config.port));
+}
+
+void FlOrchestrator::connected(Handle handle, Ptr<Socket> socket) {
+    sendMore(handle, socket, socket->GetTxAvailable());
+}
+
+void FlOrchestrator::connectFailed(Handle handle, Ptr<Socket> socket) {
+    if (clients[handle].phase == UPLOADING && clients[handle].socket == socket) {
+        failed(handle);
+    }
+}
+
+void FlOrchestrator::sendMore(Handle handle, Ptr<Socket> socket, uint32_t available) {
+    Client& client = clients[handle];
+    if (client.socket != socket) {
+        return;
+    }
+    // As much as the TCP buffer takes, the send callback asks for the rest
+    while (client.sent < client.size && socket->GetTxAvailable() > 0) {
+        Ptr<Packet> packet;
+        if (client.sent == 0) {
+            uint8_t id[4] = {uint8_t(handle >> 24), uint8_t(handle >> 16), uint8_t(handle >> 8), uint8_t(handle)};
+            packet = Create<Packet>(id, 4);
+        } else {
+            packet = Create<Packet>(std::min<uint64_t>(client.size - client.sent, socket->GetTxAvailable()));
+        }
+        int sent = socket->Send(packet);
+        if (sent <= 0) {
+            break;
+        }
+        client.sent += sent;
+    }
+    if (client.sent == client.size) {
+        socket->SetSendCallback(MakeNullCallback<void, Ptr<Socket>, uint32_t>());
+        socket->Close();
+    }
+}
+
+void FlOrchestrator::accepted(Ptr<Socket> socket, const Address& from) {
+    inbound[socket] = Inbound{0, {0, 0, 0, 0}};
+    socket->SetRecvCallback(MakeCallback(&FlOrchestrator::receive, this));
+    socket->SetCloseCallbacks(MakeCallback(&FlOrchestrator::closed, this),
+                              MakeCallback(&FlOrchestrator::closed, this));
+}
+
+void FlOrchestrator::receive(Ptr<Socket> socket) {
+    Inbound& in = inbound[socket];
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv())) {
+        uint32_t size = packet->GetSize();
+        if (in.received < 4) {
+            uint32_t header = std::min<uint64_t>(4 - in.received, size);
+            packet->CopyData(in.id + in.received, header);
+        }
+        in.received += size;
+        if (in.received < 4) {
+            continue;
+        }
+        Handle handle = (uint32_t(in.id[0]) << 24) | (uint32_t(in.id[1]) << 16) | (uint32_t(in.id[2]) << 8) | in.id[3];
+        if (handle < clients.size() && clients[handle].phase == UPLOADING && in.received == clients[handle].size) {
+            arrived(handle);
+        }
+    }
+}
+
+void FlOrchestrator::closed(Ptr<Socket> socket) {
+    inbound.erase(socket);
+}
+
+void FlOrchestrator::arrived(Handle handle) {
+    Client& client = clients[handle];
+    client.phase = IDLE;
+    client.socket = nullptr;
+    selector.uploaded(handle, Simulator::Now() - client.uploadStart);
+    Update update{handle,
+                  client.version,
+                  client.dispatched,
+                  Simulator::Now(),
+                  client.trainingJ,
+                  fleet.getRadioEnergy(handle) - client.radioStart,
+                  client.analyticJ};
+    if (finished()) {
+        lostJ += update.trainingJ + update.radioJ;
+        return;
+    }
+
+    switch (config.mode) {
+    case SYNC:
+        if (!roundOpen || client.round != round) {
+            lateUpdates++;
+            lostJ += update.trainingJ + update.radioJ;
+            return;
+        }
+        updates.push_back(update);
+        if (--pending == 0) {
+            closeRound(round);
+        }
+        break;
+    case FED_ASYNC:
+        aggregate(std::vector<Update>(1, update), lastAggregation, 1, 0);
+        break;
+    case FED_BUFF:
+        updates.push_back(update);
+        refill();
+        if (updates.size() >= config.bufferSize) {
+            std::vector<Update> merged;
+            merged.swap(updates);
+            aggregate(merged, lastAggregation, merged.size(), 0);
+        }
+        break;
+    }
+}
+
+void FlOrchestrator::failed(Handle handle) {
+    Client& client = clients[handle];
+    client.phase = IDLE;
+    client.socket = nullptr;
+    uploadFailures++;
+    lostJ += client.trainingJ + fleet.getRadioEnergy(handle) - client.radioStart;
+    if (config.mode == SYNC) {
+        if (roundOpen && client.round == round && --pending == 0) {
+            closeRound(round);
+        }
+    } else if (!finished() && !refillPending) {
+        // Out of reach for now, fill its slot a bit later
+        refillPending = true;
+        Simulator::Schedule(Seconds(1), &FlOrchestrator::refill, this);
+    }
+}
+
+void FlOrchestrator::aggregate(std::vector<Update> merged, Time start, uint32_t dispatched, uint32_t stragglers) {
+    // One aggregation at a time on the server
+    Time begin = std::max(Simulator::Now(), serverFree);
+    serverFree = begin + config.aggregationTime + config.aggregationPerUpdate * merged.size();
+    Simulator::ScheduleWithContext(server->GetId(),
+                                   serverFree - Simulator::Now(),
+                                   &FlOrchestrator::aggregated,
+                                   this,
+                                   merged,
+                                   start,
+                                   dispatched,
+                                   stragglers);
+}
+
+void FlOrchestrator::aggregated(std::vector<Update> merged, Time start, uint32_t dispatched, uint32_t stragglers) {
+    if (finished()) {
+        return;
+    }
+    Round done{config.mode == SYNC ? start : lastAggregation, Simulator::Now(), dispatched, 0, stragglers, 0, 0, 0, 0};
+    for (const Update& update : merged) {
+        uint32_t staleness = version - update.version;
+        if (config.mode != SYNC && staleness > config.maxStaleness) {
+            done.stragglers++;
+        }
+        done.updates++;
+        done.staleness += staleness;
+        done.trainingJ += update.trainingJ;
+        done.radioJ += update.radioJ;
+        done.analyticJ += update.analyticJ;
+    }
+    version++;
+    lastAggregation = Simulator::Now();
+    rounds.push_back(done);
+
+    if (finished()) {
+        return;
+    }
+    if (config.mode == SYNC) {
+        startRound();
+    } else if (config.mode == FED_ASYNC) {
+        refill();
+    }
+}
+
+bool FlOrchestrator::finished() const {
+    return version >= config.rounds;
+}
+
+void FlOrchestrator::report(std::ostream& os) const {
+    os << "FL " << name(config.mode) << ": " << rounds.size() << "/" << config.rounds << " rounds";
+    if (!rounds.empty()) {
+        double latency = 0;
+        double longest = 0;
+        uint64_t clientCount = 0;
+        uint64_t stragglers = 0;
+        uint64_t merged = 0;
+        double staleness = 0;
+        double trainingJ = 0;
+        double radioJ = 0;
+        double analyticJ = 0;
+        for (const Round& done : rounds) {
+            double seconds = (done.end - done.start).GetSeconds();
+            latency += seconds;
+            longest = std::max(longest, seconds);
+            clientCount += done.clients;
+            stragglers += done.stragglers;
+            merged += done.updates;
+            staleness += done.staleness;
+            trainingJ += done.trainingJ;
+            radioJ += done.radioJ;
+            analyticJ += done.analyticJ;
+        }
+        os << ", round latency " << latency / rounds.size() << " s mean, " << longest << " s max; stragglers "
+           << (clientCount > 0 ? (100.0 * stragglers) / clientCount : 0) << "% of " << clientCount
+           << " clients; " << (trainingJ + radioJ) / rounds.size() << " J per round (" << trainingJ / rounds.size()
+           << " J training, " << radioJ / rounds.size() << " J upload radio, analytic upload "
+           << analyticJ / rounds.size() << " J)";
+        if (merged > 0) {
+            os << "; staleness " << staleness / merged << " mean";
+        }
+        if (finished()) {
+            // Wall-clock and energy of the whole run, lost updates included
+            os << "; converged in " << (rounds.back().end - started).GetSeconds() << " s and "
+               << trainingJ + radioJ + lostJ << " J";
+        }
+    }
+    os << "; " << uploadFailures << " failed uploads, " << lateUpdates << " late, " << lostJ << " J lost"
+       << std::endl;
+    selector.report(os);
+}
@@ -0,0 +1,184 @@
+#ifndef FLORCHESTRATOR_H
+#define FLORCHESTRATOR_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/socket.h"
+#include "../drone/DroneFleet.h"
+#include "ClientSelector.h"
+
+class ScenarioDocument;
+
+/*
+ * Federated learning rounds between the drones of this rank and its edge
+ * server (the AP).
+ *
+ * A client trains for the drone calculateComputeTime() while the
+ * EnergyController draws its calculateComputePower(), then uploads
+ * localModelSize bytes to the server over a TCP connection through the
+ * simulated Wi-Fi cell. The server aggregates in arrival order, one
+ * aggregation at a time, each taking AggregationTime plus
+ * AggregationPerUpdate for every update it merges.
+ *
+ * The participants come from the ClientSelector, fed by the telemetry the
+ * server receives.
+ *
+ *  - SYNC: every round dispatches the global model to the selected clients
+ *    and aggregates when all of them uploaded, or at the round deadline;
+ *    stragglers are the clients that missed it (without a deadline, the
+ *    ones finishing after 1.5 times the median).
+ *  - FED_ASYNC: every update is merged on its own, then the selector fills
+ *    the free client slots from the new global model.
+ *  - FED_BUFF: updates are buffered and merged BufferSize at a time, the
+ *    selector fills a client slot as soon as its upload is done.
+ * A client slot is one of FlClientsPerRound concurrent clients, every idle
+ * drone when it is zero.
+ * In both asynchronous modes a round is one aggregation and the updates
+ * older than MaxStaleness versions are the stragglers (merged anyway).
+ *
+ * The global model broadcast is not simulated, a dispatched client starts
+ * training at once.
+ */
+class FlOrchestrator {
+public:
+    typedef DroneFleet::Handle Handle;
+
+    enum Mode { SYNC, FED_ASYNC, FED_BUFF };
+
+    struct Config {
+        Mode mode;
+        uint32_t rounds;              // Aggregations to run
+        ns3::Time deadline;           // SYNC round deadline, zero for none
+        ns3::Time aggregationTime;    // Fixed cost of one aggregation
+        ns3::Time aggregationPerUpdate;
+        uint32_t bufferSize;          // FED_BUFF updates per aggregation
+        uint32_t maxStaleness;        // Asynchronous straggler threshold
+        uint16_t port;
+        ClientSelector::Config selection;
+    };
+
+    // Round statistics
+    struct Round {
+        ns3::Time start;
+        ns3::Time end;              // Aggregation done
+        uint32_t clients;           // Dispatched (SYNC) or merged updates
+        uint32_t updates;           // Updates merged
+        uint32_t stragglers;
+        double staleness;           // Summed over the merged updates
+        double trainingJ;
+        double radioJ;              // Radio energy during the uploads
+        double analyticJ;           // Analytic upload cost of the same updates
+    };
+
+    explicit FlOrchestrator(DroneFleet& fleet);
+
+    // "sync", "fedasync" or "fedbuff"
+    static bool parse(const std::string& name, Mode& mode);
+    static std::string name(Mode mode);
+
+    // Scenario "FlRounds" (10), "FlDeadline" (s, 0), "FlAggregationTime"
+    // (s, 0.05), "FlAggregationPerUpdate" (s, 0.01), "FlBufferSize" (2)
+    // and "FlMaxStaleness" (4), plus the ClientSelector keys
+    static Config configFrom(const ScenarioDocument& scenario, Mode mode, ClientSelector::Policy policy);
+
+    // Listen on the server, after the Internet stack is installed
+    void install(const Config& config, ns3::Ptr<ns3::Node> server, ns3::Ipv4Address address);
+    void start(ns3::Time at);
+
+    const std::vector<Round>& getRounds() const;
+    // To be fed with the telemetry received by the edge server
+    ClientSelector& getSelector();
+
+    // Prints round latency, straggler share, energy per round, the time and
+    // energy to reach the last round and the selection counters
+    void report(std::ostream& os) const;
+
+private:
+    enum Phase { IDLE, TRAINING, UPLOADING };
+
+    struct Client {
+        Phase phase;
+        uint32_t version;           // Global model it trains on
+        uint32_t round;             // SYNC round it belongs to
+        ns3::Time dispatched;
+        ns3::Time uploadStart;
+        double trainingJ;
+        double radioStart;          // Radio energy when the upload started
+        double analyticJ;
+        uint64_t size;              // Upload size, id header included
+        uint64_t sent;
+        ns3::Ptr<ns3::Socket> socket;
+    };
+
+    struct Update {
+        Handle handle;
+        uint32_t version;
+        ns3::Time dispatched;
+        ns3::Time arrived;
+        double trainingJ;
+        double radioJ;
+        double analyticJ;
+    };
+
+    struct Inbound {
+        uint64_t received;
+        uint8_t id[4];
+    };
+
+    // Idle drones picked by the selector, count zero for its own share
+    void selectClients(std::vector<Handle>& selected, uint32_t count);
+    void startRound();
+    // Asynchronous modes: dispatch the selected idle clients to the free slots
+    void refill();
+    void closeRound(uint32_t round);
+    void dispatch(Handle handle);
+    void trainingDone(Handle handle);
+    void connected(Handle handle, ns3::Ptr<ns3::Socket> socket);
+    void connectFailed(Handle handle, ns3::Ptr<ns3::Socket> socket);
+    void sendMore(Handle handle, ns3::Ptr<ns3::Socket> socket, uint32_t available);
+    void accepted(ns3::Ptr<ns3::Socket> socket, const ns3::Address& from);
+    void receive(ns3::Ptr<ns3::Socket> socket);
+    void closed(ns3::Ptr<ns3::Socket> socket);
+    void arrived(Handle handle);
+    void failed(Handle handle);
+    void aggregate(std::vector<Update> merged, ns3::Time roundStart, uint32_t dispatched, uint32_t stragglers);
+    void aggregated(std::vector<Update> merged, ns3::Time roundStart, uint32_t dispatched, uint32_t stragglers);
+    bool finished() const;
+
+    DroneFleet& fleet;
+    ClientSelector selector;
+    Config config;
+    ns3::Ptr<ns3::Node> server;
+    ns3::Ipv4Address serverAddress;
+    ns3::Ptr<ns3::Socket> listener;
+    std::map<ns3::Ptr<ns3::Socket>, Inbound> inbound;
+
+    std::vector<Client> clients;
+    ns3::Time started;
+    bool refillPending;             // A retry of refill() is scheduled
+    uint32_t version;               // Aggregations done
+    ns3::Time serverFree;           // End of the aggregation in progress
+
+    // SYNC round in progress
+    uint32_t round;
+    ns3::Time roundStart;
+    uint32_t dispatchedCount;
+    uint32_t pending;               // Clients neither arrived nor failed
+    bool roundOpen;
+
+    std::vector<Update> updates;    // Received, not aggregated yet
+    ns3::Time lastAggregation;
+    std::vector<Round> rounds;
+    uint64_t uploadFailures;
+    uint64_t lateUpdates;           // Arrived after their SYNC round closed
+    double lostJ;                   // Spent on updates never merged
+};
+
+#endif // FLORCHESTRATOR_H
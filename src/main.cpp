@@ -46,11 +46,20 @@
 #include "ns3/wifi-radio-energy-model.h"
 #include <ns3/core-module.h>
 
+#include "drone/ChargingStations.h"
 #include "drone/Drone.h"
 #include "includes/rapidjson/include/rapidjson/document.h"
 #include "includes/rapidjson/include/rapidjson/filereadstream.h"
 #include "mobility/custom-mobility-model.h"
+#include "learning/FlOrchestrator.h"
 #include "parser/JsonParser.h"
+#include "scenario/ScenarioBuilder.h"
+#include "scenario/SyncMonitor.h"
+#include "scenario/profiling-simulator-impl.h"
+#include "scenario/Visualization.h"
+#include "telemetry/PcapCapture.h"
+#include "telemetry/TelemetrySink.h"
+#include "telemetry/drone-telemetry-header.h"
 
 //MPI
 #ifdef NS3_MPI
@@ -59,10 +68,13 @@
 
 //STD
 #include <cstdlib>
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <fstream>
 #include <filesystem> // Include for filesystem operations (C++17)
+#include <limits>
+#include <unordered_map>
 
 using namespace ns3;
 
@@ -70,7 +82,6 @@ NS_LOG_COMPONENT_DEFINE("WifiSimpleInfra");
 
 Ptr<netsimulyzer::LogStream> eventLog;
 
-std::vector<std::string> v;
 
 void RxEndCallback (Ptr<const Packet> packet, double rssi)
 {
@@ -82,174 +93,195 @@ void RxEndCallback (Ptr<const Packet> packet, double rssi)
 /**
  * Function called when a packet is received.
  *
+ * \param telemetry The sink storing the received samples.
+ * \param builder Relays the samples to the cloud server.
+ * \param selector Keeps the FL client table up to date.
  * \param socket The receiving socket.
  */
-void EdgeLogic(Ptr<Socket> socket) {
+void EdgeLogic(TelemetrySink* telemetry, ScenarioBuilder* builder, ClientSelector* selector, Ptr<Socket> socket) {
   Ptr<Packet> packet;
   Address from;
-
-  // Open the file in append mode
-  //std::ofstream outFile("results/results.txt", std::ios::app);
-  //if (!outFile) {
-  //  NS_LOG_ERROR("Failed to open file for writing.");
-  //  return;
-  //}
+  static std::vector<uint8_t> buffer;
+  // Last AoI seen for every drone, binary packets only carry it now and then
+  static std::unordered_map<uint32_t, Box> aoiByDrone;
 
   while ((packet = socket->RecvFrom(from))) {
-    // Process the received packet as needed
-    uint8_t buffer[1024];
-    packet->CopyData(buffer, packet->GetSize());
-    std::string receivedData(reinterpret_cast<const char *>(buffer), packet->GetSize());
-
-    // Print received data to the console
-    Time now = Simulator::Now();
-    // Write the received data and timestamp to the file
-    v.push_back(receivedData);
-    std::cout << receivedData << std::endl;
+    builder->relayToCloud(packet->Copy());
+    TelemetryRecord record;
+    // Version and flags, left at 0 when the packet is shorter
+    uint8_t prefix[2] = {0, 0};
+    packet->CopyData(prefix, sizeof(prefix));
+
+    if (prefix[0] == DroneTelemetryHeader::VERSION) {
+      // The flags tell whether the AoI follows, a truncated or foreign
+      // payload is dropped here instead of being read past its end
+      if (packet->GetSize() < DroneTelemetryHeader::GetSizeForFlags(prefix[1])) {
+        NS_LOG_WARN("Truncated telemetry header of " << packet->GetSize() << " bytes");
+        continue;
+      }
+      DroneTelemetryHeader header;
+      if (packet->RemoveHeader(header) == 0) {
+        NS_LOG_WARN("Malformed telemetry header of " << packet->GetSize() << " bytes");
+        continue;
+      }
+      if (header.HasAoI()) {
+        aoiByDrone[header.GetDroneId()] = header.GetAoI();
+      }
+      Vector pos = header.GetPosition();
+      record.droneId = header.GetDroneId();
+      record.state = header.GetState();
+      record.x = pos.x;
+      record.y = pos.y;
+      record.z = pos.z;
+      record.energyConsumed = header.GetEnergyConsumed();
+      record.time = header.GetTimestamp().GetSeconds();
+      auto aoi = aoiByDrone.find(record.droneId);
+      if (aoi != aoiByDrone.end()) {
+        const Box& box = aoi->second;
+        double bounds[6] = {box.xMin, box.xMax, box.yMin, box.yMax, box.zMin, box.zMax};
+        std::copy(bounds, bounds + 6, record.aoi);
+      } else {
+        std::fill(record.aoi, record.aoi + 6, std::numeric_limits<double>::quiet_NaN());
+      }
+      record.current = header.GetCurrent();
+      record.percentage = header.GetPercentage();
+      record.mobilityA = header.GetMobilityA();
+      record.hardwareA = header.GetHardwareA();
+      record.computingA = header.GetComputingA();
+    } else {
+      // Debug text encoder
+      buffer.resize(packet->GetSize());
+      packet->CopyData(buffer.data(), buffer.size());
+      if (!parseTextRecord(reinterpret_cast<const char *>(buffer.data()), buffer.size(), record)) {
+        NS_LOG_WARN("Malformed telemetry packet of " << buffer.size() << " bytes");
+        continue;
+      }
+    }
+    telemetry->append(record);
+    selector->observe(record);
   }
 }  //ReceivePacket()
 
-/**
- * Drone logic. This function sends the coordinate of the node to the server.
- *
- * \param socket The sending socket.
- * \param pktSize The packet size.
- * \param pktCount The packet count.
- * \param pktInterval The interval between two packets.
- * \param node The done instance.
- */
-static void DroneLogic(Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval, Drone drone, double volt) {
-    //MOBILITY FIRST AND GATHER DATA
-    // Get the Ptr to the MobilityModel from the Drone
-    Ptr<CustomMobilityModel> mobilityModel = drone.getNode()->GetObject<CustomMobilityModel>();
-    Ptr<SimpleDeviceEnergyModel> battery = drone.getEnergyModel();
-
-    Vector pos = mobilityModel->GetPosition();
-    double ampere = 0;
-    double mobilityA = 0;
-    double computingA = 0;
-    double hwA = 0;
-
-    //TRAIN
-    if (mobilityModel->getState() == 0) {
-        ampere = 0;
-        ampere = drone.calcMovePower(mobilityModel->getState())/volt;
-        mobilityA = drone.calcMovePower(mobilityModel->getState())/volt;
-        battery->SetCurrentA(ampere); // Set the actual draw of energy
-    }
-    if (mobilityModel->getState() == 1) {
-        ampere = 0;
-        const std::vector<std::vector<double>>& hardware = drone.getHardware();
-        if (mobilityModel->getCompState()) { //COMP STARTED BUT NO IN AOI
-            //all
-            double sum = 0.0;
-
-            // Iterate over each sub-array in hardware
-            for (const auto& hwElement : hardware) {
-                if (hwElement.size() > 2) {
-                    sum += hwElement[1]/hwElement[3];
-                }
-            }
-            ampere = drone.calculateComputePower()/1.3 + drone.calcMovePower(mobilityModel->getState())/volt + sum;
-            computingA = drone.calculateComputePower()/1.3;
-            mobilityA = drone.calcMovePower(mobilityModel->getState())/volt;
-            hwA = sum;
-            battery->SetCurrentA(ampere); // Set the actual draw of energy
-        } else {  //NOT IN AOI NO COMP
-            double sum = 0.0;
-
-            // Iterate over each sub-array in hardware
-            for (const auto& hwElement : hardware) {
-                if (hwElement.size() > 2) {
-                    sum += hwElement[1]/hwElement[3];
-                }
-            }
-            //only hover + drag
-            ampere = drone.calcMovePower(mobilityModel->getState())/volt;
-            mobilityA = drone.calcMovePower(mobilityModel->getState())/volt;
-            battery->SetCurrentA(ampere); // Set the actual draw of energy
-        }
-        //std::cout << "Hover Power + drag + computation: " << drone.calculateComputePower() << std::endl;
-    }
-    if (mobilityModel->getState() == 2) {  // IN AOI AND COMPUTE
-        ampere = 0;
-        const std::vector<std::vector<double>>& hardware = drone.getHardware();
-        double sum = 0.0;
-
-        // Iterate over each sub-array in hardware
-        for (const auto& hwElement : hardware) {
-            if (hwElement.size() > 2) {
-                sum += hwElement[2]/hwElement[3]; //HARDWARE ON
-            }
-        }
-        ampere = drone.calculateComputePower()/1.3 + drone.calcMovePower(mobilityModel->getState())/volt + sum;
-        computingA = drone.calculateComputePower()/1.3;
-        mobilityA = drone.calcMovePower(mobilityModel->getState())/volt;
-        hwA = sum;
-        battery->SetCurrentA(ampere); // Set the actual draw of energy
-    }
-    if (mobilityModel->getState() == 3) {
-        ampere = 0;
-        ampere = drone.calcMovePower(mobilityModel->getState())/volt;
-        mobilityA = drone.calcMovePower(mobilityModel->getState())/volt;
-        battery->SetCurrentA(ampere); // Set the actual draw of energy
-    }
-
-    double percentage = (battery->GetTotalEnergyConsumption() / drone.getMaxCapacity())*100;
-
-    if (drone.getNode()->GetId() != 0){
-        //std::cout << percentage << std::endl;
-    }
-
-    //MESSAGE TO SERVER
-    if (percentage < 100) {
-        // Set the payload string
-        std::ostringstream msgx;
-        Time now = Simulator::Now();
-        msgx << drone.getNode()->GetId() << " " << pos.x << " " << pos.y << " " << pos.z << " " << battery->GetTotalEnergyConsumption()<< " " << now << " " << mobilityModel->getAoI() << " " << ampere << " " << 100-percentage << " " << mobilityA << " " << hwA << " " << computingA << " " << mobilityModel->getState() << '\0';
-        uint16_t packetSize = msgx.str().length() + 1;
-        Ptr<Packet> packet = Create<Packet>((uint8_t *)msgx.str().c_str(), packetSize);
-        socket->Send(packet);
-        if (drone.getNode()->GetId() == 3) {
-            //std::cout << "mobility state: " << mobilityModel->getState() << " ID: " << drone.getNode()->GetId() << " Z -> " << pos.z << std::endl;
-        }
-
-        Simulator::Schedule(pktInterval,
-                            &DroneLogic,
-                            socket,
-                            pktSize,
-                            pktCount - 1,
-                            pktInterval,
-                            drone,
-                            volt);
-    }
-    else {
-        socket->Close();
-    }
-}  //DroneLogic()
 
 
 int main(int argc, char* argv[]) {
+    std::string configPath;
+    bool textTelemetry = false;
+    std::string planner;
+    std::string sync;
+    std::string lookahead;
+    std::string fl;
+    std::string flSelection;
+    double syncTune = 1.0;
+    double duration = 0;
+    std::string vis;
+    std::string pcap;
+    std::string profile;
+    std::string outputDir = "../results";
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("textTelemetry", "Send the space separated debug payload instead of the binary header", textTelemetry);
+    cmd.AddValue("planner", "Coverage planner: snake, boustrophedon, spiral or sector (default: scenario \"Planner\", else snake)", planner);
+    cmd.AddValue("sync", "MPI synchronizer: granted or nullmsg (default: scenario \"Synchronizer\", else granted)", sync);
+    cmd.AddValue("lookahead", "Delay of the AP-cloud backhaul, the lookahead between ranks (default: scenario \"Lookahead\", else 5ms)", lookahead);
+    cmd.AddValue("fl", "Federated learning rounds: off, sync, fedasync or fedbuff (default: scenario \"FlMode\", else off)", fl);
+    cmd.AddValue("flSelection", "FL client selection: all, deadline, energy or poc (default: scenario \"FlSelection\", else all)", flSelection);
+    cmd.AddValue("duration", "Simulated seconds (default: scenario \"Duration\", else 1000)", duration);
+    cmd.AddValue("vis", "Visualization: off, full, sampled, threshold or firstk (default: scenario \"Visualization\", else full)", vis);
+    cmd.AddValue("pcap", "Wi-Fi capture: off, full or ring (default: scenario \"Pcap\", else full)", pcap);
+    cmd.AddValue("profile", "Event profile: off or on, collapsed stacks in <outputDir>/profile.folded; allocations (configured with -DCOUNT_ALLOCATIONS=ON) are those of the simulation thread only (default: scenario \"Profile\", else off)", profile);
+    cmd.AddValue("syncTune", "Null message frequency factor (NullMessageSimulatorImpl::SchedulerTune)", syncTune);
+    cmd.AddValue("outputDir", "Directory of the telemetry output", outputDir);
+    cmd.AddNonOption("config", "Path of the scenario JSON", configPath);
+    cmd.Parse(argc, argv);
+
     // Check if the program received a file path as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <config file path>" << std::endl;
+    if (configPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--textTelemetry] [--planner=<name>] [--sync=granted|nullmsg] [--lookahead=<time>] [--fl=off|sync|fedasync|fedbuff] [--flSelection=all|deadline|energy|poc] [--duration=<s>] [--vis=off|full|sampled|threshold|firstk] [--pcap=off|full|ring] [--profile=off|on] [--outputDir=<dir>] [--RngRun=<n>] <config file path>" << std::endl;
         return 1; // Return error code if no argument is provided
     }
 
-    // Store the file path in a std::string
-    std::string configPath = argv[1];
-
     // Output the stored file path to verify
     std::cout << "The file path provided is: " << configPath << std::endl;
 
-    
+    // The fleet size comes from the "Drones" array of the scenario
+    ScenarioBuilder builder(configPath);
+
+    // The synchronizer has to be bound before MPI is enabled
+    if (sync.empty()) {
+        sync = builder.getScenario().getString("Synchronizer", "granted");
+    }
+    if (lookahead.empty()) {
+        lookahead = builder.getScenario().getString("Lookahead", "5ms");
+    }
+    SyncMonitor::Synchronizer synchronizer;
+    if (!SyncMonitor::parse(sync, synchronizer)) {
+        std::cerr << "Unknown synchronizer " << sync << ", expected granted or nullmsg" << std::endl;
+        return 1;
+    }
+    Time backhaulDelay(lookahead);
+    if (!backhaulDelay.IsStrictlyPositive()) {
+        std::cerr << "The lookahead must be positive, got " << lookahead << std::endl;
+        return 1;
+    }
+    if (fl.empty()) {
+        fl = builder.getScenario().getString("FlMode", "off");
+    }
+    FlOrchestrator::Mode flMode = FlOrchestrator::SYNC;
+    if (fl != "off" && !FlOrchestrator::parse(fl, flMode)) {
+        std::cerr << "Unknown FL mode " << fl << ", expected off, sync, fedasync or fedbuff" << std::endl;
+        return 1;
+    }
+    if (flSelection.empty()) {
+        flSelection = builder.getScenario().getString("FlSelection", "all");
+    }
+    ClientSelector::Policy flPolicy;
+    if (!ClientSelector::parse(flSelection, flPolicy)) {
+        std::cerr << "Unknown FL client selection " << flSelection << ", expected all, deadline, energy or poc" << std::endl;
+        return 1;
+    }
+    if (duration <= 0) {
+        duration = builder.getScenario().getDouble("Duration", 1000);
+    }
+    if (vis.empty()) {
+        vis = builder.getScenario().getString("Visualization", "full");
+    }
+    Visualization::Mode visMode;
+    if (!Visualization::parse(vis, visMode)) {
+        std::cerr << "Unknown visualization " << vis << ", expected off, full, sampled, threshold or firstk" << std::endl;
+        return 1;
+    }
+    if (pcap.empty()) {
+        pcap = builder.getScenario().getString("Pcap", "full");
+    }
+    PcapCapture::Mode pcapMode;
+    if (!PcapCapture::parse(pcap, pcapMode)) {
+        std::cerr << "Unknown capture " << pcap << ", expected off, full or ring" << std::endl;
+        return 1;
+    }
+    if (profile.empty()) {
+        profile = builder.getScenario().getString("Profile", "off");
+    }
+    if (profile != "off" && profile != "on") {
+        std::cerr << "Unknown profile " << profile << ", expected off or on" << std::endl;
+        return 1;
+    }
+    SyncMonitor::select(synchronizer, syncTune);
+
     //////////////////////////////////////
     //          MPI INIT                //
     //////////////////////////////////////
     MpiInterface::Enable (&argc, &argv);
-    GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+
     uint32_t systemId = MpiInterface::GetSystemId ();
     uint32_t systemCount = MpiInterface::GetSize ();
+    // Every rank writes its own outputs
+    std::string rankSuffix = systemId != 0 ? "-rank" + std::to_string(systemId) : "";
+
+    // Wraps the implementation MPI settled on, before the first Simulator call
+    Ptr<ProfilingSimulatorImpl> profiler;
+    if (profile == "on") {
+        profiler = ProfilingSimulatorImpl::Enable(outputDir + "/profile" + rankSuffix + ".folded");
+    }
     /*
     char name[MPI_MAX_PROCESSOR_NAME];
     int length;
@@ -257,463 +289,163 @@ int main(int argc, char* argv[]) {
     */
     std::string phyMode("DsssRate1Mbps");
     double rss = -80;           // -dBm
-    uint32_t packetSize = 1000; // bytes
     uint32_t numPackets = 10000;
     Time interval = Seconds(1.0);
     bool verbose = false;
-    bool spawnBuildings = false;
-
-    WifiHelper wifi;
-    MobilityHelper mobility;
-    MobilityHelper mobilityAP;
-    NodeContainer stas;  //stas on the left node  (LP 0)
-    NodeContainer ap;    //right access point (LP 1)
-    NetDeviceContainer staDevs;
-    PacketSocketHelper packetSocket;
-
-    uint32_t numbHosts = 2;
-    stas.Create(4, 0);  //Clients on LP rank 0 (CUSTOM mobility)
 
-    ap.Create(1, 0);            //Server on LP rank 0
+    // The backhaul links are the only ones between ranks, their delay is
+    // the lookahead of both synchronizers
+    builder.setBackhaul("100Mbps", backhaulDelay);
+    // Drones split by region across the ranks, one AP per rank
+    builder.createNodes(systemId, systemCount);
+    if (profiler) {
+        for (uint32_t i = 0; i < builder.getStas().GetN(); i++) {
+            profiler->SetContextLabel(builder.getStas().Get(i)->GetId(), "drone");
+        }
+        profiler->SetContextLabel(builder.getAp().Get(0)->GetId(), "ap");
+    }
 
     // NETSIMULYZER THINGS***********************************************************
     double minNodePosition = 0;
     double maxNodePosition = 500;
-    // These must remain positive (since the RandomDirection2dMobilityModel only accepts positive
-    // values)
-    double minSpeed = .1;
-    double maxSpeed = 5;
-    double duration = 100;
-    std::string outputFileName = "netsimulyzer-mobility-buildings-example.json";
-    std::string phoneModelPath = netsimulyzer::models::SERVER;
-    std::string droneModelPath = netsimulyzer::models::QUADCOPTER_UAV;
-    std::string dname = "Drone";
-    std::string sname = "Server";
+    std::string outputFileName = "netsimulyzer-mobility-buildings-example" + rankSuffix + ".json";
 
     // ---- NetSimulyzer ----
-    Ptr<ns3::netsimulyzer::Orchestrator> orchestrator = CreateObject<netsimulyzer::Orchestrator>(outputFileName);
-
-    // Mark possible Node locations
-    auto possibleNodeLocations = CreateObject<netsimulyzer::RectangularArea>(
-        orchestrator,
-        Rectangle{minNodePosition, maxNodePosition, minNodePosition, maxNodePosition});
-
-    // Identify the area
-    possibleNodeLocations->SetAttribute("Name", StringValue("Possible Node Locations"));
-
-    // Mark with a light green color
-    possibleNodeLocations->SetAttribute("FillColor", netsimulyzer::Color3Value{204u, 255u, 204u});
-
-    auto infoLog = CreateObject<netsimulyzer::LogStream>(orchestrator);
-
-    netsimulyzer::NodeConfigurationHelper nodeConfigHelper(orchestrator);
-    nodeConfigHelper.Set("EnableMotionTrail", BooleanValue(true));
-    nodeConfigHelper.Set("Model", StringValue(phoneModelPath));
-    nodeConfigHelper.Set("Scale", DoubleValue(3));
-    nodeConfigHelper.Set("Name", StringValue(sname));
-    nodeConfigHelper.Install(ap);
-
-    nodeConfigHelper.Set("Model", StringValue(droneModelPath));
-    nodeConfigHelper.Set("Scale", DoubleValue(10));
-    // Set the names inside netsimulyzer
-    std::string tmp;
-    for (int i = 0; i < 4; i++) {
-        tmp = dname + std::to_string(i);
-        nodeConfigHelper.Set("Name", StringValue(tmp));
-        nodeConfigHelper.Install(stas.Get(i));
-    }
-    //GENERAL SETUP
-
-    // The below set of helpers will help us to put together the wifi NICs we want
-    if (verbose)
-    {
-        WifiHelper::EnableLogComponents(); // Turn on all Wifi logging
-    }
-    wifi.SetStandard(WIFI_STANDARD_80211b);
-
-    // Create wifiPhyHelper
-    YansWifiPhyHelper wifiPhy = YansWifiPhyHelper();
-    wifiPhy.Set("RxGain", DoubleValue(0));
-    wifiPhy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
-
-    // Create wifiChannelHelper
-    YansWifiChannelHelper wifiChannel;
-    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
-    // Use LogDistancePropagationLossModel instead of FixedRssLossModel
-    wifiChannel.AddPropagationLoss("ns3::FixedRssLossModel", "Rss", DoubleValue(rss));
-
-    // Attach the channel to the phy
-    wifiPhy.SetChannel(wifiChannel.Create());
-
-    // Add a mac and disable rate control
-    WifiMacHelper wifiMac;
-    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-                                 "DataMode",
-                                 StringValue(phyMode),
-                                 "ControlMode",
-                                 StringValue(phyMode));
-
-    // Setup the rest of the MAC
-    Ssid ssid = Ssid("wifi-default");
-
-    //SETUP
-    // setup AP
-    wifiMac.SetType("ns3::ApWifiMac", "Ssid", SsidValue(ssid));
-    NetDeviceContainer apDevice = wifi.Install(wifiPhy, wifiMac, ap.Get(0));
-    NetDeviceContainer devices= apDevice;
-    devices.Add(apDevice);
-
-    // Setup STA
-    wifiMac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid));
-
-
-    for (int i = 0; i < 4; i++) {
-        NetDeviceContainer tmp = wifi.Install(wifiPhy, wifiMac, stas.Get(i));
-        devices.Add(tmp);
-    }
-
-    // Connect the callback to the PhyRxEnd trace source
-    // Connect the callback to the PhyRxEnd trace source for each device
-    
-
-    //****************************************************************************
-    //BATTERY SETUP
-
-    /********************************BATTERY MODEL**********************************************/
-
-    Ptr<GenericBatteryModel> batteryModel1 = CreateObject<GenericBatteryModel>();
-
-    batteryModel1->SetAttribute("FullVoltage", DoubleValue(12.6)); // Vfull (4.2V per cell, 3S)
-    batteryModel1->SetAttribute("MaxCapacity", DoubleValue(3.6));  // Q in Ah (3600mAh)
-
-    batteryModel1->SetAttribute("NominalVoltage", DoubleValue(11.1));  // Vnom (3.7V per cell, 3S)
-    batteryModel1->SetAttribute("NominalCapacity", DoubleValue(3.6));  // QNom in Ah
-
-    batteryModel1->SetAttribute("ExponentialVoltage", DoubleValue(11.4)); // Vexp
-    batteryModel1->SetAttribute("ExponentialCapacity", DoubleValue(1.8)); // Qexp (around 50% of the capacity)
-
-    batteryModel1->SetAttribute("InternalResistance", DoubleValue(0.01));   // R in ohms
-    batteryModel1->SetAttribute("TypicalDischargeCurrent", DoubleValue(20)); // i typical in A (20A)
-    batteryModel1->SetAttribute("CutoffVoltage", DoubleValue(9.9));           // End of charge (3.3V per cell, 3S)
-
+    // Thinned out or off for large runs (see Visualization)
+    Visualization visualization(Visualization::policyFrom(builder.getScenario(), visMode));
+    Ptr<ns3::netsimulyzer::Orchestrator> orchestrator = visualization.createOrchestrator(outputFileName);
+    Ptr<netsimulyzer::LogStream> infoLog;
 
-    // Capacity Ah(qMax) * (Vfull) voltage * 3600 = 9 * 11.1 * 3600 = 360 000
-    /********************************BATTERY MODEL**********************************************/
-    /********************************BATTERY MODEL**********************************************/
+    if (orchestrator) {
+        // Mark possible Node locations
+        auto possibleNodeLocations = CreateObject<netsimulyzer::RectangularArea>(
+            orchestrator,
+            Rectangle{minNodePosition, maxNodePosition, minNodePosition, maxNodePosition});
 
-    Ptr<GenericBatteryModel> batteryModel2 = CreateObject<GenericBatteryModel>();
+        // Identify the area
+        possibleNodeLocations->SetAttribute("Name", StringValue("Possible Node Locations"));
 
-    batteryModel2->SetAttribute("FullVoltage", DoubleValue(12.6)); // Vfull (4.2V per cell, 3S)
-    batteryModel2->SetAttribute("MaxCapacity", DoubleValue(3.6));  // Q in Ah (3600mAh)
+        // Mark with a light green color
+        possibleNodeLocations->SetAttribute("FillColor", netsimulyzer::Color3Value{204u, 255u, 204u});
 
-    batteryModel2->SetAttribute("NominalVoltage", DoubleValue(11.1));  // Vnom (3.7V per cell, 3S)
-    batteryModel2->SetAttribute("NominalCapacity", DoubleValue(3.6));  // QNom in Ah
+        infoLog = CreateObject<netsimulyzer::LogStream>(orchestrator);
 
-    batteryModel2->SetAttribute("ExponentialVoltage", DoubleValue(11.4)); // Vexp
-    batteryModel2->SetAttribute("ExponentialCapacity", DoubleValue(1.8)); // Qexp (around 50% of the capacity)
-
-    batteryModel2->SetAttribute("InternalResistance", DoubleValue(0.01));   // R in ohms
-    batteryModel2->SetAttribute("TypicalDischargeCurrent", DoubleValue(20)); // i typical in A (20A)
-    batteryModel2->SetAttribute("CutoffVoltage", DoubleValue(9.9));           // End of charge (3.3V per cell, 3S)
-
-
-
-    // Capacity Ah(qMax) * (Vfull) voltage * 3600 = 9 * 11.1 * 3600 = 360 000
-    /********************************BATTERY MODEL**********************************************/
-    /********************************BATTERY MODEL**********************************************/
-
-    Ptr<GenericBatteryModel> batteryModel3 = CreateObject<GenericBatteryModel>();
-
-    batteryModel3->SetAttribute("FullVoltage", DoubleValue(12.6)); // Vfull (4.2V per cell, 3S)
-    batteryModel3->SetAttribute("MaxCapacity", DoubleValue(3.6));  // Q in Ah (3600mAh)
-
-    batteryModel3->SetAttribute("NominalVoltage", DoubleValue(11.1));  // Vnom (3.7V per cell, 3S)
-    batteryModel3->SetAttribute("NominalCapacity", DoubleValue(3.6));  // QNom in Ah
-
-    batteryModel3->SetAttribute("ExponentialVoltage", DoubleValue(11.4)); // Vexp
-    batteryModel3->SetAttribute("ExponentialCapacity", DoubleValue(1.8)); // Qexp (around 50% of the capacity)
-
-    batteryModel3->SetAttribute("InternalResistance", DoubleValue(0.01));   // R in ohms
-    batteryModel3->SetAttribute("TypicalDischargeCurrent", DoubleValue(20)); // i typical in A (20A)
-    batteryModel3->SetAttribute("CutoffVoltage", DoubleValue(9.9));           // End of charge (3.3V per cell, 3S)
-
-
-    // Capacity Ah(qMax) * (Vfull) voltage * 3600 = 9 * 11.1 * 3600 = 360 000
-    /********************************BATTERY MODEL**********************************************/
-
-    Ptr<GenericBatteryModel> batteryModel4 = CreateObject<GenericBatteryModel>();
-
-    batteryModel4->SetAttribute("FullVoltage", DoubleValue(12.6)); // Vfull (4.2V per cell, 3S)
-    batteryModel4->SetAttribute("MaxCapacity", DoubleValue(3.6));  // Q in Ah (3600mAh)
-
-    batteryModel4->SetAttribute("NominalVoltage", DoubleValue(11.1));  // Vnom (3.7V per cell, 3S)
-    batteryModel4->SetAttribute("NominalCapacity", DoubleValue(3.6));  // QNom in Ah
-
-    batteryModel4->SetAttribute("ExponentialVoltage", DoubleValue(11.4)); // Vexp
-    batteryModel4->SetAttribute("ExponentialCapacity", DoubleValue(1.8)); // Qexp (around 50% of the capacity)
-
-    batteryModel4->SetAttribute("InternalResistance", DoubleValue(0.01));   // R in ohms
-    batteryModel4->SetAttribute("TypicalDischargeCurrent", DoubleValue(20)); // i typical in A (20A)
-    batteryModel4->SetAttribute("CutoffVoltage", DoubleValue(9.9));           // End of charge (3.3V per cell, 3S)
-
-
-
-    // Capacity Ah(qMax) * (Vfull) voltage * 3600 = 9 * 11.1 * 3600 = 360 000 J
-    /********************************BATTERY MODEL**********************************************/
-
-    
-    std::vector<Ptr<SimpleDeviceEnergyModel>> deviceEnergyModels;
-    Ptr<SimpleDeviceEnergyModel> deviceEnergyModel1 = CreateObject<SimpleDeviceEnergyModel>();
-    Ptr<SimpleDeviceEnergyModel> deviceEnergyModel2 = CreateObject<SimpleDeviceEnergyModel>();
-    Ptr<SimpleDeviceEnergyModel> deviceEnergyModel3 = CreateObject<SimpleDeviceEnergyModel>();
-    Ptr<SimpleDeviceEnergyModel> deviceEnergyModel4 = CreateObject<SimpleDeviceEnergyModel>();
-
-    batteryModel1->SetNode(stas.Get(0));
-    deviceEnergyModel1->SetEnergySource(batteryModel1);
-    batteryModel1->AppendDeviceEnergyModel(deviceEnergyModel1);
-    deviceEnergyModel1->SetNode(stas.Get(0));
-
-    batteryModel2->SetNode(stas.Get(1));
-    deviceEnergyModel2->SetEnergySource(batteryModel2);
-    batteryModel2->AppendDeviceEnergyModel(deviceEnergyModel2);
-    deviceEnergyModel2->SetNode(stas.Get(1));
-
-    batteryModel3->SetNode(stas.Get(2));
-    deviceEnergyModel3->SetEnergySource(batteryModel3);
-    batteryModel3->AppendDeviceEnergyModel(deviceEnergyModel3);
-    deviceEnergyModel3->SetNode(stas.Get(2));
-
-    batteryModel4->SetNode(stas.Get(3));
-    deviceEnergyModel4->SetEnergySource(batteryModel4);
-    batteryModel4->AppendDeviceEnergyModel(deviceEnergyModel4);
-    deviceEnergyModel4->SetNode(stas.Get(3));
-    
-
-    //****************************************************************************
-
-    //MOBILITY STAS
-    // Note that with FixedRssLossModel, the positions below are not
-    // used for received signal strength.
-    std::array<std::string, 4> startArrayX = {"1", "1", "50", "50"};
-    std::array<std::string, 4> startArrayY = {"1", "50", "1", "50"};
-
-    auto box1 = BoxValue(Box(0.0, 50.0, 0.0, 50.0, 0.0, 100.0));
-    auto box2 = BoxValue(Box(0.0, 50.0, 50.0, 100.0, 0.0, 100.0));
-    auto box3 = BoxValue(Box(50.0, 100.0, 0.0, 50.0, 0.0, 100.0));
-    auto box4 = BoxValue(Box(50.0, 100.0, 50.0, 100.0, 0.0, 100.0));
-
-    auto AoI1 = BoxValue(Box(10.0, 40.0, 10.0, 40.0, 5.0, 100.0));
-    auto AoI2 = BoxValue(Box(10.0, 40.0, 60.0, 90.0, 5.0, 100.0));
-    auto AoI3 = BoxValue(Box(60.0, 90.0, 10.0, 40.0, 5.0, 100.0));
-    auto AoI4 = BoxValue(Box(60.0, 90.0, 60.0, 90.0, 5.0, 100.0));
+        builder.configureNetSimulyzer(orchestrator, visualization);
+    }
 
-    // Create the vector of drones
-    std::vector<Drone> drones;
+    //GENERAL SETUP
+    if (verbose)
+    {
+        WifiHelper::EnableLogComponents(); // Turn on all Wifi logging
+    }
+    builder.installWifi(phyMode, rss);
 
-    double maxCapacityJ = 3.6 * 11.1 * 3600;
+    //BATTERY SETUP (one GenericBatteryModel + SimpleDeviceEnergyModel per drone)
+    builder.installEnergy();
 
-    // Create a Node, MobilityModel, and EnergyModel for each drone
-    for (int i = 0; i < 4; i++) {
-        // Create a Drone object and push it into the vector
-        if (i == 0) {
-            Drone drone(stas.Get(i), deviceEnergyModel1, maxCapacityJ, configPath, i);
-            drones.push_back(drone);
-        }
-        if (i == 1) {
-            Drone drone(stas.Get(i), deviceEnergyModel2, maxCapacityJ, configPath, i);
-            drones.push_back(drone);
-        }
-        if (i == 2) {
-            Drone drone(stas.Get(i), deviceEnergyModel3, maxCapacityJ, configPath, i);
-            drones.push_back(drone);
-        }
-        if (i == 3) {
-            Drone drone(stas.Get(i), deviceEnergyModel4, maxCapacityJ, configPath, i);
-            drones.push_back(drone);
-        }
-    }
-    
-    for (int i = 0; i < 4; i++) {
-        mobility.SetPositionAllocator("ns3::RandomDiscPositionAllocator",
-                                      "X",
-                                      DoubleValue(drones[i].getInitialX()),
-                                      "Y",
-                                      DoubleValue(drones[i].getInitialY()),
-                                      "Rho",
-                                      StringValue("ns3::UniformRandomVariable[Min=0|Max=0]"));
-        
-        if (i == 0) {                              
-            mobility.SetMobilityModel("ns3::CustomMobilityModel",
-                                      "maxHeight",
-                                      DoubleValue(drones[i].getMaxHeight()),
-                                      "AoI",
-                                      BoxValue(drones[i].getAoI()),
-                                      "Bounds",
-                                      BoxValue(drones[i].getBounds()),
-                                      "AvgVelocity",
-                                      DoubleValue(drones[i].getSpeed()));
-        }
-        if (i == 1) {                              
-            mobility.SetMobilityModel("ns3::CustomMobilityModel",
-                                      "maxHeight",
-                                      DoubleValue(drones[i].getMaxHeight()),
-                                      "AoI",
-                                      BoxValue(drones[i].getAoI()),
-                                      "Bounds",
-                                      BoxValue(drones[i].getBounds()),
-                                      "AvgVelocity",
-                                      DoubleValue(drones[i].getSpeed()));
-        }
-        if (i == 2) {                              
-            mobility.SetMobilityModel("ns3::CustomMobilityModel",
-                                      "maxHeight",
-                                      DoubleValue(drones[i].getMaxHeight()),
-                                      "AoI",
-                                      BoxValue(drones[i].getAoI()),
-                                      "Bounds",
-                                      BoxValue(drones[i].getBounds()),
-                                      "AvgVelocity",
-                                      DoubleValue(drones[i].getSpeed()));
-        }
-        if (i == 3) {                              
-            mobility.SetMobilityModel("ns3::CustomMobilityModel",
-                                      "maxHeight",
-                                      DoubleValue(drones[i].getMaxHeight()),
-                                      "AoI",
-                                      BoxValue(drones[i].getAoI()),
-                                      "Bounds",
-                                      BoxValue(drones[i].getBounds()),
-                                      "AvgVelocity",
-                                      DoubleValue(drones[i].getSpeed()));
-        }
-        //mobility->SetAttribute("Bounds", StringValue(boundArray[i]));
-                                    
-        mobility.Install(stas.Get(i));
+    //MOBILITY STAS + AP (STATIONARY AP)
+    builder.indexRegions();  // AoIs, "NoFly" boxes and buildings
+    if (planner.empty()) {
+        planner = builder.getScenario().getString("Planner", "snake");
     }
+    builder.installMobility(Vector(50.0, 50.0, 0.0), 50, planner, Simulator::Now() + Seconds(duration));
 
-    //MOBILITY AP (STATIONARY AP)
-    Ptr<ListPositionAllocator> positionAllocAP = CreateObject<ListPositionAllocator>();
-    positionAllocAP->Add(Vector(50.0, 50.0, 0.0));
-    mobilityAP.SetPositionAllocator(positionAllocAP);
-    mobilityAP.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-    mobilityAP.Install(ap);
+    NodeContainer& stas = builder.getStas();
 
-    AnimationInterface anim ("SimpleNS3Simulation_NetAnimationOutput.xml");
-
-    for (uint32_t i = 0; i < 4; ++i) {
-        anim.SetConstantPosition (stas.Get(i), 0, 0);
-    }
+    // NetAnim XML through a background writer thread
+    visualization.startAnimation("SimpleNS3Simulation_NetAnimationOutput" + rankSuffix + ".xml", stas);
 
     
     /////////////////////////////////////
     //            IP                   //
     /////////////////////////////////////
-
-    InternetStackHelper internet;
-    internet.Install(stas);
-    internet.Install(ap);
-
-    Ipv4AddressHelper ipv4;
-    ipv4.SetBase("10.1.1.0", "255.255.255.0");
-    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+    builder.installInternet();
 
     /////////////////////////////////////
     //            SOCKETS              //
     /////////////////////////////////////
-    TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
-
-    Ptr<Socket> recvSinkL = Socket::CreateSocket(ap.Get(0), tid);
-    InetSocketAddress localL = InetSocketAddress(Ipv4Address::GetAny(), 80);
-    recvSinkL->Bind(localL);
-    recvSinkL->SetRecvCallback(MakeCallback(&EdgeLogic));
-
-    InetSocketAddress remote = InetSocketAddress(Ipv4Address("255.255.255.255"), 80);
-
-    // Create an array of Ptr<Socket>
-    std::vector<Ptr<Socket>> socketArray;
-
-    // Create sockets for each node
-    for (uint32_t i = 0; i < 4; ++i) {
-        Ptr<Socket> socket = Socket::CreateSocket(stas.Get(i), tid);
-        socket->SetAllowBroadcast(true);
-        socket->Connect(remote);
-        socketArray.push_back(socket);
+    // Telemetry is streamed to <outputDir>/telemetry (one column file per field)
+    std::string telemetryDir = outputDir + "/telemetry" + rankSuffix;
+    TelemetrySink telemetry(4096);
+    if (!telemetry.open(telemetryDir)) {
+        std::cerr << "Error opening the telemetry output" << std::endl;
     }
+    telemetry.flushEvery(Seconds(10));
+    // FL rounds between the drones of this rank and its AP, the AP picks
+    // the clients from the telemetry it receives
+    FlOrchestrator learning(builder.getFleet());
+    builder.createSockets(MakeBoundCallback(&EdgeLogic, &telemetry, &builder, &learning.getSelector()));
 
-    // Tracing
-    wifiPhy.EnablePcap("wifi-simple-infra", devices);
+    // Tracing, every frame or a ring dumped on trigger events
+    PcapCapture capture(builder.getFleet());
+    capture.install(PcapCapture::configFrom(builder.getScenario(), pcapMode), builder.getWifiPhy(),
+                    "wifi-simple-infra" + rankSuffix, builder.getDevices());
 
-    //SET-UP THE SIMULATION
-
-    // Output Drone data
-    /*
-    for (size_t i = 0; i < drones.size(); ++i) {
-        std::cout << "Drone " << (i + 1) << " Data:" << std::endl;
-        std::cout << "Weight: " << drones[i].getWeight() << " kg" << std::endl;
-        std::cout << "Number of Propellers: " << drones[i].getNumbPropellers() << std::endl;
-        std::cout << "Propellers Radius: " << drones[i].getPropellersRadius() << " meters" << std::endl;
-        std::cout << "Speed: " << drones[i].getSpeed() << " m/s" << std::endl;
-        std::cout << "Energy: " << drones[i].getEnergy() << " W/h" << std::endl;
-        std::cout << "Hardware:" << std::endl;
-        for (const auto& hwElement : drones[i].getHardware()) {
-            std::cout << "  [" << hwElement[0] << ", " << hwElement[1] << ", " << hwElement[2] << "]" << std::endl;
-        }
-        std::cout << "ComputingPower Data:" << std::endl;
-        std::cout << "Number of Local Iterations: " << drones[i].getNumLocalIter() << std::endl;
-        //std::cout << "CPU Cycles x Data: " << drones[i].getCpuCycleXData() << std::endl;
-        std::cout << "Number of Training Data Sets: " << drones[i].getNumbTrainDataSet() << std::endl;
-        std::cout << "Switch Capacitance: " << drones[i].getSwitchCapacitance() << std::endl;
-        //std::cout << "CPU Frequency: " << drones[i].getCpuFreq() << " GHz" << std::endl;
-        std::cout << std::endl;
-    }
-    */
+    builder.reportSetupCost(std::cout);
 
     //SIMULATION
 
-    // Output what the simulation will do
-    //std::cout << "Testing " << numPackets << " packets sent with receiver rss " << rss << " Number of Hosts: " << numbHosts << std::endl;
-
-    if (systemId == 0) {
-        for (uint32_t i = 0; i < 4; ++i) {
-            
-            Simulator::ScheduleWithContext(socketArray[i]->GetNode()->GetId(),
-                                    Seconds(1.0),
-                                    &DroneLogic,
-                                    socketArray[i],
-                                    packetSize,
-                                    numPackets,
-                                    interval,
-                                    drones[i],
-                                    12.6);
-                                    
-        }
+    DroneFleet& fleet = builder.getFleet();
+    fleet.setPacketInterval(interval);
+    fleet.setPacketCount(numPackets);
+    fleet.setVoltage(12.6);
+    fleet.setTextTelemetry(textTelemetry);
+    fleet.start(Seconds(1.0));  // Drones of this rank
+
+    // Return to base, recharge or swap and rejoin, when the scenario has
+    // "Stations"
+    ChargingStations stations(fleet);
+    stations.install(ChargingStations::configFrom(builder.getScenario()));
+    stations.start(Seconds(1.0));
+
+    if (fl != "off") {
+        learning.install(FlOrchestrator::configFrom(builder.getScenario(), flMode, flPolicy), builder.getAp().Get(0),
+                         builder.getApAddress());
+        learning.start(Seconds(1.0));
     }
 
 
     Time now = Simulator::Now();
     //now += Seconds (105);
-    now += Seconds (1000);
+    now += Seconds (duration);
     Simulator::Stop(now);
+    auto runStart = std::chrono::steady_clock::now();
+    SyncMonitor::arm();
     Simulator::Run();
+    SyncMonitor::disarm();
+    std::chrono::duration<double> runWall = std::chrono::steady_clock::now() - runStart;
+
+    if (infoLog) {
+        *infoLog << "Scenario Finished\n";
+    }
 
-    *infoLog << "Scenario Finished\n";
+    telemetry.close();
+    std::cout << "Telemetry records written: " << telemetry.getRowCount() << std::endl;
+    fleet.reportTickCost(std::cout);
+    fleet.getEnergyController().report(std::cout);
+    std::cout << "Planner: " << planner << std::endl;
+    fleet.reportCoverage(std::cout);
+    fleet.reportRadio(std::cout);
+    if (stations.size() > 0) {
+        stations.report(std::cout);
+    }
+    capture.report(std::cout);
+    if (fl != "off") {
+        learning.report(std::cout);
+    }
+    builder.reportPropagation(std::cout);
+    builder.reportPartition(std::cout, runWall.count());
+    SyncMonitor::report(std::cout, systemId, systemCount, backhaulDelay, runWall.count());
+    if (profiler) {
+        profiler->Report(std::cout);
+    }
 
     Simulator::Destroy();
+    visualization.close();
+    visualization.report(std::cout);
 
     // Exit the MPI execution environment
     MpiInterface::Disable ();
 
-    std::string filename = "../results/results.csv";
-    std::ofstream outFile(filename);
-
-    if (outFile.is_open()) {
-        for (const auto& str : v) {
-            outFile << str << "\n";
-        }
-        outFile.close();
-    } else {
-        std::cerr << "Error write" << std::endl;
-    }
-
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,146 @@
+#include "coverage-planner.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("CoveragePlanner");
+
+NS_OBJECT_ENSURE_REGISTERED(CoveragePlanner);
+NS_OBJECT_ENSURE_REGISTERED(BoustrophedonPlanner);
+NS_OBJECT_ENSURE_REGISTERED(SpiralPlanner);
+NS_OBJECT_ENSURE_REGISTERED(SectorPartitionPlanner);
+
+TypeId CoveragePlanner::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::CoveragePlanner")
+        .SetParent<Object>()
+        .SetGroupName("Mobility");
+    return tid;
+}
+
+TypeId BoustrophedonPlanner::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::BoustrophedonPlanner")
+        .SetParent<CoveragePlanner>()
+        .SetGroupName("Mobility")
+        .AddConstructor<BoustrophedonPlanner>();
+    return tid;
+}
+
+std::vector<CoveragePlanner::Waypoint>
+BoustrophedonPlanner::PlanCoverage(const Box &area, double altitude, double spacing) const {
+    std::vector<Waypoint> path;
+    double height = area.yMax - area.yMin;
+    // Spread the lanes evenly, never further apart than spacing
+    uint32_t lanes = 1;
+    if (spacing > 0 && height > spacing) {
+        lanes = static_cast<uint32_t>(std::ceil(height / spacing));
+    }
+    double step = height / lanes;
+
+    for (uint32_t i = 0; i < lanes; i++) {
+        double y = area.yMin + (i + 0.5) * step;
+        double from = (i % 2 == 0) ? area.xMin : area.xMax;
+        double to = (i % 2 == 0) ? area.xMax : area.xMin;
+        // Reaching the lane start is a turn (or the transit for the first one)
+        path.push_back(Waypoint{Vector(from, y, altitude), 0});
+        path.push_back(Waypoint{Vector(to, y, altitude), step});
+    }
+    return path;
+}
+
+TypeId SpiralPlanner::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::SpiralPlanner")
+        .SetParent<CoveragePlanner>()
+        .SetGroupName("Mobility")
+        .AddConstructor<SpiralPlanner>();
+    return tid;
+}
+
+std::vector<CoveragePlanner::Waypoint>
+SpiralPlanner::PlanCoverage(const Box &area, double altitude, double spacing) const {
+    std::vector<Waypoint> path;
+    double half = spacing > 0 ? spacing / 2 : 0;
+    double left = area.xMin + half;
+    double right = area.xMax - half;
+    double bottom = area.yMin + half;
+    double top = area.yMax - half;
+    if (left > right || bottom > top || spacing <= 0) {
+        // Narrower than one swath, a single pass through the middle
+        double y = (area.yMin + area.yMax) / 2;
+        path.push_back(Waypoint{Vector(area.xMin, y, altitude), 0});
+        path.push_back(Waypoint{Vector(area.xMax, y, altitude), area.yMax - area.yMin});
+        return path;
+    }
+
+    path.push_back(Waypoint{Vector(left, bottom, altitude), 0});
+    while (true) {
+        path.push_back(Waypoint{Vector(right, bottom, altitude), spacing});
+        bottom += spacing;
+        if (bottom > top) {
+            break;
+        }
+        path.push_back(Waypoint{Vector(right, top, altitude), spacing});
+        right -= spacing;
+        if (left > right) {
+            break;
+        }
+        path.push_back(Waypoint{Vector(left, top, altitude), spacing});
+        top -= spacing;
+        if (bottom > top) {
+            break;
+        }
+        path.push_back(Waypoint{Vector(left, bottom, altitude), spacing});
+        left += spacing;
+        if (left > right) {
+            break;
+        }
+    }
+    return path;
+}
+
+TypeId SectorPartitionPlanner::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::SectorPartitionPlanner")
+        .SetParent<CoveragePlanner>()
+        .SetGroupName("Mobility")
+        .AddConstructor<SectorPartitionPlanner>()
+        .AddAttribute("SectorIndex",
+                      "Sector covered by this drone.",
+                      UintegerValue(0),
+                      MakeUintegerAccessor(&SectorPartitionPlanner::m_index),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("SectorCount",
+                      "Number of drones sharing the area.",
+                      UintegerValue(1),
+                      MakeUintegerAccessor(&SectorPartitionPlanner::m_count),
+                      MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+SectorPartitionPlanner::SectorPartitionPlanner() : m_index(0), m_count(1) {}
+
+std::vector<CoveragePlanner::Waypoint>
+SectorPartitionPlanner::PlanCoverage(const Box &area, double altitude, double spacing) const {
+    std::vector<Box> sectors = PartitionArea(area, m_count);
+    BoustrophedonPlanner lanes;
+    return lanes.PlanCoverage(sectors[m_index % sectors.size()], altitude, spacing);
+}
+
+std::vector<Box> PartitionArea(const Box &area, uint32_t parts) {
+    if (parts == 0) {
+        parts = 1;
+    }
+    std::vector<Box> sectors;
+    sectors.reserve(parts);
+    double width = (area.yMax - area.yMin) / parts;
+    for (uint32_t i = 0; i < parts; i++) {
+        Box sector = area;
+        sector.yMin = area.yMin + i * width;
+        sector.yMax = (i + 1 == parts) ? area.yMax : area.yMin + (i + 1) * width;
+        sectors.push_back(sector);
+    }
+    return sectors;
+}
+
+} // namespace ns3
@@ -0,0 +1,78 @@
+#ifndef COVERAGE_PLANNER_H
+#define COVERAGE_PLANNER_H
+
+#include "ns3/object.h"
+#include "ns3/box.h"
+#include "ns3/vector.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Coverage path of a drone over its area of interest.
+ *
+ * A planner only lays out the path at coverage altitude; the climb, the
+ * transit to the first waypoint and the final descent are added by
+ * CustomMobilityModel, which flies the legs at its AvgVelocity.
+ */
+class CoveragePlanner : public Object {
+public:
+  struct Waypoint {
+    Vector position;
+    double swath;   //!< Width covered by the leg ending here, 0 in transit
+  };
+
+  static TypeId GetTypeId(void);
+
+  /**
+   * \param area Area to cover, only x and y are used
+   * \param altitude Flight altitude
+   * \param spacing Distance between two adjacent passes (sensor swath)
+   * \return Waypoints in flight order, the first one is reached in transit
+   */
+  virtual std::vector<Waypoint> PlanCoverage(const Box &area, double altitude, double spacing) const = 0;
+};
+
+/**
+ * Back and forth lanes parallel to x, spacing apart.
+ */
+class BoustrophedonPlanner : public CoveragePlanner {
+public:
+  static TypeId GetTypeId(void);
+  virtual std::vector<Waypoint> PlanCoverage(const Box &area, double altitude, double spacing) const;
+};
+
+/**
+ * Inward rectangular spiral, each lap spacing inside the previous one.
+ */
+class SpiralPlanner : public CoveragePlanner {
+public:
+  static TypeId GetTypeId(void);
+  virtual std::vector<Waypoint> PlanCoverage(const Box &area, double altitude, double spacing) const;
+};
+
+/**
+ * Boustrophedon over one sector of an area shared by SectorCount drones,
+ * the sectors are the ones returned by PartitionArea.
+ */
+class SectorPartitionPlanner : public CoveragePlanner {
+public:
+  static TypeId GetTypeId(void);
+  SectorPartitionPlanner();
+  virtual std::vector<Waypoint> PlanCoverage(const Box &area, double altitude, double spacing) const;
+
+private:
+  uint32_t m_index;
+  uint32_t m_count;
+};
+
+/**
+ * Split an area in parts strips of equal width along y, so that the x lanes
+ * of every sector stay as long as the ones of the whole area.
+ */
+std::vector<Box> PartitionArea(const Box &area, uint32_t parts);
+
+} // namespace ns3
+
+#endif // COVERAGE_PLANNER_H
@@ -5,6 +5,13 @@
 #include "ns3/enum.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 
 namespace ns3 {
 
@@ -12,6 +19,12 @@ NS_LOG_COMPONENT_DEFINE("CustomMobilityModel");
 
 NS_OBJECT_ENSURE_REGISTERED(CustomMobilityModel);
 
+// Velocities closer than this (m/s) are the same course
+static const double SAME_COURSE_EPS = 1e-9;
+// Steps of a plan without Horizon, should the pattern never settle (100+
+// days at 1 Hz)
+static const uint64_t MAX_PLAN_STEPS = 10000000;
+
 TypeId CustomMobilityModel::GetTypeId(void) {
     static TypeId tid = TypeId("ns3::CustomMobilityModel")
         .SetParent<MobilityModel>()
@@ -41,7 +54,35 @@ TypeId CustomMobilityModel::GetTypeId(void) {
                       "Turn strenght",
                       DoubleValue(50),
                       MakeDoubleAccessor(&CustomMobilityModel::m_turn),
-                      MakeDoubleChecker<double>());
+                      MakeDoubleChecker<double>())
+        .AddAttribute("Planner",
+                      "Coverage planner of the AoI, none for the climb/snake/descend pattern.",
+                      PointerValue(),
+                      MakePointerAccessor(&CustomMobilityModel::m_planner),
+                      MakePointerChecker<CoveragePlanner>())
+        .AddAttribute("Regions",
+                      "Spatial index answering the AoI membership, none to use the AoI box.",
+                      PointerValue(),
+                      MakePointerAccessor(&CustomMobilityModel::m_regions),
+                      MakePointerChecker<SpatialIndex>())
+        .AddAttribute("RegionOwner",
+                      "Owner of the AoIs of this drone in Regions.",
+                      UintegerValue(SpatialIndex::ANY_OWNER),
+                      MakeUintegerAccessor(&CustomMobilityModel::m_regionOwner),
+                      MakeUintegerChecker<uint32_t>())
+        .AddAttribute("Horizon",
+                      "Time the flight is planned until, the end of the simulation.",
+                      TimeValue(Time::Max()),
+                      MakeTimeAccessor(&CustomMobilityModel::m_horizon),
+                      MakeTimeChecker())
+        .AddTraceSource("State",
+                        "Mobility state (0 climb, 1 cruise, 2 cruise in AoI, 3 descend).",
+                        MakeTraceSourceAccessor(&CustomMobilityModel::m_state),
+                        "ns3::TracedValueCallback::Int32")
+        .AddTraceSource("ComputeState",
+                        "Whether the on-board computation is running.",
+                        MakeTraceSourceAccessor(&CustomMobilityModel::m_start),
+                        "ns3::TracedValueCallback::Bool");
     return tid;
 }
 
@@ -86,25 +127,73 @@ double CustomMobilityModel::GetAvgVelocity(void) {
 }
 
 void CustomMobilityModel::DoInitialize(void) {
-    m_event = Simulator::Schedule(Seconds(m_updateInterval), &CustomMobilityModel::UpdatePosition, this);
+    StartPlan(m_position, Simulator::Now());
     MobilityModel::DoInitialize();
 }
 
+void CustomMobilityModel::StartPlan(const Vector &position, Time now) {
+    if (m_planner) {
+        PlanCoverage(position, now);
+    } else {
+        PlanCursor cursor;
+        cursor.position = position;
+        cursor.state = 0;
+        cursor.compute = true;
+        cursor.atHeight = false;
+        cursor.descend = false;
+        cursor.direction = true;
+        cursor.turnLeft = -1;
+        Plan(cursor, now);
+    }
+}
+
 void CustomMobilityModel::DoDispose(void) {
     Simulator::Cancel(m_event);
+    m_segments.clear();
+    m_current = -1;
     MobilityModel::DoDispose();
 }
 
 Vector CustomMobilityModel::DoGetPosition(void) const {
-    return m_position;
+    if (m_current < 0) {
+        return m_position;
+    }
+    // Interpolate inside the current segment
+    const Segment &seg = m_segments[m_current];
+    double t = (Simulator::Now() - seg.start).GetSeconds();
+    return Vector(seg.origin.x + seg.velocity.x * t,
+                  seg.origin.y + seg.velocity.y * t,
+                  seg.origin.z + seg.velocity.z * t);
 }
 
 void CustomMobilityModel::DoSetPosition(const Vector &position) {
+    if (m_current < 0) {
+        // Not flying yet, this is the start position
+        m_position = position;
+        return;
+    }
     m_position = position;
+    if (m_planner) {
+        // The coverage restarts from the new position
+        PlanCoverage(position, Simulator::Now());
+        return;
+    }
+    // Rebuild the cursor of the running step and replan from the new position
+    const Segment &seg = m_segments[m_current];
+    uint64_t steps = static_cast<uint64_t>((Simulator::Now() - seg.start).GetSeconds() / m_updateInterval);
+    PlanCursor cursor = seg.cursor;
+    for (uint64_t i = 0; i < steps; i++) {
+        Step(cursor);
+    }
+    cursor.position = position;
+    Plan(cursor, Simulator::Now());
 }
 
 Vector CustomMobilityModel::DoGetVelocity(void) const {
-    return m_velocity;
+    if (m_current < 0) {
+        return Vector(0.0, 0.0, 0.0);
+    }
+    return m_segments[m_current].velocity;
 }
 
 int CustomMobilityModel::DoGetState(void) const {
@@ -123,104 +212,430 @@ bool CustomMobilityModel::getCompState(void) {
     return m_start;
 }
 
+Time CustomMobilityModel::GetMissionEnd(void) const {
+    if (m_diverted || m_segments.empty() || m_segments.back().velocity.GetLength() >= SAME_COURSE_EPS) {
+        return Time::Max();
+    }
+    return m_segments.back().start;
+}
+
+double CustomMobilityModel::GetCoveredArea(void) const {
+    return GetCoveredArea(Time::Max());
+}
+
+double CustomMobilityModel::GetCoveredArea(Time until) const {
+    double area = m_archivedArea;
+    for (size_t i = 0; i + 1 < m_segments.size(); i++) {
+        const Segment &seg = m_segments[i];
+        Time end = std::min(m_segments[i + 1].start, until);
+        if (end <= seg.start) {
+            break;
+        }
+        area += seg.velocity.GetLength() * (end - seg.start).GetSeconds() * seg.swath;
+    }
+    return area;
+}
+
+bool CustomMobilityModel::IsDiverted(void) const {
+    return m_diverted;
+}
+
+void CustomMobilityModel::Archive(Time now) {
+    m_archivedArea = GetCoveredArea(now);
+    m_archivedRestricted = RestrictedSeconds(now);
+}
+
+/*
+ * Return to a station. The segments are rebuilt from now on, the part of
+ * the plan not flown yet is kept with its original times and shifted on
+ * Resume. A drone diverted again before it is back on its plan keeps the
+ * first cut.
+ */
+Time CustomMobilityModel::ReturnTo(const Vector &station) {
+  NS_ASSERT_MSG(m_current >= 0 && m_avgVelocity > 0, "The drone has to be flying its plan");
+  Time now = Simulator::Now();
+  Vector position = DoGetPosition();
+  if (!m_diverted && now >= m_rejoin) {
+    m_remaining.clear();
+    if (GetMissionEnd() > now) {
+      m_remaining.assign(m_segments.begin() + m_current, m_segments.end());
+      m_remaining.front().start = now;
+      m_remaining.front().origin = position;
+    }
+    m_breakTime = now;
+    m_breakPosition = position;
+  }
+  Archive(now);
+  Simulator::Cancel(m_event);
+  m_segments.clear();
+  m_current = -1;
+  m_diverted = true;
+
+  double t = 0;
+  Vector p = position;
+  if (p.z <= 0) {
+    Vector top = Vector(p.x, p.y, maxHeight);
+    AddLeg(p, top, 0, 0, t, now);
+    p = top;
+  }
+  Vector above = Vector(station.x, station.y, p.z);
+  AddLeg(p, above, 1, 0, t, now);
+  AddLeg(above, station, 3, 0, t, now);
+  // Landed on the station until Resume
+  PlanCursor cursor = {station, 3, false, true, true, true, -1};
+  AppendSegment(now + Seconds(t), station, Vector(0.0, 0.0, 0.0), 3, false, 0, cursor);
+  EnterSegment(0);
+  return now + Seconds(t);
+}
+
+Time CustomMobilityModel::Resume(void) {
+  NS_ASSERT_MSG(m_diverted, "Resume without ReturnTo");
+  Time now = Simulator::Now();
+  Vector position = DoGetPosition();
+  Archive(now);
+  m_diverted = false;
+  if (m_remaining.empty()) {
+    // The plan was over, fly it again
+    m_rejoin = now;
+    StartPlan(position, now);
+    return now;
+  }
+
+  Simulator::Cancel(m_event);
+  m_segments.clear();
+  m_current = -1;
+  double t = 0;
+  Vector top = Vector(position.x, position.y, m_breakPosition.z);
+  AddLeg(position, top, 0, 0, t, now);
+  AddLeg(top, m_breakPosition, 1, 0, t, now);
+  Time shift = now + Seconds(t) - m_breakTime;
+  for (Segment seg : m_remaining) {
+    seg.start += shift;
+    m_segments.push_back(seg);
+  }
+  m_remaining.clear();
+  m_rejoin = now + Seconds(t);
+  EnterSegment(0);
+  return m_rejoin;
+}
+
 std::string CustomMobilityModel::getAoI(void) {
     std::ostringstream oss;
     oss << AoI.xMin << " " << AoI.xMax << " " << AoI.yMin << " " << AoI.yMax << " " << AoI.zMin << " " << AoI.zMax;
     return oss.str();
 }
 
-void CustomMobilityModel::UpdatePosition(void) {
-  Time delta = Seconds(m_updateInterval);
-  old_pos = m_position;
+/*
+ * The climb/snake/descend pattern is deterministic, so instead of moving the
+ * drone every m_updateInterval it is stepped here once, up front. Steps with
+ * the same velocity, state and computation flag are merged in one segment:
+ * a straight snake leg or the whole climb is a single segment whatever its
+ * length. The position at every multiple of m_updateInterval is the one the
+ * stepped model had, in between it is interpolated. Steps stop one past
+ * m_horizon; a plan cut there keeps its last course.
+ */
+void CustomMobilityModel::Plan(const PlanCursor &cursor, Time now) {
+  uint64_t maxSteps = MAX_PLAN_STEPS;
+  bool toHorizon = false;
+  if (m_horizon < Time::Max()) {
+    double left = std::max(0.0, (m_horizon - now).GetSeconds());
+    uint64_t steps = static_cast<uint64_t>(std::ceil(left / m_updateInterval)) + 1;
+    toHorizon = steps <= maxSteps;
+    maxSteps = std::min(maxSteps, steps);
+  }
+  Simulator::Cancel(m_event);
+  m_segments.clear();
+  m_current = -1;
+
+  PlanCursor c = cursor;
+  bool settled = false;
+  for (uint64_t step = 0; step < maxSteps && !settled; step++) {
+    PlanCursor next = c;
+    Step(next);
+    Vector velocity = (next.position - c.position);
+    velocity.x /= m_updateInterval;
+    velocity.y /= m_updateInterval;
+    velocity.z /= m_updateInterval;
+
+    // The snake lanes are TurnStrenght apart
+    double swath = (c.state == 2 && c.compute) ? m_turn : 0;
+    AppendSegment(now + Seconds(step * m_updateInterval), c.position, velocity, c.state, c.compute, swath, c);
+
+    // Landed or stuck: nothing changes any more, the last segment lasts forever
+    settled = CalculateDistance(next.position, c.position) < SAME_COURSE_EPS && next.state == c.state &&
+              next.compute == c.compute && next.atHeight == c.atHeight &&
+              next.descend == c.descend && next.direction == c.direction &&
+              next.turnLeft == c.turnLeft;
+    c = next;
+  }
+  if (!settled) {
+    double cut = (now + Seconds(maxSteps * m_updateInterval)).GetSeconds();
+    if (toHorizon) {
+      // Still flying when the simulation ends
+      NS_LOG_WARN("Plan cut at the horizon, " << cut << " s");
+    } else {
+      std::cerr << "CustomMobilityModel: plan cut after " << maxSteps << " steps at " << cut
+                << " s, the drone keeps its last course past it" << std::endl;
+    }
+  }
+
+  // The first segment starts from the cursor, it is entered right away
+  EnterSegment(0);
+}
+
+/*
+ * Coverage flight: climb to maxHeight where the drone stands, transit to
+ * the first waypoint of the planner, fly its path and descend where it
+ * ends. Legs are flown at m_avgVelocity; the state follows the AoI
+ * membership, computation is on during the sweep legs only.
+ */
+void CustomMobilityModel::PlanCoverage(const Vector &position, Time now) {
+  Simulator::Cancel(m_event);
+  m_segments.clear();
+  m_current = -1;
+
+  PlanCursor cursor = {position, 0, false, true, false, true, -1};
+  double t = 0;
+  if (m_avgVelocity > 0) {
+    std::vector<CoveragePlanner::Waypoint> path = m_planner->PlanCoverage(AoI, maxHeight, m_turn);
+    Vector p = position;
+    Vector top = Vector(p.x, p.y, maxHeight);
+    AddLeg(p, top, 0, 0, t, now);
+    p = top;
+    for (const CoveragePlanner::Waypoint &wp : path) {
+      AddLeg(p, wp.position, -1, wp.swath, t, now);
+      p = wp.position;
+    }
+    Vector ground = Vector(p.x, p.y, 0);
+    AddLeg(p, ground, 3, 0, t, now);
+    cursor.position = ground;
+    cursor.state = 3;
+  }
+  // Landed, stays there
+  AppendSegment(now + Seconds(t), cursor.position, Vector(0.0, 0.0, 0.0), cursor.state, false, 0, cursor);
+  // The first segment starts from the cursor, it is entered right away
+  EnterSegment(0);
+}
+
+void CustomMobilityModel::AddLeg(const Vector &from, const Vector &to, int state, double swath, double &t, Time now) {
+  double length = CalculateDistance(from, to);
+  if (length < SAME_COURSE_EPS) {
+    return;
+  }
+  double duration = length / m_avgVelocity;
+  Vector velocity = to - from;
+  velocity.x /= duration;
+  velocity.y /= duration;
+  velocity.z /= duration;
+  bool compute = swath > 0;
+  PlanCursor cursor = {from, state, compute, true, false, true, -1};
+
+  if (state >= 0) {
+    AppendSegment(now + Seconds(t), from, velocity, state, compute, swath, cursor);
+    t += duration;
+    return;
+  }
+
+  // Alternate outside / inside pieces along the leg
+  std::vector<std::pair<double, double>> inside;
+  AoIIntervals(from, to, inside);
+  double done = 0;
+  inside.push_back(std::make_pair(1.0, 1.0));
+  for (const auto &in : inside) {
+    for (int piece = 0; piece < 2; piece++) {
+      double begin = piece == 0 ? done : in.first;
+      double end = piece == 0 ? in.first : in.second;
+      if (end - begin <= 0) {
+        continue;
+      }
+      Vector origin = Vector(from.x + (to.x - from.x) * begin, from.y + (to.y - from.y) * begin,
+                             from.z + (to.z - from.z) * begin);
+      cursor.position = origin;
+      cursor.state = (piece == 1) ? 2 : 1;
+      // Only the part over the AoI counts as covered
+      AppendSegment(now + Seconds(t + duration * begin), origin, velocity, cursor.state, compute,
+                    (piece == 1) ? swath : 0, cursor);
+    }
+    done = in.second;
+  }
+  t += duration;
+}
+
+bool CustomMobilityModel::InAoI(const Vector &p) const {
+  if (m_regions) {
+    return m_regions->IsInside(p, SpatialIndex::AOI, m_regionOwner);
+  }
+  return AoI.IsInside(p);
+}
+
+void CustomMobilityModel::AoIIntervals(const Vector &from, const Vector &to,
+                                       std::vector<std::pair<double, double>> &inside) const {
+  inside.clear();
+  if (!m_regions) {
+    double enter;
+    double leave;
+    if (SpatialIndex::Clip(AoI, from, to, enter, leave)) {
+      inside.push_back(std::make_pair(enter, leave));
+    }
+    return;
+  }
+  std::vector<SpatialIndex::Hit> hits;
+  m_regions->Intersect(from, to, SpatialIndex::AOI, m_regionOwner, hits);
+  MergeHits(hits, inside);
+}
+
+// Union of the hit intervals, hits are sorted by entry
+void CustomMobilityModel::MergeHits(const std::vector<SpatialIndex::Hit> &hits,
+                                    std::vector<std::pair<double, double>> &merged) {
+  merged.clear();
+  for (const SpatialIndex::Hit &hit : hits) {
+    if (!merged.empty() && hit.enter <= merged.back().second) {
+      merged.back().second = std::max(merged.back().second, hit.leave);
+    } else {
+      merged.push_back(std::make_pair(hit.enter, hit.leave));
+    }
+  }
+}
+
+Time CustomMobilityModel::GetRestrictedTime(void) const {
+  return Seconds(RestrictedSeconds(Time::Max()));
+}
+
+double CustomMobilityModel::RestrictedSeconds(Time until) const {
+  if (!m_regions) {
+    return 0;
+  }
+  double seconds = m_archivedRestricted;
+  std::vector<SpatialIndex::Hit> hits;
+  std::vector<std::pair<double, double>> inside;
+  for (size_t i = 0; i + 1 < m_segments.size(); i++) {
+    const Segment &seg = m_segments[i];
+    Time stop = std::min(m_segments[i + 1].start, until);
+    if (stop <= seg.start) {
+      break;
+    }
+    double duration = (stop - seg.start).GetSeconds();
+    Vector end = Vector(seg.origin.x + seg.velocity.x * duration, seg.origin.y + seg.velocity.y * duration,
+                        seg.origin.z + seg.velocity.z * duration);
+    if (CalculateDistance(seg.origin, end) < SAME_COURSE_EPS) {
+      if (m_regions->IsInside(seg.origin, SpatialIndex::NO_FLY | SpatialIndex::BUILDING)) {
+        seconds += duration;
+      }
+      continue;
+    }
+    m_regions->Intersect(seg.origin, end, SpatialIndex::NO_FLY | SpatialIndex::BUILDING,
+                         SpatialIndex::ANY_OWNER, hits);
+    MergeHits(hits, inside);
+    for (const auto &in : inside) {
+      seconds += (in.second - in.first) * duration;
+    }
+  }
+  return seconds;
+}
+
+void CustomMobilityModel::AppendSegment(Time start, const Vector &origin, const Vector &velocity, int state,
+                                        bool compute, double swath, const PlanCursor &cursor) {
+  if (!m_segments.empty()) {
+    const Segment &last = m_segments.back();
+    if (last.state == state && last.compute == compute && last.swath == swath &&
+        CalculateDistance(last.velocity, velocity) < SAME_COURSE_EPS) {
+      return;
+    }
+  }
+  Segment seg;
+  seg.start = start;
+  seg.origin = origin;
+  seg.velocity = velocity;
+  seg.state = state;
+  seg.compute = compute;
+  seg.swath = swath;
+  seg.cursor = cursor;
+  m_segments.push_back(seg);
+}
+
+void CustomMobilityModel::EnterSegment(size_t index) {
+  bool turned = m_current < 0 ||
+                CalculateDistance(m_segments[m_current].velocity, m_segments[index].velocity) >= SAME_COURSE_EPS;
+  m_current = index;
+  const Segment &seg = m_segments[index];
+  setState(seg.state);
+  m_start = seg.compute;
+  if (turned) {
+    NotifyCourseChange();
+  }
+  if (index + 1 < m_segments.size()) {
+    m_event = Simulator::Schedule(m_segments[index + 1].start - Simulator::Now(),
+                                  &CustomMobilityModel::EnterSegment, this, index + 1);
+  }
+}
+
+void CustomMobilityModel::Step(PlanCursor &c) const {
+  Vector old_pos = c.position;
   Vector tmp = Vector(0.0, 0.0, 0.0);
-  if (atEight) {
-    if (descend == false) { //SNAKE
-      if (m_direction) {   // ===>
+  if (c.atHeight) {
+    if (c.descend == false) { //SNAKE
+      if (c.direction) {   // ===>
         tmp.x = m_up.x * m_avgVelocity;
-        m_position = m_position + tmp;
+        c.position = c.position + tmp;
       } else {           // <====
         //FIX ALL MOVEMENT
         tmp.x = m_up.x * m_avgVelocity;
-        m_position = m_position - tmp;
+        c.position = c.position - tmp;
       }
-      if (m_bounds.IsInside(m_position) && m_start) {
-        if (AoI.IsInside(m_position)) {
-          setState(2);
+      if (m_bounds.IsInside(c.position) && c.compute) {
+        if (InAoI(c.position)) {
+          c.state = 2;
         } else {
-          setState(1);
+          c.state = 1;
         }
-        m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
-        NotifyCourseChange();
       } else {  //HERE
-        setState(2);
+        c.state = 2;
         //******************************************************************
         //  QUI ADESSO FA DESTRA E SINISTRA E BASTA!!!!
-        if (tmp_str <= 0) {
-          tmp_str = m_turn;
-          std::cout << tmp_str << std::endl;
+        if (c.turnLeft <= 0) {
+          c.turnLeft = m_turn;
         }
-        //m_position = m_position + m_left;
-        m_position.y = m_position.y + (m_left.y * m_avgVelocity); //FIX VECTORS
-        tmp_str = tmp_str - m_avgVelocity;
-        std::cout << tmp_str << std::endl;
-        if (m_direction) {
-          m_position = m_position - tmp;
+        c.position.y = c.position.y + (m_left.y * m_avgVelocity); //FIX VECTORS
+        c.turnLeft = c.turnLeft - m_avgVelocity;
+        if (c.direction) {
+          c.position = c.position - tmp;
         } else {
-          m_position = m_position + tmp;
+          c.position = c.position + tmp;
         }
-        if (m_bounds.IsInside(m_position)){
-          if (AoI.IsInside(m_position)) {
-            setState(2);
+        if (m_bounds.IsInside(c.position)){
+          if (InAoI(c.position)) {
+            c.state = 2;
           } else {
-            setState(1);
+            c.state = 1;
           }
-          if (tmp_str <= 0) {
-            m_start = true;
-            if (m_direction == true) {
-              m_direction = false;
-            } else {
-              m_direction = true;
-            }
+          if (c.turnLeft <= 0) {
+            c.compute = true;
+            c.direction = !c.direction;
           } else {
-            m_start = false;
+            c.compute = false;
           }
-          m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
-          NotifyCourseChange();
         } else {
-          //std::cout << "fine -> Y: " << m_position.x << " Y -> " << m_position.y << std::endl;
-          descend = true;
-          m_position = old_pos;
-          m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
-          NotifyCourseChange();
+          c.descend = true;
+          c.position = old_pos;
         }
 
         //****************************************************
       }
     } else { //DESCEND
-      setState(3);
-      tmp.x = up_eight.x * m_avgVelocity;
-      tmp.y = up_eight.y * m_avgVelocity;
+      c.state = 3;
       tmp.z = up_eight.z * m_avgVelocity;
-      if ((m_position.z - tmp.z) > 0){
-        m_position.z = m_position.z - tmp.z;
-        m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
+      if ((c.position.z - tmp.z) > 0){
+        c.position.z = c.position.z - tmp.z;
       } else {
-        m_position.z = 0;
-        m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
+        c.position.z = 0;
       }
     }
   } else {
-    setState(0);
-    tmp.x = up_eight.x * m_avgVelocity;
-    tmp.y = up_eight.y * m_avgVelocity;
+    c.state = 0;
     tmp.z = up_eight.z * m_avgVelocity;
-    m_position = m_position + up_eight;
-    if ((maxHeight - m_position.z) < tmp.z) {
-      //m_position = m_position - tmp;
-      m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this);
-      atEight=true;
-    } else {
-     m_event = Simulator::Schedule(delta, &CustomMobilityModel::UpdatePosition, this); 
+    c.position = c.position + up_eight;
+    if ((maxHeight - c.position.z) < tmp.z) {
+      c.atHeight = true;
     }
   }
 }
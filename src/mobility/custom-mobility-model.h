@@ -11,6 +11,12 @@
 #include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/traced-value.h"
+#include "coverage-planner.h"
+#include "spatial-index.h"
+
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
@@ -32,7 +38,50 @@ public:
   virtual Box GetBounds(void);
   virtual double GetAvgVelocity(void);
 
+  // Time the drone lands, Time::Max() if the plan never ends or the drone
+  // is diverted to a station
+  Time GetMissionEnd(void) const;
+  // Ground covered by the sweep legs (m^2)
+  double GetCoveredArea(void) const;
+  // Same, flown before until
+  double GetCoveredArea(Time until) const;
+  // Time spent in no-fly zones and buildings of Regions
+  Time GetRestrictedTime(void) const;
+
+  // Leave the plan for a station: transit at the present altitude (climb
+  // to maxHeight first when on the ground), then land on it. The rest of
+  // the plan is kept for Resume. Returns the landing time
+  Time ReturnTo(const Vector &station);
+  // Take off from the station, fly back to where the plan was left at its
+  // altitude and go on with it; a plan already over is flown again from
+  // the station. Returns the time the drone is back on its plan
+  Time Resume(void);
+  bool IsDiverted(void) const;
+
 private:
+  // Flags of the climb/snake/descend pattern after a given update step
+  struct PlanCursor {
+    Vector position;
+    int state;
+    bool compute;       //!< Computation running (m_start)
+    bool atHeight;      //!< Climb finished
+    bool descend;
+    bool direction;     //!< Snake leg towards +x
+    double turnLeft;    //!< Lateral shift still to do, <= 0 when not turning
+  };
+
+  // Constant-velocity piece of the trajectory, valid from start until the
+  // start of the next one
+  struct Segment {
+    Time start;
+    Vector origin;
+    Vector velocity;
+    int state;
+    bool compute;
+    double swath;       //!< Width of ground covered, 0 when not sweeping
+    PlanCursor cursor;  //!< Cursor at start
+  };
+
   virtual void DoInitialize(void);
   virtual void DoDispose(void);
   virtual Vector DoGetPosition(void) const;
@@ -42,42 +91,64 @@ private:
 
   void setState(int i);
 
-  void UpdatePosition(void);
+  // Climb/snake/descend or coverage plan from position, as at start
+  void StartPlan(const Vector &position, Time now);
+  // Keep the coverage and restricted time flown before now, the segments
+  // are about to be replaced
+  void Archive(Time now);
+  double RestrictedSeconds(Time until) const;
+
+  // One m_updateInterval of the pattern, the former UpdatePosition
+  void Step(PlanCursor &c) const;
+  // Precompute the segments flown from cursor, starting at time now
+  void Plan(const PlanCursor &cursor, Time now);
+  // Same with the coverage path of m_planner
+  void PlanCoverage(const Vector &position, Time now);
+  // Fly from -> to at m_avgVelocity, split where it crosses the AoI
+  // when state is negative
+  void AddLeg(const Vector &from, const Vector &to, int state, double swath, double &t, Time now);
+  bool InAoI(const Vector &p) const;
+  // Fraction intervals of from -> to inside the AoI(s)
+  void AoIIntervals(const Vector &from, const Vector &to, std::vector<std::pair<double, double>> &inside) const;
+  static void MergeHits(const std::vector<SpatialIndex::Hit> &hits, std::vector<std::pair<double, double>> &merged);
+  void AppendSegment(Time start, const Vector &origin, const Vector &velocity, int state, bool compute,
+                     double swath, const PlanCursor &cursor);
+  void EnterSegment(size_t index);
 
 
-  Vector m_position;
-  Vector m_velocity;
+  Vector m_position;    //!< Position before the first segment
   
   Vector m_up = Vector(1.0, 0.0, 0.0);
   Vector m_down = Vector(-1.0, 0.0, 0.0);
   Vector m_left = Vector(0.0, 1.0, 0.0);   //VERTICAL (Y)
   Vector m_right = Vector(0.0, -1.0, 0.0);
   Vector up_eight = Vector(0.0, 0.0, 1.0);
-  Vector m_vVector = Vector(1.0, 1.0, 1.0); //IN PIU PER ORA NON USATO
   
   
-  EventId m_event;                       //!< stored event ID
+  EventId m_event;                       //!< next segment boundary
   Box m_bounds; 
-  Box::Side t_left = Box::LEFT;
-  Box::Side t_right = Box::RIGHT;
-  Box::Side b_left = Box::LEFT;
-  Box::Side b_right = Box::RIGHT;
   Box AoI;
-  Vector old_pos;
   double m_updateInterval;
-  Ptr<UniformRandomVariable> m_random;
-  bool m_direction = true;
-  bool horizontal = true;
-  bool run = true;
   double maxHeight = 50;
   double m_avgVelocity;
-  double m_turn;  //STRENGHT
-  bool atEight = false;
-  bool descend = false;
-  int m_state = 0;
-  bool m_start = true;
-  bool m_directionvert = false;
-  double tmp_str = -1;
+  double m_turn;  //STRENGHT, also the spacing of the coverage passes
+  Ptr<CoveragePlanner> m_planner;  //!< Null flies the climb/snake/descend pattern
+  Ptr<SpatialIndex> m_regions;     //!< Shared index of the scenario, may be null
+  uint32_t m_regionOwner = SpatialIndex::ANY_OWNER;
+  Time m_horizon;                  //!< Plan steps stop past it
+  TracedValue<int> m_state = 0;   //!< 0 climb, 1 cruise, 2 cruise in AoI, 3 descend
+  TracedValue<bool> m_start = true;
+
+  std::vector<Segment> m_segments;
+  int64_t m_current = -1;   //!< Segment in use, -1 before DoInitialize
+
+  double m_archivedArea = 0;        //!< m^2 covered by replaced segments
+  double m_archivedRestricted = 0;  //!< s restricted in replaced segments
+  bool m_diverted = false;          //!< Flying to or standing on a station
+  std::vector<Segment> m_remaining; //!< Plan left at m_breakTime, for Resume
+  Time m_breakTime;
+  Vector m_breakPosition;
+  Time m_rejoin;                    //!< Back on the plan after Resume
 };
 
 } // namespace ns3
@@ -0,0 +1,256 @@
+#include "spatial-index.h"
+#include "ns3/building-list.h"
+#include "ns3/building.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("SpatialIndex");
+
+NS_OBJECT_ENSURE_REGISTERED(SpatialIndex);
+
+// Upper bound of the grid size, the cells grow past it
+static const int64_t MAX_CELLS = 1 << 22;
+
+TypeId SpatialIndex::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::SpatialIndex")
+        .SetParent<Object>()
+        .SetGroupName("Mobility")
+        .AddConstructor<SpatialIndex>()
+        .AddAttribute("CellSize",
+                      "Side of a grid cell (m).",
+                      DoubleValue(25.0),
+                      MakeDoubleAccessor(&SpatialIndex::m_cellSize),
+                      MakeDoubleChecker<double>(0.001));
+    return tid;
+}
+
+SpatialIndex::SpatialIndex()
+    : m_cellSize(25.0), m_built(false), m_x0(0), m_y0(0), m_cell(25.0), m_nx(0), m_ny(0), m_stamp(0) {}
+
+uint32_t SpatialIndex::Add(const Box &box, Kind kind, uint32_t owner) {
+    m_regions.push_back(Region{box, kind, owner});
+    m_built = false;
+    return m_regions.size() - 1;
+}
+
+void SpatialIndex::AddBuildings(void) {
+    for (BuildingList::Iterator it = BuildingList::Begin(); it != BuildingList::End(); ++it) {
+        Add((*it)->GetBoundaries(), BUILDING);
+    }
+}
+
+uint32_t SpatialIndex::GetN(void) const {
+    return m_regions.size();
+}
+
+const Box &SpatialIndex::GetRegion(uint32_t region) const {
+    return m_regions[region].box;
+}
+
+SpatialIndex::Kind SpatialIndex::GetKind(uint32_t region) const {
+    return m_regions[region].kind;
+}
+
+bool SpatialIndex::Matches(const Region &region, uint32_t kinds, uint32_t owner) const {
+    if ((region.kind & kinds) == 0) {
+        return false;
+    }
+    return owner == ANY_OWNER || region.owner == ANY_OWNER || region.owner == owner;
+}
+
+int64_t SpatialIndex::CellX(double x) const {
+    int64_t c = static_cast<int64_t>(std::floor((x - m_x0) / m_cell));
+    return std::min(std::max(c, int64_t(0)), m_nx - 1);
+}
+
+int64_t SpatialIndex::CellY(double y) const {
+    int64_t c = static_cast<int64_t>(std::floor((y - m_y0) / m_cell));
+    return std::min(std::max(c, int64_t(0)), m_ny - 1);
+}
+
+void SpatialIndex::Build(void) const {
+    m_built = true;
+    m_cellStart.clear();
+    m_items.clear();
+    m_seen.assign(m_regions.size(), 0);
+    m_stamp = 0;
+    if (m_regions.empty()) {
+        m_nx = m_ny = 0;
+        return;
+    }
+
+    double xMax = -DBL_MAX;
+    double yMax = -DBL_MAX;
+    m_x0 = DBL_MAX;
+    m_y0 = DBL_MAX;
+    for (const Region &region : m_regions) {
+        m_x0 = std::min(m_x0, region.box.xMin);
+        m_y0 = std::min(m_y0, region.box.yMin);
+        xMax = std::max(xMax, region.box.xMax);
+        yMax = std::max(yMax, region.box.yMax);
+    }
+    m_cell = m_cellSize;
+    while (true) {
+        m_nx = std::max(int64_t(1), static_cast<int64_t>(std::ceil((xMax - m_x0) / m_cell)));
+        m_ny = std::max(int64_t(1), static_cast<int64_t>(std::ceil((yMax - m_y0) / m_cell)));
+        if (m_nx * m_ny <= MAX_CELLS) {
+            break;
+        }
+        m_cell *= 2;
+    }
+
+    // Count, prefix sum, then fill
+    m_cellStart.assign(m_nx * m_ny + 1, 0);
+    for (const Region &region : m_regions) {
+        for (int64_t y = CellY(region.box.yMin); y <= CellY(region.box.yMax); y++) {
+            for (int64_t x = CellX(region.box.xMin); x <= CellX(region.box.xMax); x++) {
+                m_cellStart[y * m_nx + x + 1]++;
+            }
+        }
+    }
+    for (size_t c = 1; c < m_cellStart.size(); c++) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_items.resize(m_cellStart.back());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (uint32_t id = 0; id < m_regions.size(); id++) {
+        const Box &box = m_regions[id].box;
+        for (int64_t y = CellY(box.yMin); y <= CellY(box.yMax); y++) {
+            for (int64_t x = CellX(box.xMin); x <= CellX(box.xMax); x++) {
+                m_items[fill[y * m_nx + x]++] = id;
+            }
+        }
+    }
+    NS_LOG_INFO("Indexed " << m_regions.size() << " regions in " << m_nx << "x" << m_ny << " cells of "
+                           << m_cell << " m");
+}
+
+bool SpatialIndex::IsInside(const Vector &p, uint32_t kinds, uint32_t owner) const {
+    if (!m_built) {
+        Build();
+    }
+    if (m_nx == 0 || p.x < m_x0 || p.y < m_y0 || p.x > m_x0 + m_nx * m_cell || p.y > m_y0 + m_ny * m_cell) {
+        return false;
+    }
+    int64_t c = CellY(p.y) * m_nx + CellX(p.x);
+    for (uint32_t i = m_cellStart[c]; i < m_cellStart[c + 1]; i++) {
+        const Region &region = m_regions[m_items[i]];
+        if (Matches(region, kinds, owner) && region.box.IsInside(p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SpatialIndex::Intersect(const Vector &a, const Vector &b, uint32_t kinds, uint32_t owner,
+                             std::vector<Hit> &hits) const {
+    hits.clear();
+    if (!m_built) {
+        Build();
+    }
+    if (m_nx == 0) {
+        return;
+    }
+
+    // Part of the segment over the grid
+    Box grid(m_x0, m_x0 + m_nx * m_cell, m_y0, m_y0 + m_ny * m_cell, -DBL_MAX, DBL_MAX);
+    double t0;
+    double t1;
+    if (!Clip(grid, a, b, t0, t1)) {
+        return;
+    }
+    if (++m_stamp == 0) {
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        m_stamp = 1;
+    }
+
+    // Walk the crossed cells (Amanatides-Woo)
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    int64_t cx = CellX(a.x + dx * t0);
+    int64_t cy = CellY(a.y + dy * t0);
+    int64_t endX = CellX(a.x + dx * t1);
+    int64_t endY = CellY(a.y + dy * t1);
+    int64_t stepX = dx > 0 ? 1 : -1;
+    int64_t stepY = dy > 0 ? 1 : -1;
+    double tMaxX = DBL_MAX;
+    double tMaxY = DBL_MAX;
+    double tDeltaX = DBL_MAX;
+    double tDeltaY = DBL_MAX;
+    if (dx != 0) {
+        double edge = m_x0 + (cx + (dx > 0 ? 1 : 0)) * m_cell;
+        tMaxX = (edge - a.x) / dx;
+        tDeltaX = m_cell / std::fabs(dx);
+    }
+    if (dy != 0) {
+        double edge = m_y0 + (cy + (dy > 0 ? 1 : 0)) * m_cell;
+        tMaxY = (edge - a.y) / dy;
+        tDeltaY = m_cell / std::fabs(dy);
+    }
+
+    while (true) {
+        int64_t c = cy * m_nx + cx;
+        for (uint32_t i = m_cellStart[c]; i < m_cellStart[c + 1]; i++) {
+            uint32_t id = m_items[i];
+            if (m_seen[id] == m_stamp) {
+                continue;
+            }
+            m_seen[id] = m_stamp;
+            double enter;
+            double leave;
+            if (Matches(m_regions[id], kinds, owner) && Clip(m_regions[id].box, a, b, enter, leave)) {
+                hits.push_back(Hit{id, enter, leave});
+            }
+        }
+        if ((cx == endX && cy == endY) || std::min(tMaxX, tMaxY) > t1) {
+            break;
+        }
+        if (tMaxX < tMaxY) {
+            cx += stepX;
+            tMaxX += tDeltaX;
+        } else {
+            cy += stepY;
+            tMaxY += tDeltaY;
+        }
+        if (cx < 0 || cy < 0 || cx >= m_nx || cy >= m_ny) {
+            break;
+        }
+    }
+    std::sort(hits.begin(), hits.end(), [](const Hit &l, const Hit &r) { return l.enter < r.enter; });
+}
+
+bool SpatialIndex::Clip(const Box &box, const Vector &a, const Vector &b, double &enter, double &leave) {
+    enter = 0;
+    leave = 1;
+    const double lo[3] = {box.xMin, box.yMin, box.zMin};
+    const double hi[3] = {box.xMax, box.yMax, box.zMax};
+    const double from[3] = {a.x, a.y, a.z};
+    const double d[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+    for (int i = 0; i < 3; i++) {
+        if (d[i] == 0) {
+            if (from[i] < lo[i] || from[i] > hi[i]) {
+                return false;
+            }
+            continue;
+        }
+        double t0 = (lo[i] - from[i]) / d[i];
+        double t1 = (hi[i] - from[i]) / d[i];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        enter = std::max(enter, t0);
+        leave = std::min(leave, t1);
+        if (enter > leave) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ns3
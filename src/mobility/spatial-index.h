@@ -0,0 +1,93 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "ns3/object.h"
+#include "ns3/box.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Uniform grid over the x/y plane holding the boxes of the scenario: areas
+ * of interest, no-fly zones and building footprints.
+ *
+ * Every region is bucketed in the cells its footprint overlaps, so a point
+ * query only tests the few regions of one cell and a segment query walks
+ * the cells crossed by the segment. Height is checked exactly on the
+ * candidates. The grid is (re)built lazily on the first query after Add().
+ */
+class SpatialIndex : public Object {
+public:
+  enum Kind {
+    AOI = 1,
+    NO_FLY = 2,
+    BUILDING = 4,
+    ANY = AOI | NO_FLY | BUILDING
+  };
+
+  static const uint32_t ANY_OWNER = 0xffffffff;
+
+  // Part of a segment inside one region, as fractions of the segment
+  struct Hit {
+    uint32_t region;
+    double enter;
+    double leave;
+  };
+
+  static TypeId GetTypeId(void);
+  SpatialIndex();
+
+  // owner tells apart the AoIs of different drones
+  uint32_t Add(const Box &box, Kind kind, uint32_t owner = ANY_OWNER);
+  // Footprints of every Building of the BuildingList
+  void AddBuildings(void);
+
+  uint32_t GetN(void) const;
+  const Box &GetRegion(uint32_t region) const;
+  Kind GetKind(uint32_t region) const;
+
+  // Is p inside a region of one of the kinds (bit mask) owned by owner
+  bool IsInside(const Vector &p, uint32_t kinds, uint32_t owner = ANY_OWNER) const;
+
+  // Regions crossed by the segment a-b, sorted by entry
+  void Intersect(const Vector &a, const Vector &b, uint32_t kinds, uint32_t owner,
+                 std::vector<Hit> &hits) const;
+
+  // Fraction interval of the segment a-b inside box, false if it misses it
+  static bool Clip(const Box &box, const Vector &a, const Vector &b, double &enter, double &leave);
+
+private:
+  struct Region {
+    Box box;
+    Kind kind;
+    uint32_t owner;
+  };
+
+  void Build(void) const;
+  int64_t CellX(double x) const;
+  int64_t CellY(double y) const;
+  bool Matches(const Region &region, uint32_t kinds, uint32_t owner) const;
+
+  double m_cellSize;
+  std::vector<Region> m_regions;
+
+  // Grid in compressed rows: the regions of cell c are
+  // m_items[m_cellStart[c] .. m_cellStart[c + 1]]
+  mutable bool m_built;
+  mutable double m_x0;
+  mutable double m_y0;
+  mutable double m_cell;
+  mutable int64_t m_nx;
+  mutable int64_t m_ny;
+  mutable std::vector<uint32_t> m_cellStart;
+  mutable std::vector<uint32_t> m_items;
+  mutable std::vector<uint32_t> m_seen;   // Query stamp per region
+  mutable uint32_t m_stamp;
+};
+
+} // namespace ns3
+
+#endif // SPATIAL_INDEX_H
@@ -11,6 +11,9 @@ class Drone;
 class JsonParser {
 public:
     bool parseJson(const std::string& filename, Drone& drone, int index);
+
+    // Fill the drone from one object of the "Drones" array
+    bool parseDrone(const rapidjson::Value& droneObj, Drone& drone);
 };
 
 #endif // JSONPARSER_H
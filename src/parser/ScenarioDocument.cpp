@@ -0,0 +1,128 @@
+#include "ScenarioDocument.h"
+#include "JsonParser.h"
+#include "rapidjson/error/en.h"
+#include <cstdio>
+#include <iostream>
+
+ScenarioDocument::ScenarioDocument() : drones(nullptr) {}
+
+bool ScenarioDocument::load(const std::string& filename) {
+    drones = nullptr;
+
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp) {
+        std::cerr << "Could not open file for reading." << std::endl;
+        return false;
+    }
+
+    // Read the whole file at once, the DOM lives on top of this buffer
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(fp);
+        std::cerr << "Could not read " << filename << std::endl;
+        return false;
+    }
+    buffer.resize(static_cast<size_t>(size) + 1);
+    size_t read = fread(buffer.data(), 1, static_cast<size_t>(size), fp);
+    fclose(fp);
+    buffer[read] = '\0';
+
+    document.ParseInsitu(buffer.data());
+    if (document.HasParseError()) {
+        std::cerr << "JSON parse error at offset " << document.GetErrorOffset() << ": "
+                  << rapidjson::GetParseError_En(document.GetParseError()) << std::endl;
+        return false;
+    }
+
+    // Ensure the document is an object
+    if (!document.IsObject()) {
+        std::cerr << "Invalid JSON format." << std::endl;
+        return false;
+    }
+
+    rapidjson::Value::ConstMemberIterator it = document.FindMember("Drones");
+    if (it == document.MemberEnd() || !it->value.IsArray()) {
+        std::cerr << "Drones array not found in JSON." << std::endl;
+        return false;
+    }
+    drones = &it->value;
+    return true;
+}
+
+bool ScenarioDocument::isLoaded() const { return drones != nullptr; }
+
+int ScenarioDocument::droneCount() const {
+    return drones ? static_cast<int>(drones->Size()) : 0;
+}
+
+const rapidjson::Value* ScenarioDocument::droneAt(int index) const {
+    if (!drones || index < 0 || index >= droneCount()) {
+        return nullptr;
+    }
+    return &(*drones)[index];
+}
+
+bool ScenarioDocument::loadDrone(int index, Drone& drone) const {
+    const rapidjson::Value* droneObj = droneAt(index);
+    if (!droneObj) {
+        std::cerr << "Index out of bounds for drones array." << std::endl;
+        return false;
+    }
+    JsonParser parser;
+    return parser.parseDrone(*droneObj, drone);
+}
+
+std::string ScenarioDocument::getString(const char* key, const std::string& fallback) const {
+    if (!document.IsObject()) {
+        return fallback;
+    }
+    rapidjson::Value::ConstMemberIterator it = document.FindMember(key);
+    if (it == document.MemberEnd() || !it->value.IsString()) {
+        return fallback;
+    }
+    return std::string(it->value.GetString(), it->value.GetStringLength());
+}
+
+double ScenarioDocument::getDouble(const char* key, double fallback) const {
+    if (!document.IsObject()) {
+        return fallback;
+    }
+    rapidjson::Value::ConstMemberIterator it = document.FindMember(key);
+    if (it == document.MemberEnd() || !it->value.IsNumber()) {
+        return fallback;
+    }
+    return it->value.GetDouble();
+}
+
+std::vector<ns3::Box> ScenarioDocument::getBoxes(const char* key) const {
+    std::vector<ns3::Box> boxes;
+    if (!document.IsObject()) {
+        return boxes;
+    }
+    rapidjson::Value::ConstMemberIterator it = document.FindMember(key);
+    if (it == document.MemberEnd() || !it->value.IsArray()) {
+        return boxes;
+    }
+    const char* sides[6] = {"xMin", "xMax", "yMin", "yMax", "zMin", "zMax"};
+    for (rapidjson::SizeType i = 0; i < it->value.Size(); i++) {
+        const rapidjson::Value& boxObj = it->value[i];
+        double v[6];
+        bool valid = boxObj.IsObject();
+        for (int k = 0; valid && k < 6; k++) {
+            valid = boxObj.HasMember(sides[k]) && boxObj[sides[k]].IsNumber();
+            if (valid) {
+                v[k] = boxObj[sides[k]].GetDouble();
+            }
+        }
+        if (!valid) {
+            std::cerr << "Skipping malformed entry " << i << " of " << key << std::endl;
+            continue;
+        }
+        boxes.push_back(ns3::Box(v[0], v[1], v[2], v[3], v[4], v[5]));
+    }
+    return boxes;
+}
+
+const rapidjson::Document& ScenarioDocument::getDocument() const { return document; }
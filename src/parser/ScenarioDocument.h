@@ -0,0 +1,56 @@
+#ifndef SCENARIODOCUMENT_H
+#define SCENARIODOCUMENT_H
+
+#include "rapidjson/document.h"
+#include "ns3/box.h"
+#include <string>
+#include <vector>
+
+class Drone;
+
+/*
+ * A scenario JSON parsed once and kept in memory.
+ *
+ * The file is read into a single buffer and parsed in-situ, strings in the
+ * DOM point into that buffer instead of being copied. Drones are then handed
+ * out by index, so building a fleet of N drones costs one parse instead of N.
+ */
+class ScenarioDocument {
+public:
+    ScenarioDocument();
+
+    ScenarioDocument(const ScenarioDocument&) = delete;
+    ScenarioDocument& operator=(const ScenarioDocument&) = delete;
+
+    // Read and parse the file, returns false on I/O or JSON errors
+    bool load(const std::string& filename);
+    bool isLoaded() const;
+
+    // Number of entries in the "Drones" array
+    int droneCount() const;
+
+    // View on one entry of the "Drones" array, nullptr if out of range
+    const rapidjson::Value* droneAt(int index) const;
+
+    // Fill the drone with the entry at index
+    bool loadDrone(int index, Drone& drone) const;
+
+    // Top-level string setting, fallback when missing or not a string
+    std::string getString(const char* key, const std::string& fallback) const;
+    // Top-level number setting, fallback when missing or not a number
+    double getDouble(const char* key, double fallback) const;
+
+    // Top-level array of {xMin, xMax, yMin, yMax, zMin, zMax} objects,
+    // malformed entries are skipped
+    std::vector<ns3::Box> getBoxes(const char* key) const;
+
+    // Root object, for sections other than "Drones"
+    const rapidjson::Document& getDocument() const;
+
+private:
+    std::vector<char> buffer;      // Backing storage of the in-situ DOM
+    rapidjson::Document document;
+    const rapidjson::Value* drones;
+};
+
+#endif // SCENARIODOCUMENT_H
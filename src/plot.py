@@ -2,6 +2,7 @@ import matplotlib.pyplot as plt
 from mpl_toolkits.mplot3d import Axes3D, art3d
 import pandas as pd
 import numpy as np
+import os
 from matplotlib import cm
 from matplotlib.colors import Normalize
 #from matplotlib.colors import TwoSlopeNorm
@@ -39,6 +40,22 @@ def read_csv(filename):
 
     return df_split
 
+def read_telemetry(dirname):
+    # Load the columnar output of TelemetrySink, every column is memory-mapped
+    # straight from its .bin file (no text parsing, no copy)
+    with open(os.path.join(dirname, 'schema.txt')) as schema:
+        rows = int(schema.readline().split()[1])
+        columns = [line.split() for line in schema if line.strip()]
+
+    data = {}
+    for name, dtype in columns:
+        if rows == 0:
+            data[name] = np.empty(0, dtype=dtype)
+        else:
+            data[name] = np.memmap(os.path.join(dirname, name + '.bin'), dtype=dtype, mode='r', shape=(rows,))
+
+    return pd.DataFrame(data, copy=False)
+
 def plot_percentage_over_time(df):
     # Ensure the data is sorted by time for each drone
     df = df.sort_values(by=['drone_id', 'time']).reset_index(drop=True)
@@ -601,9 +618,9 @@ def plot_ampere_breakdown_for_drone_01(df):
 
 
 if __name__ == "__main__":
-    # Read data from the CSV file
+    # Read the telemetry columns written by the simulation
     #df_split = read_csv('results/results.csv')
-    df_split = pd.read_csv('results/results.csv')
+    df_split = read_telemetry('results/telemetry')
     print(df_split.shape)  # Check how many rows and columns are loaded
     print(df_split.head(10))  # Print first 10 rows to verify
 
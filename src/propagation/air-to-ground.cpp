@@ -0,0 +1,42 @@
+#include "air-to-ground.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const double SPEED_OF_LIGHT = 299792458.0;   // m/s
+static const double RAD_TO_DEG = 180.0 / M_PI;
+static const double MIN_DISTANCE = 0.01;            // m
+
+AirToGroundParams urbanAirToGround(double frequency) {
+    return AirToGroundParams{frequency, 9.61, 0.16, 1.0, 20.0};
+}
+
+double freeSpaceLoss(double frequency, double distance) {
+    return 20 * std::log10(4 * M_PI * frequency * std::max(distance, MIN_DISTANCE) / SPEED_OF_LIGHT);
+}
+
+double losProbability(const AirToGroundParams& params, double elevationDeg) {
+    return 1.0 / (1.0 + params.a * std::exp(-params.b * (elevationDeg - params.a)));
+}
+
+double airToGroundLoss(const AirToGroundParams& params, double horizontal, double vertical) {
+    double loss;
+    airToGroundLoss(params, &horizontal, &vertical, &loss, 1);
+    return loss;
+}
+
+void airToGroundLoss(const AirToGroundParams& params, const double* horizontal, const double* vertical,
+                     double* lossDb, size_t n) {
+    // 20 log10(4 pi f d / c) = 20 log10(d) + k
+    const double k = 20 * std::log10(4 * M_PI * params.frequency / SPEED_OF_LIGHT);
+    const double ab = params.a * params.b;
+    const double excess = params.xiLoS - params.xiNLoS;
+    for (size_t i = 0; i < n; i++) {
+        double h = std::fabs(horizontal[i]);
+        double v = std::fabs(vertical[i]);
+        double d = std::max(std::sqrt(h * h + v * v), MIN_DISTANCE);
+        double theta = std::atan2(v, h) * RAD_TO_DEG;
+        double pLoS = 1.0 / (1.0 + params.a * std::exp(ab - params.b * theta));
+        lossDb[i] = 20 * std::log10(d) + k + params.xiNLoS + pLoS * excess;
+    }
+}
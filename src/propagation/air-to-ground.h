@@ -0,0 +1,39 @@
+#ifndef AIR_TO_GROUND_H
+#define AIR_TO_GROUND_H
+
+#include <cstddef>
+
+// Mean path loss of a UAV air-to-ground link (Al-Hourani et al.): free
+// space plus an excess loss weighted by the probability of line of sight,
+// which grows with the elevation angle theta (degrees)
+//
+//   P_LoS = 1 / (1 + a exp(-b (theta - a)))
+//   PL    = 20 log10(4 pi f d / c) + P_LoS xi_LoS + (1 - P_LoS) xi_NLoS
+//
+// Shared by UavAirToGroundLossModel (the Wi-Fi channel) and the analytic
+// upload rate of energy.cpp.
+struct AirToGroundParams {
+    double frequency;   // Carrier (Hz)
+    double a;           // Environment S-curve
+    double b;
+    double xiLoS;       // Excess loss in line of sight (dB)
+    double xiNLoS;      // Excess loss without line of sight (dB)
+};
+
+// Urban environment, 2.4 GHz
+AirToGroundParams urbanAirToGround(double frequency = 2.4e9);
+
+// 20 log10(4 pi f d / c), d clamped to 1 cm
+double freeSpaceLoss(double frequency, double distance);
+
+double losProbability(const AirToGroundParams& params, double elevationDeg);
+
+// Loss (dB) of a link with the given horizontal and vertical separation (m)
+double airToGroundLoss(const AirToGroundParams& params, double horizontal, double vertical);
+
+// Same for n links stored as arrays, a branch-free loop over contiguous
+// inputs the compiler can vectorize
+void airToGroundLoss(const AirToGroundParams& params, const double* horizontal, const double* vertical,
+                     double* lossDb, size_t n);
+
+#endif // AIR_TO_GROUND_H
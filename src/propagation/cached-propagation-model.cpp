@@ -0,0 +1,198 @@
+#include "cached-propagation-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("CachedPropagationModel");
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationDelayModel);
+
+PropagationPathCache::PropagationPathCache()
+    : m_quantum(1.0), m_epoch(Seconds(0)), m_generation(0), m_hits(0), m_misses(0) {}
+
+PropagationPathCache::~PropagationPathCache() {
+    Clear();
+}
+
+void PropagationPathCache::SetQuantum(double quantum) {
+    m_quantum = quantum;
+    Invalidate();
+}
+
+void PropagationPathCache::SetEpoch(Time epoch) {
+    m_epoch = epoch;
+    Invalidate();
+}
+
+void PropagationPathCache::Invalidate(void) {
+    m_generation++;
+}
+
+void PropagationPathCache::Clear(void) {
+    m_paths.Cleanup();
+}
+
+uint64_t PropagationPathCache::GetHits(void) const {
+    return m_hits;
+}
+
+uint64_t PropagationPathCache::GetMisses(void) const {
+    return m_misses;
+}
+
+void PropagationPathCache::Quantize(const Vector &a, const Vector &b, int64_t cells[6]) const {
+    const double coords[6] = {a.x, a.y, a.z, b.x, b.y, b.z};
+    for (int i = 0; i < 6; i++) {
+        // A zero quantum only hits on the exact same positions
+        cells[i] = m_quantum > 0 ? static_cast<int64_t>(std::floor(coords[i] / m_quantum))
+                                 : static_cast<int64_t>(std::llround(coords[i] * 1e9));
+    }
+}
+
+TypeId CachedPropagationLossModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::CachedPropagationLossModel")
+        .SetParent<PropagationLossModel>()
+        .SetGroupName("Propagation")
+        .AddConstructor<CachedPropagationLossModel>()
+        .AddAttribute("Model",
+                      "Wrapped loss model, with its chain.",
+                      PointerValue(),
+                      MakePointerAccessor(&CachedPropagationLossModel::m_model),
+                      MakePointerChecker<PropagationLossModel>())
+        .AddAttribute("Quantum",
+                      "Position cell (m), a link is recomputed when one end changes cell.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&CachedPropagationLossModel::SetQuantum,
+                                         &CachedPropagationLossModel::GetQuantum),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Epoch",
+                      "Lifetime of the cached values, 0 to keep them until Invalidate().",
+                      TimeValue(Seconds(0)),
+                      MakeTimeAccessor(&CachedPropagationLossModel::SetEpoch,
+                                       &CachedPropagationLossModel::GetEpoch),
+                      MakeTimeChecker(Seconds(0)));
+    return tid;
+}
+
+CachedPropagationLossModel::CachedPropagationLossModel() : m_quantum(1.0), m_epoch(Seconds(0)) {}
+
+void CachedPropagationLossModel::Invalidate(void) {
+    m_cache.Invalidate();
+}
+
+const PropagationPathCache &CachedPropagationLossModel::GetCache(void) const {
+    return m_cache;
+}
+
+double CachedPropagationLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a,
+                                                 Ptr<MobilityModel> b) const {
+    NS_ASSERT_MSG(m_model, "CachedPropagationLossModel needs a Model");
+    // Attenuation in dB does not depend on the transmit power
+    double loss = m_cache.Get(a, b, [&]() { return txPowerDbm - m_model->CalcRxPower(txPowerDbm, a, b); });
+    return txPowerDbm - loss;
+}
+
+int64_t CachedPropagationLossModel::DoAssignStreams(int64_t stream) {
+    return m_model ? m_model->AssignStreams(stream) : 0;
+}
+
+void CachedPropagationLossModel::DoDispose(void) {
+    m_cache.Clear();
+    m_model = nullptr;
+    PropagationLossModel::DoDispose();
+}
+
+void CachedPropagationLossModel::SetQuantum(double quantum) {
+    m_quantum = quantum;
+    m_cache.SetQuantum(quantum);
+}
+
+double CachedPropagationLossModel::GetQuantum(void) const {
+    return m_quantum;
+}
+
+void CachedPropagationLossModel::SetEpoch(Time epoch) {
+    m_epoch = epoch;
+    m_cache.SetEpoch(epoch);
+}
+
+Time CachedPropagationLossModel::GetEpoch(void) const {
+    return m_epoch;
+}
+
+TypeId CachedPropagationDelayModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::CachedPropagationDelayModel")
+        .SetParent<PropagationDelayModel>()
+        .SetGroupName("Propagation")
+        .AddConstructor<CachedPropagationDelayModel>()
+        .AddAttribute("Model",
+                      "Wrapped delay model.",
+                      PointerValue(),
+                      MakePointerAccessor(&CachedPropagationDelayModel::m_model),
+                      MakePointerChecker<PropagationDelayModel>())
+        .AddAttribute("Quantum",
+                      "Position cell (m), a link is recomputed when one end changes cell.",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&CachedPropagationDelayModel::SetQuantum,
+                                         &CachedPropagationDelayModel::GetQuantum),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("Epoch",
+                      "Lifetime of the cached values, 0 to keep them until Invalidate().",
+                      TimeValue(Seconds(0)),
+                      MakeTimeAccessor(&CachedPropagationDelayModel::SetEpoch,
+                                       &CachedPropagationDelayModel::GetEpoch),
+                      MakeTimeChecker(Seconds(0)));
+    return tid;
+}
+
+CachedPropagationDelayModel::CachedPropagationDelayModel() : m_quantum(1.0), m_epoch(Seconds(0)) {}
+
+Time CachedPropagationDelayModel::GetDelay(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const {
+    NS_ASSERT_MSG(m_model, "CachedPropagationDelayModel needs a Model");
+    // Stored as time steps, a double holds them exactly up to 2^53
+    double steps = m_cache.Get(a, b, [&]() { return double(m_model->GetDelay(a, b).GetTimeStep()); });
+    return TimeStep(static_cast<uint64_t>(steps));
+}
+
+void CachedPropagationDelayModel::Invalidate(void) {
+    m_cache.Invalidate();
+}
+
+const PropagationPathCache &CachedPropagationDelayModel::GetCache(void) const {
+    return m_cache;
+}
+
+int64_t CachedPropagationDelayModel::DoAssignStreams(int64_t stream) {
+    return m_model ? m_model->AssignStreams(stream) : 0;
+}
+
+void CachedPropagationDelayModel::DoDispose(void) {
+    m_cache.Clear();
+    m_model = nullptr;
+    PropagationDelayModel::DoDispose();
+}
+
+void CachedPropagationDelayModel::SetQuantum(double quantum) {
+    m_quantum = quantum;
+    m_cache.SetQuantum(quantum);
+}
+
+double CachedPropagationDelayModel::GetQuantum(void) const {
+    return m_quantum;
+}
+
+void CachedPropagationDelayModel::SetEpoch(Time epoch) {
+    m_epoch = epoch;
+    m_cache.SetEpoch(epoch);
+}
+
+Time CachedPropagationDelayModel::GetEpoch(void) const {
+    return m_epoch;
+}
+
+} // namespace ns3
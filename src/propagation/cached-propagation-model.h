@@ -0,0 +1,156 @@
+#ifndef CACHED_PROPAGATION_MODEL_H
+#define CACHED_PROPAGATION_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/propagation-cache.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * Per-link memo of a propagation value, keyed on the (tx, rx) mobility
+ * models through PropagationCache.
+ *
+ * An entry holds the value computed for each direction of the link with the
+ * positions of both ends quantized to Quantum metres; it is reused while both
+ * ends stay in the same cells and the epoch has not changed. The epoch moves
+ * on Invalidate() (buildings added, models reconfigured) and, when Epoch is
+ * not zero, at every multiple of Epoch.
+ */
+class PropagationPathCache {
+public:
+  PropagationPathCache();
+  ~PropagationPathCache();
+
+  void SetQuantum(double quantum);
+  void SetEpoch(Time epoch);
+  // Drop every cached value
+  void Invalidate(void);
+  // Release the entries and the mobility models they hold
+  void Clear(void);
+
+  uint64_t GetHits(void) const;
+  uint64_t GetMisses(void) const;
+
+  // Cached value of a -> b, compute() on a miss
+  template <class F>
+  double Get(Ptr<MobilityModel> a, Ptr<MobilityModel> b, F compute) const;
+
+private:
+  struct Slot {
+    int64_t cells[6];     //!< Quantized a then b
+    uint64_t generation;
+    int64_t period;
+    double value;
+    bool valid;
+  };
+
+  class Path : public Object {
+  public:
+    Slot slot[2];         //!< Indexed by the order of the two models
+  };
+
+  void Quantize(const Vector &a, const Vector &b, int64_t cells[6]) const;
+
+  double m_quantum;
+  Time m_epoch;
+  uint64_t m_generation;
+  mutable PropagationCache<Path> m_paths;
+  mutable uint64_t m_hits;
+  mutable uint64_t m_misses;
+};
+
+/**
+ * PropagationLossModel caching the attenuation of the wrapped Model (and
+ * its chain) per link. Only for deterministic models: a fading model would
+ * keep drawing the same sample while the ends stay in their cells.
+ */
+class CachedPropagationLossModel : public PropagationLossModel {
+public:
+  static TypeId GetTypeId(void);
+  CachedPropagationLossModel();
+
+  void Invalidate(void);
+  const PropagationPathCache &GetCache(void) const;
+
+private:
+  double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+  int64_t DoAssignStreams(int64_t stream) override;
+  void DoDispose(void) override;
+
+  void SetQuantum(double quantum);
+  double GetQuantum(void) const;
+  void SetEpoch(Time epoch);
+  Time GetEpoch(void) const;
+
+  Ptr<PropagationLossModel> m_model;
+  double m_quantum;
+  Time m_epoch;
+  PropagationPathCache m_cache;
+};
+
+// PropagationDelayModel caching the delay of the wrapped Model per link
+class CachedPropagationDelayModel : public PropagationDelayModel {
+public:
+  static TypeId GetTypeId(void);
+  CachedPropagationDelayModel();
+
+  Time GetDelay(Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+
+  void Invalidate(void);
+  const PropagationPathCache &GetCache(void) const;
+
+private:
+  int64_t DoAssignStreams(int64_t stream) override;
+  void DoDispose(void) override;
+
+  void SetQuantum(double quantum);
+  double GetQuantum(void) const;
+  void SetEpoch(Time epoch);
+  Time GetEpoch(void) const;
+
+  Ptr<PropagationDelayModel> m_model;
+  double m_quantum;
+  Time m_epoch;
+  PropagationPathCache m_cache;
+};
+
+template <class F>
+double PropagationPathCache::Get(Ptr<MobilityModel> a, Ptr<MobilityModel> b, F compute) const {
+  int64_t cells[6];
+  Quantize(a->GetPosition(), b->GetPosition(), cells);
+  int64_t period = m_epoch.IsStrictlyPositive() ? Simulator::Now().GetTimeStep() / m_epoch.GetTimeStep() : 0;
+
+  Ptr<Path> path = m_paths.GetPathData(a, b, 0);
+  if (!path) {
+    path = CreateObject<Path>();
+    path->slot[0].valid = false;
+    path->slot[1].valid = false;
+    m_paths.AddPathData(path, a, b, 0);
+  }
+  // The cache key is symmetric, the values are not
+  Slot &slot = path->slot[PeekPointer(a) < PeekPointer(b) ? 0 : 1];
+  if (slot.valid && slot.generation == m_generation && slot.period == period &&
+      std::equal(cells, cells + 6, slot.cells)) {
+    m_hits++;
+    return slot.value;
+  }
+  m_misses++;
+  slot.value = compute();
+  std::copy(cells, cells + 6, slot.cells);
+  slot.generation = m_generation;
+  slot.period = period;
+  slot.valid = true;
+  return slot.value;
+}
+
+} // namespace ns3
+
+#endif // CACHED_PROPAGATION_MODEL_H
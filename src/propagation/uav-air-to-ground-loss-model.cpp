@@ -0,0 +1,79 @@
+#include "uav-air-to-ground-loss-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("UavAirToGroundLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED(UavAirToGroundLossModel);
+
+TypeId UavAirToGroundLossModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::UavAirToGroundLossModel")
+        .SetParent<PropagationLossModel>()
+        .SetGroupName("Propagation")
+        .AddConstructor<UavAirToGroundLossModel>()
+        .AddAttribute("Frequency",
+                      "Carrier frequency (Hz).",
+                      DoubleValue(2.4e9),
+                      MakeDoubleAccessor(&UavAirToGroundLossModel::m_frequency),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("EnvironmentA",
+                      "a of the line of sight S-curve (9.61 urban, 4.88 suburban).",
+                      DoubleValue(9.61),
+                      MakeDoubleAccessor(&UavAirToGroundLossModel::m_a),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("EnvironmentB",
+                      "b of the line of sight S-curve (0.16 urban, 0.43 suburban).",
+                      DoubleValue(0.16),
+                      MakeDoubleAccessor(&UavAirToGroundLossModel::m_b),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("LosExcessLoss",
+                      "xi_LoS, loss over free space in line of sight (dB).",
+                      DoubleValue(1.0),
+                      MakeDoubleAccessor(&UavAirToGroundLossModel::m_xiLoS),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("NlosExcessLoss",
+                      "xi_NLoS, loss over free space without line of sight (dB).",
+                      DoubleValue(20.0),
+                      MakeDoubleAccessor(&UavAirToGroundLossModel::m_xiNLoS),
+                      MakeDoubleChecker<double>());
+    return tid;
+}
+
+UavAirToGroundLossModel::UavAirToGroundLossModel() {
+    AirToGroundParams urban = urbanAirToGround();
+    m_frequency = urban.frequency;
+    m_a = urban.a;
+    m_b = urban.b;
+    m_xiLoS = urban.xiLoS;
+    m_xiNLoS = urban.xiNLoS;
+}
+
+AirToGroundParams UavAirToGroundLossModel::GetParams(void) const {
+    return AirToGroundParams{m_frequency, m_a, m_b, m_xiLoS, m_xiNLoS};
+}
+
+void UavAirToGroundLossModel::CalcLossBatch(const double *horizontal, const double *vertical, double *lossDb,
+                                            size_t n) const {
+    airToGroundLoss(GetParams(), horizontal, vertical, lossDb, n);
+}
+
+double UavAirToGroundLossModel::DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a,
+                                              Ptr<MobilityModel> b) const {
+    Vector pa = a->GetPosition();
+    Vector pb = b->GetPosition();
+    double horizontal = std::hypot(pa.x - pb.x, pa.y - pb.y);
+    double loss = airToGroundLoss(GetParams(), horizontal, pa.z - pb.z);
+    NS_LOG_DEBUG("horizontal " << horizontal << " m, vertical " << pa.z - pb.z << " m, loss " << loss << " dB");
+    return txPowerDbm - loss;
+}
+
+int64_t UavAirToGroundLossModel::DoAssignStreams(int64_t stream) {
+    return 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,42 @@
+#ifndef UAV_AIR_TO_GROUND_LOSS_MODEL_H
+#define UAV_AIR_TO_GROUND_LOSS_MODEL_H
+
+#include "ns3/propagation-loss-model.h"
+#include "air-to-ground.h"
+
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * Mean air-to-ground path loss (see air-to-ground.h) between two nodes.
+ *
+ * The elevation angle, hence the line of sight probability, comes from the
+ * heights of the two mobility models (the CustomMobilityModel altitude for
+ * a drone); the model is symmetric and deterministic, so it can be cached
+ * per link.
+ */
+class UavAirToGroundLossModel : public PropagationLossModel {
+public:
+  static TypeId GetTypeId(void);
+  UavAirToGroundLossModel();
+
+  AirToGroundParams GetParams(void) const;
+
+  // Loss (dB) of n links given their horizontal and vertical separations
+  void CalcLossBatch(const double *horizontal, const double *vertical, double *lossDb, size_t n) const;
+
+private:
+  double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override;
+  int64_t DoAssignStreams(int64_t stream) override;
+
+  double m_frequency;
+  double m_a;
+  double m_b;
+  double m_xiLoS;
+  double m_xiNLoS;
+};
+
+} // namespace ns3
+
+#endif // UAV_AIR_TO_GROUND_LOSS_MODEL_H
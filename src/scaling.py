@@ -0,0 +1,133 @@
+import argparse
+import copy
+import csv
+import json
+import os
+import re
+import statistics
+import subprocess
+
+# Strong and weak scaling of the MPI partitioned simulation.
+#
+# Strong: the same scenario on 1..N ranks.
+# Weak: the scenario replicated once per rank, every copy shifted to its
+# own tile so that the partitioner gives one copy to each rank.
+#
+# Every rank prints "Rank r/R: ... E events in W s", the run time of a
+# configuration is the slowest rank, the median of --repeat runs. Besides
+# scaling.csv the table is written as markdown to scaling.md. Runs with more
+# ranks than cores are marked oversubscribed: their speedup measures the
+# time sharing of the cores, not the partitioning.
+
+RANK_LINE = re.compile(r'Rank (\d+)/(\d+): (\d+) of (\d+) drones.*; (\d+) events in ([0-9.eE+-]+) s')
+
+
+def shift_box(box, dx, dy):
+    box = dict(box)
+    box['xMin'] += dx
+    box['xMax'] += dx
+    box['yMin'] += dy
+    box['yMax'] += dy
+    return box
+
+
+def replicate_scenario(base, copies):
+    # Tiles side by side along x, as wide as the bounds of the base fleet
+    width = max(d['bounds']['xMax'] for d in base['Drones']) - min(d['bounds']['xMin'] for d in base['Drones'])
+    scenario = copy.deepcopy(base)
+    scenario['Drones'] = []
+    for k in range(copies):
+        for drone in base['Drones']:
+            d = copy.deepcopy(drone)
+            dx = k * width
+            d['bounds'] = shift_box(d['bounds'], dx, 0)
+            d['aoi'] = shift_box(d['aoi'], dx, 0)
+            d['initialCoordinates']['x'] += dx
+            scenario['Drones'].append(d)
+    return scenario
+
+
+def run(args, ranks, config):
+    cmd = [args.mpiexec, '-n', str(ranks), args.binary, config]
+    out = subprocess.run(cmd, capture_output=True, text=True, cwd=args.workdir)
+    if out.returncode != 0:
+        print(out.stderr)
+        raise RuntimeError('%s failed with code %d' % (' '.join(cmd), out.returncode))
+    wall = 0.0
+    events = 0
+    drones = 0
+    for match in RANK_LINE.finditer(out.stdout):
+        events += int(match.group(5))
+        wall = max(wall, float(match.group(6)))
+        drones = int(match.group(4))
+    return wall, events, drones
+
+
+def write_markdown(path, rows, args):
+    with open(path, 'w') as f:
+        f.write('%s, %d cores, median of %d runs\n\n' % (os.path.basename(args.config), args.cores, args.repeat))
+        f.write('| mode | ranks | drones | events | wall (s) | speedup | efficiency |\n')
+        f.write('|---|---:|---:|---:|---:|---:|---:|\n')
+        for row in rows:
+            f.write('| %s | %d%s | %d | %d | %.3f | %.2f | %.1f%% |\n'
+                    % (row['mode'], row['ranks'], '*' if row['oversubscribed'] else '', row['drones'],
+                       row['events'], row['wall_s'], row['speedup'], row['efficiency'] * 100))
+        if any(row['oversubscribed'] for row in rows):
+            f.write('\n\\* more ranks than cores\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Strong and weak scaling over MPI ranks')
+    parser.add_argument('--binary', default=os.path.abspath('build/out'))
+    parser.add_argument('--config', default=os.path.abspath('scenario/scenario.json'))
+    parser.add_argument('--ranks', default='1,2,4,8,16')
+    parser.add_argument('--mode', choices=['strong', 'weak', 'both'], default='both')
+    parser.add_argument('--mpiexec', default='mpiexec')
+    parser.add_argument('--workdir', default='build')
+    parser.add_argument('--output', default='results/scaling')
+    parser.add_argument('--repeat', type=int, default=3, help='runs per configuration, the median is kept')
+    parser.add_argument('--cores', type=int, default=os.cpu_count(), help='cores available to the ranks')
+    args = parser.parse_args()
+
+    ranks = [int(r) for r in args.ranks.split(',')]
+    os.makedirs(args.output, exist_ok=True)
+    with open(args.config) as f:
+        base = json.load(f)
+
+    rows = []
+    modes = ['strong', 'weak'] if args.mode == 'both' else [args.mode]
+    for mode in modes:
+        reference = None
+        for r in ranks:
+            config = args.config
+            if mode == 'weak':
+                config = os.path.abspath(os.path.join(args.output, 'weak-%d.json' % r))
+                with open(config, 'w') as f:
+                    json.dump(replicate_scenario(base, r), f, indent=2)
+            runs = [run(args, r, config) for _ in range(args.repeat)]
+            wall = statistics.median(w for w, _, _ in runs)
+            _, events, drones = runs[0]
+            if reference is None:
+                reference = wall * ranks[0] if mode == 'strong' else wall
+            if mode == 'strong':
+                speedup = reference / wall if wall > 0 else 0
+                efficiency = speedup / r
+            else:
+                speedup = reference * r / wall if wall > 0 else 0
+                efficiency = reference / wall if wall > 0 else 0
+            rows.append({'mode': mode, 'ranks': r, 'drones': drones, 'events': events,
+                         'wall_s': wall, 'speedup': speedup, 'efficiency': efficiency,
+                         'oversubscribed': r > args.cores})
+            print('%-6s %3d ranks %6d drones %10d events %9.3f s  speedup %6.2f  efficiency %5.1f%%%s'
+                  % (mode, r, drones, events, wall, speedup, efficiency * 100,
+                     '  (oversubscribed)' if r > args.cores else ''))
+
+    with open(os.path.join(args.output, 'scaling.csv'), 'w', newline='') as f:
+        writer = csv.DictWriter(f, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+    write_markdown(os.path.join(args.output, 'scaling.md'), rows, args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,66 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> counting(false);
+thread_local uint64_t allocations = 0;
+thread_local uint64_t bytes = 0;
+
+} // namespace
+
+#ifdef COUNT_ALLOCATIONS
+// Replaces the global one for the whole program, ns-3 libraries included
+void* operator new(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations++;
+        bytes += size;
+    }
+    for (;;) {
+        void* p = std::malloc(size > 0 ? size : 1);
+        if (p) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+#endif
+
+bool AllocationCounter::isAvailable() {
+#ifdef COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationCounter::enable() {
+    counting.store(true, std::memory_order_relaxed);
+}
+
+bool AllocationCounter::isEnabled() {
+    return isAvailable() && counting.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::allocations() {
+    return ::allocations;
+}
+
+uint64_t AllocationCounter::bytes() {
+    return ::bytes;
+}
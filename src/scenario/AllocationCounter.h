@@ -0,0 +1,31 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+/*
+ * Heap allocations of the calling thread, for the event profiler.
+ *
+ * AllocationCounter.cpp replaces the global operator new (new[] and the
+ * nothrow forms go through it) when built with COUNT_ALLOCATIONS, the CMake
+ * option of the same name (off by default). Without it the default allocator
+ * is left alone and isAvailable() is false. The counts only move after
+ * enable(); until then an allocation costs one more test of a flag.
+ *
+ * The counters are per thread: the NetAnim writer thread, for one, never
+ * shows in the counts of the simulation thread.
+ */
+class AllocationCounter {
+public:
+    static bool isAvailable();
+
+    // Count from now on, the profiler calls it when enabled
+    static void enable();
+    static bool isEnabled();
+
+    // Allocations and bytes asked for by the calling thread since enable()
+    static uint64_t allocations();
+    static uint64_t bytes();
+};
+
+#endif // ALLOCATIONCOUNTER_H
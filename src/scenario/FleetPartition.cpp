@@ -0,0 +1,67 @@
+#include "FleetPartition.h"
+#include <algorithm>
+#include <cfloat>
+
+// Spread the low 16 bits of v to the even bits
+static uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+FleetPartition partitionFleet(const std::vector<ns3::Box>& aois, uint32_t ranks) {
+    FleetPartition partition;
+    if (ranks == 0) {
+        ranks = 1;
+    }
+    size_t count = aois.size();
+    partition.rankOf.assign(count, 0);
+    partition.dronesOf.assign(ranks, 0);
+    partition.centreOf.assign(ranks, ns3::Vector(0.0, 0.0, 0.0));
+    if (count == 0) {
+        return partition;
+    }
+
+    // Normalise the AoI centres to the box holding all of them
+    std::vector<double> cx(count);
+    std::vector<double> cy(count);
+    double xMin = DBL_MAX, xMax = -DBL_MAX, yMin = DBL_MAX, yMax = -DBL_MAX;
+    for (size_t i = 0; i < count; i++) {
+        cx[i] = (aois[i].xMin + aois[i].xMax) / 2;
+        cy[i] = (aois[i].yMin + aois[i].yMax) / 2;
+        xMin = std::min(xMin, cx[i]);
+        xMax = std::max(xMax, cx[i]);
+        yMin = std::min(yMin, cy[i]);
+        yMax = std::max(yMax, cy[i]);
+    }
+    double width = std::max(xMax - xMin, 1e-9);
+    double height = std::max(yMax - yMin, 1e-9);
+
+    std::vector<std::pair<uint32_t, uint32_t>> order(count);  // (Morton code, drone)
+    for (size_t i = 0; i < count; i++) {
+        uint32_t qx = static_cast<uint32_t>((cx[i] - xMin) / width * 65535.0);
+        uint32_t qy = static_cast<uint32_t>((cy[i] - yMin) / height * 65535.0);
+        order[i] = std::make_pair(spreadBits(qx) | (spreadBits(qy) << 1), static_cast<uint32_t>(i));
+    }
+    // Stable on the drone index, so equal AoIs keep the scenario order
+    std::sort(order.begin(), order.end());
+
+    for (size_t k = 0; k < count; k++) {
+        uint32_t drone = order[k].second;
+        uint32_t rank = static_cast<uint32_t>((k * ranks) / count);
+        partition.rankOf[drone] = rank;
+        partition.dronesOf[rank]++;
+        partition.centreOf[rank].x += cx[drone];
+        partition.centreOf[rank].y += cy[drone];
+    }
+    for (uint32_t rank = 0; rank < ranks; rank++) {
+        if (partition.dronesOf[rank] > 0) {
+            partition.centreOf[rank].x /= partition.dronesOf[rank];
+            partition.centreOf[rank].y /= partition.dronesOf[rank];
+        }
+    }
+    return partition;
+}
@@ -0,0 +1,25 @@
+#ifndef FLEETPARTITION_H
+#define FLEETPARTITION_H
+
+#include <cstdint>
+#include <vector>
+#include "ns3/box.h"
+#include "ns3/vector.h"
+
+/*
+ * Assignment of the drones to MPI ranks.
+ *
+ * Drones are ordered along a Z-order (Morton) curve through the centres of
+ * their AoIs and the curve is cut in equal chunks, one per rank: drones
+ * flying over the same region end up on the same rank, and rank loads
+ * differ by at most one drone.
+ */
+struct FleetPartition {
+    std::vector<uint32_t> rankOf;        // Rank of every drone
+    std::vector<uint32_t> dronesOf;      // Number of drones of every rank
+    std::vector<ns3::Vector> centreOf;   // Mean AoI centre of every rank (z = 0)
+};
+
+FleetPartition partitionFleet(const std::vector<ns3::Box>& aois, uint32_t ranks);
+
+#endif // FLEETPARTITION_H
@@ -0,0 +1,498 @@
+#include "ScenarioBuilder.h"
+#include "../mobility/custom-mobility-model.h"
+#include "../propagation/uav-air-to-ground-loss-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/ssid.h"
+#include "ns3/wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/generic-battery-model-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/buildings-helper.h"
+#include "ns3/object-factory.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/simulator.h"
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+using namespace ns3;
+
+// TypeId of the CoveragePlanner behind a planner name, empty for the
+// built-in snake pattern
+static std::string plannerTypeName(const std::string& planner) {
+    if (planner == "boustrophedon") {
+        return "ns3::BoustrophedonPlanner";
+    }
+    if (planner == "spiral") {
+        return "ns3::SpiralPlanner";
+    }
+    if (planner == "sector") {
+        return "ns3::SectorPartitionPlanner";
+    }
+    if (planner != "snake") {
+        std::cerr << "Unknown planner " << planner << ", using snake" << std::endl;
+    }
+    return "";
+}
+
+ScenarioBuilder::ScenarioBuilder(const std::string& configPath)
+    : droneCount(0), systemId(0), systemCount(1), backhaulRate("100Mbps"), backhaulDelay(MilliSeconds(5)),
+      buildingsLoss(false), airToGround(urbanAirToGround()), relayed(0), cloudReceived(0) {
+    auto start = Clock::now();
+    if (!scenario.load(configPath)) {
+        std::cerr << "Error reading the scenario " << configPath << std::endl;
+    }
+    droneCount = scenario.droneCount();
+    recordPhase("parse", start);
+}
+
+void ScenarioBuilder::setBackhaul(const std::string& dataRate, Time delay) {
+    backhaulRate = dataRate;
+    backhaulDelay = delay;
+}
+
+void ScenarioBuilder::createNodes(uint32_t systemId, uint32_t systemCount) {
+    auto start = Clock::now();
+    this->systemId = systemId;
+    this->systemCount = systemCount > 0 ? systemCount : 1;
+
+    // Ranks by region of the AoIs
+    std::vector<Box> aois(droneCount);
+    for (uint32_t i = 0; i < droneCount; i++) {
+        Drone drone;
+        scenario.loadDrone(i, drone);
+        aois[i] = drone.getAoI();
+    }
+    partition = partitionFleet(aois, this->systemCount);
+
+    // Same nodes, in the same order, on every rank
+    for (uint32_t i = 0; i < droneCount; i++) {
+        Ptr<Node> node = CreateObject<Node>(partition.rankOf[i]);  //Clients (CUSTOM mobility)
+        allStas.Add(node);
+        if (partition.rankOf[i] == systemId) {
+            stas.Add(node);
+            localDrones.push_back(i);
+        }
+    }
+    for (uint32_t rank = 0; rank < this->systemCount; rank++) {
+        aps.Add(CreateObject<Node>(rank));  //Servers
+    }
+    ap.Add(aps.Get(systemId));
+    cloud.Add(CreateObject<Node>(0));
+
+    // Backhaul before any other device: a device of a remote channel is
+    // addressed by its index, which must be the same on both ranks
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue(backhaulRate));
+    p2p.SetChannelAttribute("Delay", TimeValue(backhaulDelay));
+    std::vector<NetDeviceContainer> links;
+    for (uint32_t rank = 0; rank < this->systemCount; rank++) {
+        links.push_back(p2p.Install(aps.Get(rank), cloud.Get(0)));
+    }
+    InternetStackHelper internet;
+    internet.Install(aps);
+    internet.Install(cloud);
+    Ipv4AddressHelper ipv4;
+    for (uint32_t rank = 0; rank < this->systemCount; rank++) {
+        std::string subnet = "172.16." + std::to_string(rank) + ".0";
+        ipv4.SetBase(subnet.c_str(), "255.255.255.252");
+        backhaul.push_back(ipv4.Assign(links[rank]));
+    }
+    recordPhase("nodes", start);
+}
+
+void ScenarioBuilder::configureNetSimulyzer(Ptr<netsimulyzer::Orchestrator> orchestrator,
+                                            const Visualization& visualization) {
+    auto start = Clock::now();
+    netsimulyzer::NodeConfigurationHelper nodeConfigHelper(orchestrator);
+    visualization.configure(nodeConfigHelper);
+    nodeConfigHelper.Set("Model", StringValue(netsimulyzer::models::SERVER));
+    nodeConfigHelper.Set("Scale", DoubleValue(3));
+    nodeConfigHelper.Set("Name", StringValue("Server"));
+    nodeConfigHelper.Install(ap);
+    if (systemId == 0) {
+        nodeConfigHelper.Set("Name", StringValue("Cloud"));
+        nodeConfigHelper.Install(cloud);
+    }
+
+    nodeConfigHelper.Set("Model", StringValue(netsimulyzer::models::QUADCOPTER_UAV));
+    nodeConfigHelper.Set("Scale", DoubleValue(10));
+    // Set the names inside netsimulyzer
+    for (uint32_t i = 0; i < stas.GetN() && visualization.shows(i); i++) {
+        nodeConfigHelper.Set("Name", StringValue("Drone" + std::to_string(localDrones[i])));
+        nodeConfigHelper.Install(stas.Get(i));
+    }
+    recordPhase("netsimulyzer", start);
+}
+
+void ScenarioBuilder::installWifi(const std::string& phyMode, double rss) {
+    auto start = Clock::now();
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211b);
+
+    wifiPhy.Set("RxGain", DoubleValue(0));
+    wifiPhy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+
+    // Every frame evaluates the loss and the delay towards every PHY of the
+    // channel, both are cached per link while its ends stay in their cells
+    // The air-to-ground loss is the one of the analytic upload rate
+    std::string lossType = scenario.getString("PropagationLoss", "ns3::UavAirToGroundLossModel");
+    ObjectFactory lossFactory(lossType);
+    if (lossType == "ns3::FixedRssLossModel") {
+        lossFactory.Set("Rss", DoubleValue(rss));
+    }
+    const rapidjson::Value* first = scenario.droneAt(0);
+    if (lossType == "ns3::UavAirToGroundLossModel" && first && first->HasMember("carrierFrequency") &&
+        (*first)["carrierFrequency"].IsNumber()) {
+        lossFactory.Set("Frequency", DoubleValue((*first)["carrierFrequency"].GetDouble()));
+    }
+    Ptr<PropagationLossModel> loss = lossFactory.Create<PropagationLossModel>();
+    buildingsLoss = loss->GetInstanceTypeId().IsChildOf(TypeId::LookupByName("ns3::BuildingsPropagationLossModel"));
+    if (Ptr<UavAirToGroundLossModel> a2g = DynamicCast<UavAirToGroundLossModel>(loss)) {
+        airToGround = a2g->GetParams();
+    }
+    double quantum = scenario.getDouble("PropagationQuantum", 1.0);
+
+    lossCache = CreateObject<CachedPropagationLossModel>();
+    lossCache->SetAttribute("Model", PointerValue(loss));
+    lossCache->SetAttribute("Quantum", DoubleValue(quantum));
+    delayCache = CreateObject<CachedPropagationDelayModel>();
+    delayCache->SetAttribute("Model", PointerValue(CreateObject<ConstantSpeedPropagationDelayModel>()));
+    delayCache->SetAttribute("Quantum", DoubleValue(quantum));
+
+    // Broadcasts only reach the PHYs in range instead of the whole fleet
+    bool culling = scenario.getDouble("RangeCulling", 1) != 0;
+    double range = scenario.getDouble("RadioRange", buildingsLoss ? 0 : -1);
+    channel = CreateObject<RangeCulledWifiChannel>();
+    channel->SetAttribute("PowerCulling", BooleanValue(culling));
+    channel->SetAttribute("MaxRange", DoubleValue(culling ? range : 0));
+    channel->SetPropagationLossModel(lossCache);
+    channel->SetPropagationDelayModel(delayCache);
+    channel->SetRangeModel(loss);
+    wifiPhy.SetChannel(channel);
+
+    // Add a mac and disable rate control
+    WifiMacHelper wifiMac;
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue(phyMode),
+                                 "ControlMode",
+                                 StringValue(phyMode));
+    Ssid ssid = Ssid("wifi-default");
+
+    // setup AP
+    wifiMac.SetType("ns3::ApWifiMac", "Ssid", SsidValue(ssid));
+    NetDeviceContainer apDevice = wifi.Install(wifiPhy, wifiMac, ap.Get(0));
+    devices = apDevice;
+
+    // Setup STA, the whole fleet in one call
+    wifiMac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid));
+    staDevices = wifi.Install(wifiPhy, wifiMac, stas);
+    devices.Add(staDevices);
+    recordPhase("wifi", start);
+}
+
+void ScenarioBuilder::installEnergy() {
+    auto start = Clock::now();
+    // Same 3S Li-ion curve for both battery models
+    GenericBatteryModelHelper periodicHelper;
+    PredictiveBatteryModelHelper predictiveHelper;
+    std::string batteryModel = scenario.getString("Battery", "periodic");
+    if (batteryModel != "periodic" && batteryModel != "predictive") {
+        std::cerr << "Unknown battery " << batteryModel << ", using periodic" << std::endl;
+        batteryModel = "periodic";
+    }
+    EnergySourceHelper& batteryHelper = batteryModel == "predictive" ? static_cast<EnergySourceHelper&>(predictiveHelper)
+                                                                       : periodicHelper;
+    batteryHelper.Set("FullVoltage", DoubleValue(12.6)); // Vfull (4.2V per cell, 3S)
+    batteryHelper.Set("MaxCapacity", DoubleValue(3.6));  // Q in Ah (3600mAh)
+
+    batteryHelper.Set("NominalVoltage", DoubleValue(11.1));  // Vnom (3.7V per cell, 3S)
+    batteryHelper.Set("NominalCapacity", DoubleValue(3.6));  // QNom in Ah
+
+    batteryHelper.Set("ExponentialVoltage", DoubleValue(11.4)); // Vexp
+    batteryHelper.Set("ExponentialCapacity", DoubleValue(1.8)); // Qexp (around 50% of the capacity)
+
+    batteryHelper.Set("InternalResistance", DoubleValue(0.01));   // R in ohms
+    batteryHelper.Set("TypicalDischargeCurrent", DoubleValue(20)); // i typical in A (20A)
+    batteryHelper.Set("CutoffVoltage", DoubleValue(9.9));           // End of charge (3.3V per cell, 3S)
+
+    // Capacity Ah(qMax) * (Vnom) voltage * 3600 = 3.6 * 11.1 * 3600 J
+    double maxCapacityJ = 3.6 * 11.1 * 3600;
+
+    EnergySourceContainer sources = batteryHelper.Install(stas);
+
+    // The radio is charged from the airtime of every PHY state, no event
+    // per drone and tick. Currents at the nominal voltage, the ns-3
+    // defaults are for 3 V
+    double idlePower = scenario.getDouble("RadioIdlePower", 0.82);   // W, 273 mA at 3 V
+    double rxPower = scenario.getDouble("RadioRxPower", 0.94);       // W, 313 mA at 3 V
+    ObjectFactory radioFactory("ns3::WifiAirtimeEnergyModel");
+    radioFactory.Set("IdleCurrentA", DoubleValue(idlePower / 11.1));
+    radioFactory.Set("CcaBusyCurrentA", DoubleValue(idlePower / 11.1));
+    radioFactory.Set("SwitchingCurrentA", DoubleValue(idlePower / 11.1));
+    radioFactory.Set("RxCurrentA", DoubleValue(rxPower / 11.1));
+
+    batteries.reserve(stas.GetN());
+    deviceEnergyModels.reserve(stas.GetN());
+    fleet.reserve(stas.GetN());
+    for (uint32_t i = 0; i < stas.GetN(); i++) {
+        Ptr<EnergySource> battery = sources.Get(i);
+        Ptr<SimpleDeviceEnergyModel> deviceEnergyModel = CreateObject<SimpleDeviceEnergyModel>();
+        deviceEnergyModel->SetEnergySource(battery);
+        battery->AppendDeviceEnergyModel(deviceEnergyModel);
+        deviceEnergyModel->SetNode(stas.Get(i));
+
+        batteries.push_back(battery);
+        deviceEnergyModels.push_back(deviceEnergyModel);
+        DroneFleet::Handle handle = fleet.add(Drone(stas.Get(i), deviceEnergyModel, maxCapacityJ, scenario, localDrones[i]));
+
+        // TX current of this drone's transmission power, on top of the idle one
+        radioFactory.Set("TxCurrentA", DoubleValue((idlePower + fleet.get(handle).getWirelessTransmissionPower()) / 11.1));
+        Ptr<WifiAirtimeEnergyModel> radio = radioFactory.Create<WifiAirtimeEnergyModel>();
+        radio->SetEnergySource(battery);
+        battery->AppendDeviceEnergyModel(radio);
+        radio->SetPhy(DynamicCast<WifiNetDevice>(staDevices.Get(i))->GetPhy());
+        fleet.setRadio(handle, radio);
+    }
+    fleet.setAirToGround(airToGround);
+    recordPhase("energy", start);
+}
+
+void ScenarioBuilder::indexRegions() {
+    auto start = Clock::now();
+    regions = CreateObject<SpatialIndex>();
+    for (uint32_t i = 0; i < fleet.size(); i++) {
+        regions->Add(fleet.get(i).getAoI(), SpatialIndex::AOI, i);
+    }
+    for (const Box& box : scenario.getBoxes("NoFly")) {
+        regions->Add(box, SpatialIndex::NO_FLY);
+    }
+    regions->AddBuildings();
+    recordPhase("regions", start);
+}
+
+void ScenarioBuilder::installMobility(const Vector& apPosition, double turnStrength, const std::string& planner,
+                                      Time horizon) {
+    auto start = Clock::now();
+    // One allocator for the fleet, every Install() takes the next position
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < fleet.size(); i++) {
+        const Drone& drone = fleet.get(i);
+        positionAlloc->Add(Vector(drone.getInitialX(), drone.getInitialY(), 0.0));
+    }
+
+    // Fleet partitioner: drones with the same AoI get one sector each
+    std::string plannerType = plannerTypeName(planner);
+    std::vector<uint32_t> sectorIndex(fleet.size(), 0);
+    std::vector<uint32_t> sectorCount(fleet.size(), 1);
+    if (plannerType == "ns3::SectorPartitionPlanner") {
+        std::map<std::array<double, 6>, std::vector<uint32_t>> sharing;
+        for (uint32_t i = 0; i < fleet.size(); i++) {
+            Box aoi = fleet.get(i).getAoI();
+            sharing[{aoi.xMin, aoi.xMax, aoi.yMin, aoi.yMax, aoi.zMin, aoi.zMax}].push_back(i);
+        }
+        for (const auto& group : sharing) {
+            for (uint32_t k = 0; k < group.second.size(); k++) {
+                sectorIndex[group.second[k]] = k;
+                sectorCount[group.second[k]] = group.second.size();
+            }
+        }
+    }
+
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(positionAlloc);
+    for (uint32_t i = 0; i < fleet.size(); i++) {
+        const Drone& drone = fleet.get(i);
+        Ptr<CoveragePlanner> coverage;
+        if (!plannerType.empty()) {
+            ObjectFactory factory(plannerType);
+            if (plannerType == "ns3::SectorPartitionPlanner") {
+                factory.Set("SectorIndex", UintegerValue(sectorIndex[i]));
+                factory.Set("SectorCount", UintegerValue(sectorCount[i]));
+            }
+            coverage = factory.Create<CoveragePlanner>();
+        }
+        mobility.SetMobilityModel("ns3::CustomMobilityModel",
+                                  "maxHeight",
+                                  DoubleValue(drone.getMaxHeight()),
+                                  "AoI",
+                                  BoxValue(drone.getAoI()),
+                                  "Bounds",
+                                  BoxValue(drone.getBounds()),
+                                  "AvgVelocity",
+                                  DoubleValue(drone.getSpeed()),
+                                  "TurnStrenght",
+                                  DoubleValue(turnStrength),
+                                  "Planner",
+                                  PointerValue(coverage),
+                                  "Regions",
+                                  PointerValue(regions),
+                                  "RegionOwner",
+                                  UintegerValue(i),
+                                  "Horizon",
+                                  TimeValue(horizon));
+        mobility.Install(stas.Get(i));
+    }
+
+    //MOBILITY AP (STATIONARY AP), over its share of the fleet when partitioned
+    Ptr<ListPositionAllocator> positionAllocAP = CreateObject<ListPositionAllocator>();
+    positionAllocAP->Add(systemCount > 1 ? partition.centreOf[systemId] : apPosition);
+    MobilityHelper mobilityAP;
+    mobilityAP.SetPositionAllocator(positionAllocAP);
+    mobilityAP.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobilityAP.Install(ap);
+    fleet.setAccessPoint(ap.Get(0)->GetObject<MobilityModel>());
+    if (systemId == 0) {
+        Ptr<ListPositionAllocator> positionAllocCloud = CreateObject<ListPositionAllocator>();
+        positionAllocCloud->Add(apPosition);
+        mobilityAP.SetPositionAllocator(positionAllocCloud);
+        mobilityAP.Install(cloud);
+    }
+    if (buildingsLoss) {
+        BuildingsHelper::Install(stas);
+        BuildingsHelper::Install(ap);
+    }
+    recordPhase("mobility", start);
+}
+
+void ScenarioBuilder::installInternet() {
+    auto start = Clock::now();
+    // The AP already has its stack from the backhaul
+    InternetStackHelper internet;
+    internet.Install(stas);
+
+    // A /16 per rank leaves room for fleets well beyond 254 drones
+    Ipv4AddressHelper ipv4;
+    std::string subnet = "10." + std::to_string(systemId + 1) + ".0.0";
+    ipv4.SetBase(subnet.c_str(), "255.255.0.0");
+    wifiInterfaces = ipv4.Assign(devices);
+    recordPhase("internet", start);
+}
+
+void ScenarioBuilder::createSockets(Callback<void, Ptr<Socket>> edgeLogic) {
+    auto start = Clock::now();
+    TypeId tid = TypeId::LookupByName("ns3::UdpSocketFactory");
+
+    recvSink = Socket::CreateSocket(ap.Get(0), tid);
+    recvSink->Bind(InetSocketAddress(Ipv4Address::GetAny(), 80));
+    recvSink->SetRecvCallback(edgeLogic);
+
+    InetSocketAddress remote = InetSocketAddress(Ipv4Address("255.255.255.255"), 80);
+    for (uint32_t i = 0; i < fleet.size(); ++i) {
+        Ptr<Socket> socket = Socket::CreateSocket(stas.Get(i), tid);
+        socket->SetAllowBroadcast(true);
+        socket->Connect(remote);
+        fleet.setSocket(i, socket);
+    }
+
+    // Edge to cloud over the backhaul
+    uplink = Socket::CreateSocket(ap.Get(0), tid);
+    uplink->Connect(InetSocketAddress(backhaul[systemId].GetAddress(1), 9));
+    if (systemId == 0) {
+        cloudSink = Socket::CreateSocket(cloud.Get(0), tid);
+        cloudSink->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+        cloudSink->SetRecvCallback(MakeCallback(&ScenarioBuilder::cloudReceive, this));
+    }
+    recordPhase("sockets", start);
+}
+
+void ScenarioBuilder::relayToCloud(Ptr<Packet> packet) {
+    if (uplink && uplink->Send(packet) >= 0) {
+        relayed++;
+    }
+}
+
+void ScenarioBuilder::cloudReceive(Ptr<Socket> socket) {
+    while (socket->Recv()) {
+        cloudReceived++;
+    }
+}
+
+void ScenarioBuilder::reportSetupCost(std::ostream& os) const {
+    double total = 0;
+    os << "Scenario setup for " << stas.GetN() << " drones:" << std::endl;
+    for (const auto& phase : phases) {
+        os << "  " << std::left << std::setw(14) << phase.first << std::right << std::fixed
+           << std::setprecision(3) << phase.second << " ms" << std::endl;
+        total += phase.second;
+    }
+    os << "  " << std::left << std::setw(14) << "total" << std::right << total << " ms";
+    if (stas.GetN() > 0) {
+        os << " (" << (total * 1000.0) / stas.GetN() << " us/drone)";
+    }
+    os << std::defaultfloat << std::endl;
+}
+
+void ScenarioBuilder::reportPropagation(std::ostream& os) const {
+    if (!lossCache) {
+        return;
+    }
+    const PropagationPathCache* caches[2] = {&lossCache->GetCache(), &delayCache->GetCache()};
+    const char* names[2] = {"loss", "delay"};
+    os << "Propagation cache:";
+    for (int i = 0; i < 2; i++) {
+        uint64_t lookups = caches[i]->GetHits() + caches[i]->GetMisses();
+        os << (i > 0 ? "," : "") << " " << names[i] << " " << caches[i]->GetHits() << "/" << lookups << " hits";
+        if (lookups > 0) {
+            os << " (" << (100.0 * caches[i]->GetHits()) / lookups << "%)";
+        }
+    }
+    os << std::endl;
+
+    uint64_t culled = channel->GetOutOfRange() + channel->GetBelowSensitivity();
+    os << "Channel: " << channel->GetScheduled() << " receptions scheduled, " << culled << " culled ("
+       << channel->GetOutOfRange() << " out of range, " << channel->GetBelowSensitivity()
+       << " below sensitivity), range ";
+    if (channel->GetRange() > 0) {
+        os << channel->GetRange() << " m";
+    } else {
+        os << "unbounded";
+    }
+    double simulated = Simulator::Now().GetSeconds();
+    if (simulated > 0) {
+        os << "; " << Simulator::GetEventCount() / simulated << " events per simulated s";
+    }
+    os << std::endl;
+}
+
+void ScenarioBuilder::reportPartition(std::ostream& os, double wallSeconds) const {
+    uint64_t events = Simulator::GetEventCount();
+    os << "Rank " << systemId << "/" << systemCount << ": " << stas.GetN() << " of " << droneCount
+       << " drones, AP at (" << partition.centreOf[systemId].x << ", " << partition.centreOf[systemId].y
+       << "), " << relayed << " packets relayed to the cloud";
+    if (systemId == 0) {
+        os << ", cloud received " << cloudReceived;
+    }
+    os << "; " << events << " events in " << wallSeconds << " s";
+    if (wallSeconds > 0) {
+        os << " (" << events / wallSeconds << " events/s)";
+    }
+    os << std::endl;
+}
+
+void ScenarioBuilder::recordPhase(const std::string& name, Clock::time_point start) {
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    phases.emplace_back(name, elapsed.count());
+}
+
+uint32_t ScenarioBuilder::getDroneCount() const { return droneCount; }
+NodeContainer& ScenarioBuilder::getStas() { return stas; }
+NodeContainer& ScenarioBuilder::getAp() { return ap; }
+NetDeviceContainer& ScenarioBuilder::getDevices() { return devices; }
+Ipv4Address ScenarioBuilder::getApAddress() const { return wifiInterfaces.GetAddress(0); }
+YansWifiPhyHelper& ScenarioBuilder::getWifiPhy() { return wifiPhy; }
+DroneFleet& ScenarioBuilder::getFleet() { return fleet; }
+const ScenarioDocument& ScenarioBuilder::getScenario() const { return scenario; }
+Ptr<SpatialIndex> ScenarioBuilder::getRegions() const { return regions; }
@@ -0,0 +1,149 @@
+#ifndef SCENARIOBUILDER_H
+#define SCENARIOBUILDER_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/socket.h"
+#include "ns3/vector.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/generic-battery-model.h"
+#include "ns3/simple-device-energy-model.h"
+#include "ns3/netsimulyzer-module.h"
+#include "ns3/ipv4-interface-container.h"
+#include "../energy/predictive-battery-model.h"
+#include "../mobility/spatial-index.h"
+#include "../propagation/cached-propagation-model.h"
+#include "../wifi/airtime-energy-model.h"
+#include "../wifi/range-culled-wifi-channel.h"
+#include "FleetPartition.h"
+#include "Visualization.h"
+#include "../drone/Drone.h"
+#include "../drone/DroneFleet.h"
+#include "../parser/ScenarioDocument.h"
+
+/*
+ * Builds the drone fleet described by a scenario JSON.
+ *
+ * The scenario file is parsed once, the number of drones is the length of
+ * its "Drones" array and every per-drone object (node, battery, energy
+ * model, mobility, socket, NetSimulyzer entry) is created in a single loop
+ * over the fleet. Each build step records its
+ * wall-clock time so the setup cost can be compared across fleet sizes.
+ *
+ * With several MPI ranks the fleet is partitioned by region (see
+ * FleetPartition): every rank has its own AP and Wi-Fi cell for its drones,
+ * and every AP reaches the cloud server of rank 0 through a point-to-point
+ * backhaul link. All ranks create every node, so node ids agree, and the
+ * backhaul links, so that the remote channels match; devices, energy,
+ * mobility and sockets are only installed on the nodes of the local rank.
+ */
+class ScenarioBuilder {
+public:
+    explicit ScenarioBuilder(const std::string& configPath);
+
+    // Backhaul link parameters, before createNodes
+    void setBackhaul(const std::string& dataRate, ns3::Time delay);
+
+    // Build steps, to be called in this order
+    void createNodes(uint32_t systemId, uint32_t systemCount = 1);
+    // Only the drones the visualization shows get a node configuration
+    void configureNetSimulyzer(ns3::Ptr<ns3::netsimulyzer::Orchestrator> orchestrator,
+                               const Visualization& visualization);
+    // The channel loss is the scenario "PropagationLoss" model (default
+    // UavAirToGroundLossModel, rss is the level of a FixedRssLossModel), cached per link with "PropagationQuantum"
+    // metre cells (default 1). Unless "RangeCulling" is 0, frames are only
+    // scheduled on the PHYs within "RadioRange" metres (default estimated
+    // from the loss model) and above their sensitivity
+    void installWifi(const std::string& phyMode, double rss);
+    // One battery per drone, shared by the flight/compute draw and a
+    // WifiAirtimeEnergyModel of its Wi-Fi device (TX at the drone
+    // wirelessTransmissionPower, idle and RX at the scenario
+    // "RadioIdlePower" / "RadioRxPower" watts). Scenario "Battery":
+    // "periodic" (GenericBatteryModel, default) or "predictive"
+    // (PredictiveBatteryModel, no periodic update)
+    void installEnergy();
+    // Index the AoIs, the scenario "NoFly" boxes and the buildings created
+    // so far; installMobility hands it to every mobility model
+    void indexRegions();
+
+    // planner is "snake" (climb/snake/descend), "boustrophedon", "spiral"
+    // or "sector"; with "sector" the drones sharing an AoI split it. The
+    // flights are planned up to horizon, the end of the simulation
+    void installMobility(const ns3::Vector& apPosition, double turnStrength = 50,
+                         const std::string& planner = "snake", ns3::Time horizon = ns3::Time::Max());
+    void installInternet();
+    void createSockets(ns3::Callback<void, ns3::Ptr<ns3::Socket>> edgeLogic);
+
+    // Forward a packet received by the local AP to the cloud server
+    void relayToCloud(ns3::Ptr<ns3::Packet> packet);
+
+    // Prints the time spent in each build step
+    void reportSetupCost(std::ostream& os) const;
+
+    // Prints the hit rate of the propagation caches and the receptions the
+    // channel scheduled or culled
+    void reportPropagation(std::ostream& os) const;
+
+    // Prints the share of the fleet of this rank and its run cost
+    void reportPartition(std::ostream& os, double wallSeconds) const;
+
+    uint32_t getDroneCount() const;
+    ns3::NodeContainer& getStas();   // Drones of this rank
+    ns3::NodeContainer& getAp();     // AP of this rank
+    ns3::NetDeviceContainer& getDevices();
+    ns3::Ipv4Address getApAddress() const;   // AP of this rank on the Wi-Fi cell
+    ns3::YansWifiPhyHelper& getWifiPhy();
+    DroneFleet& getFleet();
+    const ScenarioDocument& getScenario() const;
+    ns3::Ptr<ns3::SpatialIndex> getRegions() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void recordPhase(const std::string& name, Clock::time_point start);
+    void cloudReceive(ns3::Ptr<ns3::Socket> socket);
+
+    ScenarioDocument scenario;
+    uint32_t droneCount;        // Whole fleet
+    uint32_t systemId;
+    uint32_t systemCount;
+    FleetPartition partition;
+    std::vector<uint32_t> localDrones;  // Scenario index of every local drone
+
+    ns3::NodeContainer allStas; // Drones of every rank
+    ns3::NodeContainer stas;    // Drones of this rank
+    ns3::NodeContainer aps;     // One edge server per rank
+    ns3::NodeContainer ap;      // Edge server of this rank
+    ns3::NodeContainer cloud;   // Cloud server, rank 0
+    ns3::NetDeviceContainer devices;
+    ns3::NetDeviceContainer staDevices;  // Wi-Fi device of every local drone
+    ns3::Ipv4InterfaceContainer wifiInterfaces;
+    std::vector<ns3::Ipv4InterfaceContainer> backhaul;  // (AP, cloud) of every rank
+    std::string backhaulRate;
+    ns3::Time backhaulDelay;
+    ns3::RangeCulledWifiPhyHelper wifiPhy;
+    ns3::Ptr<ns3::RangeCulledWifiChannel> channel;
+    ns3::Ptr<ns3::CachedPropagationLossModel> lossCache;
+    ns3::Ptr<ns3::CachedPropagationDelayModel> delayCache;
+    bool buildingsLoss;         // The loss model needs MobilityBuildingInfo
+    AirToGroundParams airToGround;  // Channel of the analytic upload cost
+
+    std::vector<ns3::Ptr<ns3::EnergySource>> batteries;
+    std::vector<ns3::Ptr<ns3::SimpleDeviceEnergyModel>> deviceEnergyModels;
+    DroneFleet fleet;
+    ns3::Ptr<ns3::SpatialIndex> regions;
+    ns3::Ptr<ns3::Socket> recvSink;
+    ns3::Ptr<ns3::Socket> uplink;     // Local AP to cloud
+    ns3::Ptr<ns3::Socket> cloudSink;
+    uint64_t relayed;
+    uint64_t cloudReceived;
+
+    std::vector<std::pair<std::string, double>> phases;  // (step, milliseconds)
+};
+
+#endif // SCENARIOBUILDER_H
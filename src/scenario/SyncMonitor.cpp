@@ -0,0 +1,122 @@
+#include "SyncMonitor.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+
+#include <chrono>
+#include <mpi.h>
+
+using namespace ns3;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+SyncMonitor::Synchronizer selected = SyncMonitor::GRANTED_TIME_WINDOW;
+bool armed = false;
+double stall = 0;
+uint64_t calls = 0;
+
+// Times one MPI call while armed
+class StallTimer {
+public:
+    StallTimer() : start(armed ? Clock::now() : Clock::time_point()) {}
+    ~StallTimer() {
+        if (armed) {
+            stall += std::chrono::duration<double>(Clock::now() - start).count();
+            calls++;
+        }
+    }
+
+private:
+    Clock::time_point start;
+};
+
+} // namespace
+
+// PMPI wrappers of the calls the ns-3 synchronizers wait in: the LBTS
+// all-gather of the granted time window, the receive tests of both and the
+// blocking wait of the null message one
+extern "C" {
+
+int MPI_Allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf, int recvcount,
+                  MPI_Datatype recvtype, MPI_Comm comm) {
+    StallTimer timer;
+    return PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+}
+
+int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                  MPI_Comm comm) {
+    StallTimer timer;
+    return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int MPI_Waitany(int count, MPI_Request requests[], int* index, MPI_Status* status) {
+    StallTimer timer;
+    return PMPI_Waitany(count, requests, index, status);
+}
+
+int MPI_Testany(int count, MPI_Request requests[], int* index, int* flag, MPI_Status* status) {
+    StallTimer timer;
+    return PMPI_Testany(count, requests, index, flag, status);
+}
+
+int MPI_Test(MPI_Request* request, int* flag, MPI_Status* status) {
+    StallTimer timer;
+    return PMPI_Test(request, flag, status);
+}
+
+} // extern "C"
+
+bool SyncMonitor::parse(const std::string& name, Synchronizer& sync) {
+    if (name == "granted") {
+        sync = GRANTED_TIME_WINDOW;
+    } else if (name == "nullmsg") {
+        sync = NULL_MESSAGE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string SyncMonitor::name(Synchronizer sync) {
+    return sync == NULL_MESSAGE ? "nullmsg" : "granted";
+}
+
+void SyncMonitor::select(Synchronizer sync, double tune) {
+    selected = sync;
+    if (sync == NULL_MESSAGE) {
+        Config::SetDefault("ns3::NullMessageSimulatorImpl::SchedulerTune", DoubleValue(tune));
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::NullMessageSimulatorImpl"));
+    } else {
+        GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    }
+}
+
+void SyncMonitor::arm() {
+    stall = 0;
+    calls = 0;
+    armed = true;
+}
+
+void SyncMonitor::disarm() {
+    armed = false;
+}
+
+double SyncMonitor::stallSeconds() {
+    return stall;
+}
+
+uint64_t SyncMonitor::stallCalls() {
+    return calls;
+}
+
+void SyncMonitor::report(std::ostream& os, uint32_t systemId, uint32_t systemCount, Time lookahead,
+                         double wallSeconds) {
+    double useful = wallSeconds > stall ? wallSeconds - stall : 0;
+    double share = wallSeconds > 0 ? 100.0 * stall / wallSeconds : 0;
+    os << "Rank " << systemId << "/" << systemCount << " synchronizer " << name(selected) << ", lookahead "
+       << lookahead.GetSeconds() * 1e3 << " ms: " << useful << " s processing events, " << stall
+       << " s synchronizing (" << share << "%) in " << calls << " MPI calls" << std::endl;
+}
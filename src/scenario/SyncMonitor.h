@@ -0,0 +1,54 @@
+#ifndef SYNCMONITOR_H
+#define SYNCMONITOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "ns3/nstime.h"
+
+/*
+ * Parallel synchronizer of the MPI runs and its cost.
+ *
+ * ns-3 ships two conservative synchronizers: the granted time window one
+ * (DistributedSimulatorImpl, a global LBTS reduction every window) and the
+ * null message one (NullMessageSimulatorImpl, Chandy-Misra-Bryant, each rank
+ * only waits on its neighbours). Both take their lookahead from the delay of
+ * the point-to-point links between ranks, here the AP-cloud backhaul.
+ *
+ * The synchronizer is picked by the SimulatorImplementationType global value,
+ * which MpiInterface::Enable reads, so select() has to run before it.
+ *
+ * While armed, the time spent in the MPI calls the synchronizers block or
+ * poll in (the LBTS all-gather, the receive tests and waits) is accumulated
+ * through the PMPI profiling interface; the rest of the run is event
+ * processing.
+ */
+class SyncMonitor {
+public:
+    enum Synchronizer {
+        GRANTED_TIME_WINDOW,
+        NULL_MESSAGE
+    };
+
+    // "granted" or "nullmsg", false for anything else
+    static bool parse(const std::string& name, Synchronizer& sync);
+    static std::string name(Synchronizer sync);
+
+    // Bind the simulator implementation, before MpiInterface::Enable.
+    // tune scales how often the null message synchronizer sends null
+    // messages (ns3::NullMessageSimulatorImpl::SchedulerTune)
+    static void select(Synchronizer sync, double tune = 1.0);
+
+    // Accumulate the MPI time between the two calls
+    static void arm();
+    static void disarm();
+
+    static double stallSeconds();
+    static uint64_t stallCalls();
+
+    // Per-rank split of the run into event processing and synchronization
+    static void report(std::ostream& os, uint32_t systemId, uint32_t systemCount, ns3::Time lookahead,
+                       double wallSeconds);
+};
+
+#endif // SYNCMONITOR_H
@@ -0,0 +1,195 @@
+#include "Visualization.h"
+#include "../parser/ScenarioDocument.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ns3;
+
+// NetAnim position update, "<nu p="p" t=".." id=".." x=".." y=".." />"
+static const char POSITION_TAG[] = "<nu p=\"p\" ";
+// Longest position update parsed, the others are kept as they are
+#define MAX_POSITION_LINE 160
+
+// Value of the attribute name (with its leading space and '="') of a NUL
+// terminated element
+static bool attribute(const char* element, const char* name, double& value) {
+    const char* p = strstr(element, name);
+    if (!p) {
+        return false;
+    }
+    p += strlen(name);
+    char* end = nullptr;
+    value = strtod(p, &end);
+    return end != p;
+}
+
+bool Visualization::parse(const std::string& name, Mode& mode) {
+    if (name == "off") {
+        mode = OFF;
+    } else if (name == "full") {
+        mode = FULL;
+    } else if (name == "sampled") {
+        mode = SAMPLED;
+    } else if (name == "threshold") {
+        mode = THRESHOLD;
+    } else if (name == "firstk") {
+        mode = FIRST_K;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string Visualization::name(Mode mode) {
+    switch (mode) {
+    case OFF:
+        return "off";
+    case FULL:
+        return "full";
+    case SAMPLED:
+        return "sampled";
+    case THRESHOLD:
+        return "threshold";
+    case FIRST_K:
+        return "firstk";
+    }
+    return "";
+}
+
+Visualization::Policy Visualization::policyFrom(const ScenarioDocument& scenario, Mode mode) {
+    Policy policy;
+    policy.mode = mode;
+    policy.rate = scenario.getDouble("VisualizationRate", 1);
+    policy.threshold = scenario.getDouble("VisualizationThreshold", 5);
+    policy.nodes = static_cast<uint32_t>(scenario.getDouble("VisualizationNodes", 10));
+    if (policy.rate <= 0) {
+        policy.rate = 1;
+    }
+    return policy;
+}
+
+Visualization::Visualization(const Policy& policy) : policy(policy) {}
+
+bool Visualization::isEnabled() const { return policy.mode != OFF; }
+
+Ptr<netsimulyzer::Orchestrator> Visualization::createOrchestrator(const std::string& path) {
+    if (policy.mode == OFF) {
+        return nullptr;
+    }
+    Ptr<netsimulyzer::Orchestrator> orchestrator = CreateObject<netsimulyzer::Orchestrator>(path);
+    if (policy.mode == SAMPLED) {
+        orchestrator->SetAttribute("MobilityPollInterval", TimeValue(Seconds(1 / policy.rate)));
+    }
+    return orchestrator;
+}
+
+void Visualization::configure(netsimulyzer::NodeConfigurationHelper& helper) const {
+    helper.Set("EnableMotionTrail", BooleanValue(policy.mode == FULL));
+    if (policy.mode == THRESHOLD) {
+        helper.Set("UsePositionTolerance", BooleanValue(true));
+        helper.Set("PositionTolerance", DoubleValue(policy.threshold));
+    }
+}
+
+bool Visualization::shows(uint32_t i) const {
+    return policy.mode != OFF && (policy.mode != FIRST_K || i < policy.nodes);
+}
+
+void Visualization::startAnimation(const std::string& path, const NodeContainer& drones) {
+    if (policy.mode == OFF) {
+        return;
+    }
+    animPath = path;
+    std::string target;
+    if (policy.mode == FULL) {
+        target = writer.open(path);
+    } else {
+        hidden.assign(NodeList::GetNNodes(), false);
+        for (uint32_t i = 0; i < drones.GetN(); i++) {
+            hidden[drones.Get(i)->GetId()] = !shows(i);
+        }
+        lastWritten.assign(NodeList::GetNNodes(), LastWritten{false, 0, 0, 0});
+        target = writer.open(path, [this](const char* line, size_t length) { return keepLine(line, length); });
+    }
+    if (target.empty()) {
+        return;
+    }
+    anim = std::make_unique<AnimationInterface>(target);
+    if (policy.mode != FULL) {
+        anim->SkipPacketTracing();
+        anim->EnablePacketMetadata(false);
+    }
+    if (policy.mode == SAMPLED) {
+        anim->SetMobilityPollInterval(Seconds(1 / policy.rate));
+    }
+    for (uint32_t i = 0; i < drones.GetN(); ++i) {
+        anim->SetConstantPosition(drones.Get(i), 0, 0);
+    }
+}
+
+bool Visualization::keepLine(const char* line, size_t length) {
+    const size_t tagLength = sizeof(POSITION_TAG) - 1;
+    if (length < tagLength || length >= MAX_POSITION_LINE || memcmp(line, POSITION_TAG, tagLength) != 0) {
+        return true;
+    }
+    char element[MAX_POSITION_LINE];
+    memcpy(element, line, length);
+    element[length] = '\0';
+    double t, id, x, y;
+    if (!attribute(element, " t=\"", t) || !attribute(element, " id=\"", id) ||
+        !attribute(element, " x=\"", x) || !attribute(element, " y=\"", y)) {
+        return true;
+    }
+    uint32_t node = static_cast<uint32_t>(id);
+    if (node >= lastWritten.size()) {
+        return true;
+    }
+    if (hidden[node]) {
+        return false;
+    }
+    LastWritten& last = lastWritten[node];
+    if (last.valid) {
+        // Poll times are multiples of the interval, allow for their rounding
+        if (policy.mode == SAMPLED && t - last.t < 0.999 / policy.rate) {
+            return false;
+        }
+        if (policy.mode == THRESHOLD && std::hypot(x - last.x, y - last.y) < policy.threshold) {
+            return false;
+        }
+    }
+    last = LastWritten{true, t, x, y};
+    return true;
+}
+
+void Visualization::close() {
+    // Writes the end of the document and closes the library end of the pipe
+    anim.reset();
+    writer.close();
+}
+
+void Visualization::report(std::ostream& os) const {
+    os << "Visualization: " << name(policy.mode);
+    switch (policy.mode) {
+    case SAMPLED:
+        os << " (" << policy.rate << " Hz)";
+        break;
+    case THRESHOLD:
+        os << " (" << policy.threshold << " m)";
+        break;
+    case FIRST_K:
+        os << " (" << policy.nodes << " drones)";
+        break;
+    default:
+        break;
+    }
+    if (policy.mode != OFF) {
+        os << "; NetAnim " << writer.getBytesIn() / 1e6 << " MB traced, " << writer.getBytesOut() / 1e6
+           << " MB written to " << animPath << ", " << writer.getLinesDropped() << " position updates dropped";
+    }
+    os << std::endl;
+}
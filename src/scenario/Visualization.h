@@ -0,0 +1,91 @@
+#ifndef VISUALIZATION_H
+#define VISUALIZATION_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/netanim-module.h"
+#include "ns3/netsimulyzer-module.h"
+#include "ns3/node-container.h"
+#include "ns3/ptr.h"
+#include "../telemetry/AsyncTraceWriter.h"
+
+class ScenarioDocument;
+
+/*
+ * How much of the run goes to NetAnim and NetSimulyzer.
+ *
+ *  - OFF: neither output is created.
+ *  - FULL: every position poll, course change and packet, with motion
+ *    trails (the former behaviour).
+ *  - SAMPLED: positions at Rate Hz per node, no packets.
+ *  - THRESHOLD: a node position is written once it moved Threshold metres
+ *    from the last one written, no packets.
+ *  - FIRST_K: only the first Nodes drones of the rank (plus the AP and the
+ *    cloud), no packets.
+ *
+ * NetSimulyzer applies the policy through its own attributes (mobility poll
+ * interval, position tolerance, configured nodes). NetAnim only has a poll
+ * interval and packet switches, its course change updates are thinned out
+ * by the filter of the AsyncTraceWriter its XML goes through.
+ */
+class Visualization {
+public:
+    enum Mode { OFF, FULL, SAMPLED, THRESHOLD, FIRST_K };
+
+    struct Policy {
+        Mode mode;
+        double rate;        // SAMPLED positions per second
+        double threshold;   // THRESHOLD metres
+        uint32_t nodes;     // FIRST_K drones
+    };
+
+    // "off", "full", "sampled", "threshold" or "firstk"
+    static bool parse(const std::string& name, Mode& mode);
+    static std::string name(Mode mode);
+
+    // Scenario "VisualizationRate" (Hz, 1), "VisualizationThreshold" (m, 5)
+    // and "VisualizationNodes" (10)
+    static Policy policyFrom(const ScenarioDocument& scenario, Mode mode);
+
+    explicit Visualization(const Policy& policy);
+
+    bool isEnabled() const;
+
+    // NetSimulyzer output to path, null when OFF
+    ns3::Ptr<ns3::netsimulyzer::Orchestrator> createOrchestrator(const std::string& path);
+    // Motion trail and position tolerance of the node configuration
+    void configure(ns3::netsimulyzer::NodeConfigurationHelper& helper) const;
+    // Is the drone of local index i shown?
+    bool shows(uint32_t i) const;
+
+    // NetAnim output to path for the drones, nothing when OFF
+    void startAnimation(const std::string& path, const ns3::NodeContainer& drones);
+    // End the NetAnim output and wait for its writer, after Simulator::Destroy
+    void close();
+
+    // Prints the policy and the NetAnim bytes traced, written and dropped
+    void report(std::ostream& os) const;
+
+private:
+    // Writer thread filter of the NetAnim position updates
+    bool keepLine(const char* line, size_t length);
+
+    struct LastWritten {
+        bool valid;
+        double t;
+        double x;
+        double y;
+    };
+
+    Policy policy;
+    std::unique_ptr<ns3::AnimationInterface> anim;
+    AsyncTraceWriter writer;
+    std::string animPath;
+    std::vector<bool> hidden;           // By node id, set before the writer starts
+    std::vector<LastWritten> lastWritten; // By node id, writer thread only
+};
+
+#endif // VISUALIZATION_H
@@ -0,0 +1,357 @@
+#include "profiling-simulator-impl.h"
+#include "AllocationCounter.h"
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ProfilingSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingSimulatorImpl);
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Label indices of the events outside any node and of the unlabelled nodes
+const uint32_t MAIN_LABEL = 0;
+const uint32_t NODE_LABEL = 1;
+// Entries printed by Report()
+const size_t REPORT_ENTRIES = 15;
+
+// Runs the wrapped event and accounts it to its entry
+class ProfiledEvent : public EventImpl {
+public:
+    ProfiledEvent(EventImpl *event, ProfilingSimulatorImpl::Entry *entry)
+        : m_event(event, false), m_entry(entry) {}
+
+    // Off the counted heap, the wrappers are not allocations of the events
+    static void *operator new(std::size_t size) {
+        void *p = std::malloc(size);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    static void operator delete(void *p) {
+        std::free(p);
+    }
+
+private:
+    void Notify() override {
+        uint64_t allocations = AllocationCounter::allocations();
+        uint64_t bytes = AllocationCounter::bytes();
+        Clock::time_point start = Clock::now();
+        m_event->Invoke();
+        m_entry->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        m_entry->allocations += AllocationCounter::allocations() - allocations;
+        m_entry->bytes += AllocationCounter::bytes() - bytes;
+        m_entry->events++;
+    }
+
+    Ptr<EventImpl> m_event;
+    ProfilingSimulatorImpl::Entry *m_entry;
+};
+
+// Drop the "ns3::" qualifiers
+std::string Unqualified(std::string name) {
+    static const std::string ns = "ns3::";
+    for (size_t at = name.find(ns); at != std::string::npos; at = name.find(ns, at)) {
+        name.erase(at, ns.size());
+    }
+    return name;
+}
+
+// End of the template argument or parameter starting at begin
+size_t ArgumentEnd(const std::string &name, size_t begin) {
+    int depth = 0;
+    for (size_t i = begin; i < name.size(); i++) {
+        char c = name[i];
+        if (c == '<' || c == '(' || c == '[' || c == '{') {
+            depth++;
+        } else if (c == '>' || c == ')' || c == ']' || c == '}') {
+            if (depth == 0) {
+                return i;
+            }
+            depth--;
+        } else if (c == ',' && depth == 0) {
+            return i;
+        }
+    }
+    return name.size();
+}
+
+} // namespace
+
+TypeId ProfilingSimulatorImpl::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::ProfilingSimulatorImpl").SetParent<SimulatorImpl>().SetGroupName("Core");
+    return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl(Ptr<SimulatorImpl> impl)
+    : m_impl(impl), m_labels({"main", "node"}), m_runNanoseconds(0), m_runEvents(0) {}
+
+ProfilingSimulatorImpl::~ProfilingSimulatorImpl() {}
+
+Ptr<ProfilingSimulatorImpl> ProfilingSimulatorImpl::Enable(const std::string &output) {
+    StringValue type;
+    GlobalValue::GetValueByName("SimulatorImplementationType", type);
+    ObjectFactory factory;
+    factory.SetTypeId(type.Get());
+    Ptr<ProfilingSimulatorImpl> profiler = CreateObject<ProfilingSimulatorImpl>(factory.Create<SimulatorImpl>());
+    profiler->m_output = output;
+    // Only the simulation thread is measured, and only from here on
+    AllocationCounter::enable();
+    // Also sets the scheduler of the wrapped implementation
+    Simulator::SetImplementation(profiler);
+    return profiler;
+}
+
+void ProfilingSimulatorImpl::SetContextLabel(uint32_t context, const std::string &label) {
+    uint32_t index = std::find(m_labels.begin(), m_labels.end(), label) - m_labels.begin();
+    if (index == m_labels.size()) {
+        m_labels.push_back(label);
+    }
+    if (context >= m_contextLabel.size()) {
+        m_contextLabel.resize(context + 1, NODE_LABEL);
+    }
+    m_contextLabel[context] = index;
+}
+
+void ProfilingSimulatorImpl::Name(const std::type_info &type, std::string &owner, std::string &callable) {
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : type.name();
+    std::free(demangled);
+
+    // MakeEvent events are local classes of its overloads, whose first
+    // parameter is the callable: "void (ns3::Class::*)(args)", "void (*)(args)"
+    // or a lambda, named after the function it is defined in
+    static const std::string makeEvent = "ns3::MakeEvent";
+    size_t at = name.find(makeEvent);
+    if (at == std::string::npos) {
+        owner = "event";
+        callable = Unqualified(name);
+        return;
+    }
+    size_t begin = at + makeEvent.size();
+    if (begin < name.size() && name[begin] == '<') {
+        begin = ArgumentEnd(name, begin + 1);
+        while (begin < name.size() && name[begin] == ',') {
+            begin = ArgumentEnd(name, begin + 1);
+        }
+        begin++;
+    }
+    begin++;
+    std::string function = Unqualified(name.substr(begin, ArgumentEnd(name, begin) - begin));
+    size_t member = function.find("::*)");
+    size_t open = function.find('(');
+    if (member != std::string::npos && open != std::string::npos && open < member) {
+        owner = function.substr(open + 1, member - open - 1);
+        callable = owner + "::*" + function.substr(member + 4);
+    } else if (function.find("(*)") != std::string::npos) {
+        owner = "function";
+        callable = function;
+    } else {
+        owner = "lambda";
+        callable = function;
+    }
+}
+
+EventImpl *ProfilingSimulatorImpl::Wrap(uint32_t context, EventImpl *event) {
+    const std::type_info &type = typeid(*event);
+    auto found = m_callableIndex.find(type);
+    uint32_t callable;
+    if (found != m_callableIndex.end()) {
+        callable = found->second;
+    } else {
+        callable = m_owners.size();
+        m_callableIndex.emplace(type, callable);
+        m_owners.emplace_back();
+        m_callables.emplace_back();
+        Name(type, m_owners.back(), m_callables.back());
+    }
+    uint32_t label = MAIN_LABEL;
+    if (context != Simulator::NO_CONTEXT) {
+        label = context < m_contextLabel.size() ? m_contextLabel[context] : NODE_LABEL;
+    }
+    // Node based: the entry stays where it is as the map grows
+    Entry &entry = m_entries.emplace(uint64_t(label) << 32 | callable, Entry{0, 0, 0, 0}).first->second;
+    return new ProfiledEvent(event, &entry);
+}
+
+void ProfilingSimulatorImpl::Destroy() {
+    m_impl->Destroy();
+}
+
+bool ProfilingSimulatorImpl::IsFinished() const {
+    return m_impl->IsFinished();
+}
+
+void ProfilingSimulatorImpl::Stop() {
+    m_impl->Stop();
+}
+
+void ProfilingSimulatorImpl::Stop(const Time &delay) {
+    m_impl->Stop(delay);
+}
+
+EventId ProfilingSimulatorImpl::Schedule(const Time &delay, EventImpl *event) {
+    return m_impl->Schedule(delay, Wrap(m_impl->GetContext(), event));
+}
+
+void ProfilingSimulatorImpl::ScheduleWithContext(uint32_t context, const Time &delay, EventImpl *event) {
+    m_impl->ScheduleWithContext(context, delay, Wrap(context, event));
+}
+
+EventId ProfilingSimulatorImpl::ScheduleNow(EventImpl *event) {
+    return m_impl->ScheduleNow(Wrap(m_impl->GetContext(), event));
+}
+
+EventId ProfilingSimulatorImpl::ScheduleDestroy(EventImpl *event) {
+    return m_impl->ScheduleDestroy(Wrap(Simulator::NO_CONTEXT, event));
+}
+
+void ProfilingSimulatorImpl::Remove(const EventId &id) {
+    m_impl->Remove(id);
+}
+
+void ProfilingSimulatorImpl::Cancel(const EventId &id) {
+    m_impl->Cancel(id);
+}
+
+bool ProfilingSimulatorImpl::IsExpired(const EventId &id) const {
+    return m_impl->IsExpired(id);
+}
+
+void ProfilingSimulatorImpl::Run() {
+    uint64_t events = m_impl->GetEventCount();
+    Clock::time_point start = Clock::now();
+    m_impl->Run();
+    m_runNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    m_runEvents += m_impl->GetEventCount() - events;
+    WriteStacks();
+}
+
+Time ProfilingSimulatorImpl::Now() const {
+    return m_impl->Now();
+}
+
+Time ProfilingSimulatorImpl::GetDelayLeft(const EventId &id) const {
+    return m_impl->GetDelayLeft(id);
+}
+
+Time ProfilingSimulatorImpl::GetMaximumSimulationTime() const {
+    return m_impl->GetMaximumSimulationTime();
+}
+
+void ProfilingSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory) {
+    m_impl->SetScheduler(schedulerFactory);
+}
+
+uint32_t ProfilingSimulatorImpl::GetSystemId() const {
+    return m_impl->GetSystemId();
+}
+
+uint32_t ProfilingSimulatorImpl::GetContext() const {
+    return m_impl->GetContext();
+}
+
+uint64_t ProfilingSimulatorImpl::GetEventCount() const {
+    return m_impl->GetEventCount();
+}
+
+void ProfilingSimulatorImpl::DoDispose() {
+    m_impl = nullptr;
+    SimulatorImpl::DoDispose();
+}
+
+void ProfilingSimulatorImpl::WriteStacks(void) const {
+    if (m_output.empty()) {
+        return;
+    }
+    std::ofstream out(m_output);
+    if (!out) {
+        std::cerr << "Could not open " << m_output << std::endl;
+        return;
+    }
+    int64_t inEvents = 0;
+    for (const auto &[key, entry] : m_entries) {
+        inEvents += entry.nanoseconds;
+        int64_t us = entry.nanoseconds / 1000;
+        if (us > 0) {
+            uint32_t callable = key & 0xffffffff;
+            out << m_labels[key >> 32] << ';' << m_owners[callable] << ';' << m_callables[callable] << ' ' << us
+                << '\n';
+        }
+    }
+    if (m_runNanoseconds > inEvents) {
+        out << "[simulator] " << (m_runNanoseconds - inEvents) / 1000 << '\n';
+    }
+}
+
+ProfilingSimulatorImpl::Entry ProfilingSimulatorImpl::Sum(const std::string &owner) const {
+    Entry sum{0, 0, 0, 0};
+    for (const auto &[key, entry] : m_entries) {
+        if (m_owners[key & 0xffffffff] == owner) {
+            sum.events += entry.events;
+            sum.nanoseconds += entry.nanoseconds;
+            sum.allocations += entry.allocations;
+            sum.bytes += entry.bytes;
+        }
+    }
+    return sum;
+}
+
+void ProfilingSimulatorImpl::Report(std::ostream &os) const {
+    std::vector<std::pair<uint64_t, const Entry *>> entries;
+    int64_t inEvents = 0;
+    for (const auto &[key, entry] : m_entries) {
+        inEvents += entry.nanoseconds;
+        if (entry.events > 0) {
+            entries.emplace_back(key, &entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+        return a.second->nanoseconds > b.second->nanoseconds;
+    });
+    double run = m_runNanoseconds / 1e9;
+    os << "Profile: " << m_runEvents << " events, " << run << " s of Run ("
+       << (run > 0 ? m_runEvents / run : 0) << " events/s), " << inEvents / 1e9 << " s in events, "
+       << std::max<int64_t>(m_runNanoseconds - inEvents, 0) / 1e9 << " s scheduling and synchronizing";
+    if (!m_output.empty()) {
+        os << "; collapsed stacks in " << m_output;
+    }
+    if (!AllocationCounter::isEnabled()) {
+        os << "; allocations not counted (configure with -DCOUNT_ALLOCATIONS=ON)";
+    }
+    os << std::endl;
+    for (size_t i = 0; i < entries.size() && i < REPORT_ENTRIES; i++) {
+        const Entry &entry = *entries[i].second;
+        uint32_t callable = entries[i].first & 0xffffffff;
+        os << "  " << std::fixed << std::setprecision(1) << std::setw(5)
+           << (m_runNanoseconds > 0 ? 100.0 * entry.nanoseconds / m_runNanoseconds : 0) << "% "
+           << std::setw(10) << entry.events << " events " << std::setw(8) << std::setprecision(2)
+           << entry.nanoseconds / 1e3 / entry.events << " us";
+        if (AllocationCounter::isEnabled()) {
+            os << std::setw(7) << double(entry.allocations) / entry.events << " allocs " << std::setw(8)
+               << std::setprecision(0) << double(entry.bytes) / entry.events << " B";
+        }
+        os << "  " << m_labels[entries[i].first >> 32] << ' ' << m_callables[callable] << std::defaultfloat
+           << std::endl;
+    }
+}
+
+} // namespace ns3
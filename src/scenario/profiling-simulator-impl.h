@@ -0,0 +1,115 @@
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include "ns3/event-id.h"
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/simulator-impl.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * SimulatorImpl profiling the events of the implementation it wraps: the
+ * default one, or DistributedSimulatorImpl / NullMessageSimulatorImpl in the
+ * MPI runs.
+ *
+ * Every event scheduled through it is wrapped, so that running it measures
+ * its wall time and the heap allocations of the simulation thread (see
+ * AllocationCounter, none without COUNT_ALLOCATIONS). These are summed per
+ * context label (set per node, "main" outside any node) and scheduled
+ * callable. EventImpl hides the function it calls, so the callable is named
+ * after the type of its event: the class and signature of a member function,
+ * the signature of a free function, the function a lambda is defined in.
+ * Two methods of one class with the same signature share an entry.
+ *
+ * At the end of Run() the breakdown is written to the output file as
+ * collapsed stacks ("label;Class;callable microseconds", the input of
+ * flamegraph.pl or speedscope). The wall time of Run() outside any event
+ * (scheduler, MPI synchronization) is the "[simulator]" stack.
+ */
+class ProfilingSimulatorImpl : public SimulatorImpl {
+public:
+  static TypeId GetTypeId(void);
+  explicit ProfilingSimulatorImpl(Ptr<SimulatorImpl> impl);
+  ~ProfilingSimulatorImpl() override;
+
+  // Wrap the implementation SimulatorImplementationType names and install
+  // it, after MpiInterface::Enable (which rebinds that value) and before any
+  // other Simulator call. Collapsed stacks written to output
+  static Ptr<ProfilingSimulatorImpl> Enable(const std::string &output);
+
+  // Events in the context of node id attributed to label ("node" when unset)
+  void SetContextLabel(uint32_t context, const std::string &label);
+
+  struct Entry {
+    uint64_t events;
+    int64_t nanoseconds;
+    uint64_t allocations;
+    uint64_t bytes;
+  };
+
+  // Totals of the callables of a class frame (the owner in the collapsed
+  // stacks) over every label
+  Entry Sum(const std::string &owner) const;
+
+  // Prints the events per second of Run() and the most expensive entries
+  void Report(std::ostream &os) const;
+
+  // SimulatorImpl, forwarded to the wrapped implementation
+  void Destroy() override;
+  bool IsFinished() const override;
+  void Stop() override;
+  void Stop(const Time &delay) override;
+  EventId Schedule(const Time &delay, EventImpl *event) override;
+  void ScheduleWithContext(uint32_t context, const Time &delay, EventImpl *event) override;
+  EventId ScheduleNow(EventImpl *event) override;
+  EventId ScheduleDestroy(EventImpl *event) override;
+  void Remove(const EventId &id) override;
+  void Cancel(const EventId &id) override;
+  bool IsExpired(const EventId &id) const override;
+  void Run() override;
+  Time Now() const override;
+  Time GetDelayLeft(const EventId &id) const override;
+  Time GetMaximumSimulationTime() const override;
+  void SetScheduler(ObjectFactory schedulerFactory) override;
+  uint32_t GetSystemId() const override;
+  uint32_t GetContext() const override;
+  uint64_t GetEventCount() const override;
+
+
+private:
+  void DoDispose() override;
+
+  // Event of the callable run in context
+  EventImpl *Wrap(uint32_t context, EventImpl *event);
+  // Class frame and callable of the demangled type of an event
+  static void Name(const std::type_info &type, std::string &owner, std::string &callable);
+  void WriteStacks(void) const;
+
+  Ptr<SimulatorImpl> m_impl;
+  std::string m_output;
+
+  std::vector<std::string> m_labels;        //!< "main", "node", then SetContextLabel ones
+  std::vector<uint32_t> m_contextLabel;     //!< Label index by node id
+  std::unordered_map<std::type_index, uint32_t> m_callableIndex;
+  std::vector<std::string> m_owners;        //!< Class frame by callable index
+  std::vector<std::string> m_callables;
+  // By label index << 32 | callable index, the events keep pointers to them
+  std::unordered_map<uint64_t, Entry> m_entries;
+
+  int64_t m_runNanoseconds;
+  uint64_t m_runEvents;
+};
+
+} // namespace ns3
+
+#endif // PROFILING_SIMULATOR_IMPL_H
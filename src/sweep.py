@@ -0,0 +1,267 @@
+import argparse
+import concurrent.futures
+import copy
+import csv
+import itertools
+import json
+import os
+import re
+import subprocess
+
+import numpy as np
+
+# Parameter sweep over variants of a scenario JSON.
+#
+# Every combination of the --grid values (times --seeds replicas) is an
+# isolated run: its own directory under <output>/runs holding the scenario,
+# the stdout, the NetSimulyzer/NetAnim/pcap files and the telemetry, and its
+# own ns-3 run number (--RngRun). Runs are spread over --jobs simulations at
+# a time. A run is done once its done.json exists, so a sweep started again
+# with the same grid only runs what is missing or failed.
+#
+# The telemetry of all the done runs is merged into <output>/telemetry, in
+# the TelemetrySink layout plus a "run" column (plot.read_telemetry reads
+# it), and <output>/runs.csv indexes the runs: parameters, seed and the
+# summary printed by the simulation.
+#
+# Grid keys:
+#   any field of a "Drones" entry (speed, weight, dragCoefficient,
+#   numLocalIter, ...) is set on every drone
+#   aoiSize  side (m) of every AoI, kept around its centre
+#   drones   fleet size, the drones of the base scenario are cycled
+#   stations number of charging stations, the "Stations" of the base
+#            scenario are cycled
+#   any other top-level key (Planner, Synchronizer, Lookahead, FlMode, FlSelection,
+#   Battery, Duration, StationReserve, Visualization, Pcap, Profile, ...)
+
+SUMMARY = {
+    'records': (re.compile(r'Telemetry records written: (\d+)'), int),
+    'missions_landed': (re.compile(r'Coverage: (\d+)/\d+ missions completed'), int),
+    'mission_time_mean_s': (re.compile(r'mission time ([0-9.eE+-]+) s mean'), float),
+    'mission_time_max_s': (re.compile(r'mean, ([0-9.eE+-]+) s max'), float),
+    'covered_m2': (re.compile(r'covered ([0-9.eE+-]+) m\^2'), float),
+    'mission_energy_j': (re.compile(r'm\^2 with ([0-9.eE+-]+) J'), float),
+    'radio_energy_j': (re.compile(r'Radio: ([0-9.eE+-]+) J'), float),
+    'upload_energy_j': (re.compile(r'model upload ([0-9.eE+-]+) J'), float),
+    'upload_time_s': (re.compile(r'J in ([0-9.eE+-]+) s per round'), float),
+    'fl_rounds': (re.compile(r'FL \w+: (\d+)/\d+ rounds'), int),
+    'fl_round_latency_s': (re.compile(r'round latency ([0-9.eE+-]+) s mean'), float),
+    'fl_straggler_pct': (re.compile(r'stragglers ([0-9.eE+-]+)% of'), float),
+    'fl_energy_per_round_j': (re.compile(r'([0-9.eE+-]+) J per round \('), float),
+    'fl_converged_s': (re.compile(r'converged in ([0-9.eE+-]+) s'), float),
+    'fl_converged_j': (re.compile(r'converged in [0-9.eE+-]+ s and ([0-9.eE+-]+) J'), float),
+    'fl_selected': (re.compile(r'FL selection \w+: ([0-9.eE+-]+) of'), float),
+    'station_returns': (re.compile(r'pads; (\d+) returns on low energy'), int),
+    'stranded': (re.compile(r'(\d+) stranded'), int),
+    'availability_pct': (re.compile(r'availability ([0-9.eE+-]+)%'), float),
+    'throughput_m2_h': (re.compile(r'throughput ([0-9.eE+-]+) m\^2/h'), float),
+    'restricted_s': (re.compile(r'Restricted airspace: ([0-9.eE+-]+) s'), float),
+    'receptions_scheduled': (re.compile(r'Channel: (\d+) receptions scheduled'), int),
+    'receptions_culled': (re.compile(r'scheduled, (\d+) culled'), int),
+    'events_per_sim_s': (re.compile(r'([0-9.eE+-]+) events per simulated s'), float),
+    'events': (re.compile(r'; (\d+) events in'), int),
+    'wall_s': (re.compile(r'events in ([0-9.eE+-]+) s'), float),
+    'profiled_events_per_s': (re.compile(r'of Run \(([0-9.eE+-]+) events/s\)'), float),
+}
+
+
+def parse_value(text):
+    try:
+        return int(text)
+    except ValueError:
+        pass
+    try:
+        return float(text)
+    except ValueError:
+        return text
+
+
+def parse_grid(specs):
+    grid = []
+    for spec in specs:
+        key, _, values = spec.partition('=')
+        if not key or not values:
+            raise SystemExit('Bad grid "%s", expected key=v1,v2,...' % spec)
+        grid.append((key, [parse_value(v) for v in values.split(',')]))
+    return grid
+
+
+def resize_aoi(aoi, side):
+    aoi = dict(aoi)
+    cx = (aoi['xMin'] + aoi['xMax']) / 2
+    cy = (aoi['yMin'] + aoi['yMax']) / 2
+    aoi['xMin'], aoi['xMax'] = cx - side / 2, cx + side / 2
+    aoi['yMin'], aoi['yMax'] = cy - side / 2, cy + side / 2
+    return aoi
+
+
+def make_scenario(base, params):
+    scenario = copy.deepcopy(base)
+    # Fleet size first, the per-drone values then apply to the new fleet
+    if 'drones' in params:
+        count = int(params['drones'])
+        scenario['Drones'] = [copy.deepcopy(base['Drones'][i % len(base['Drones'])]) for i in range(count)]
+    if 'stations' in params:
+        count = int(params['stations'])
+        stations = base.get('Stations', [])
+        scenario['Stations'] = [copy.deepcopy(stations[i % len(stations)]) for i in range(count)] if stations else []
+    for key, value in params.items():
+        if key in ('drones', 'stations'):
+            continue
+        if key == 'aoiSize':
+            for drone in scenario['Drones']:
+                drone['aoi'] = resize_aoi(drone['aoi'], float(value))
+        elif base['Drones'] and key in base['Drones'][0]:
+            for drone in scenario['Drones']:
+                drone[key] = value
+        else:
+            scenario[key] = value
+    return scenario
+
+
+def parse_summary(stdout):
+    summary = {}
+    for name, (pattern, kind) in SUMMARY.items():
+        match = pattern.search(stdout)
+        summary[name] = kind(match.group(1)) if match else ''
+    return summary
+
+
+def run_one(args, run):
+    directory = run['dir']
+    os.makedirs(directory, exist_ok=True)
+    config = os.path.join(directory, 'scenario.json')
+    with open(config, 'w') as f:
+        json.dump(run['scenario'], f, indent=2)
+
+    cmd = [args.binary, '--RngSeed=%d' % args.seed, '--RngRun=%d' % run['rng_run'],
+           '--outputDir=%s' % directory] + args.extra + [config]
+    if args.ranks > 1:
+        cmd = [args.mpiexec, '-n', str(args.ranks)] + cmd
+    out = subprocess.run(cmd, capture_output=True, text=True, cwd=directory)
+    with open(os.path.join(directory, 'stdout.txt'), 'w') as f:
+        f.write(out.stdout)
+    with open(os.path.join(directory, 'stderr.txt'), 'w') as f:
+        f.write(out.stderr)
+    if out.returncode != 0:
+        return run['id'], 'failed (code %d)' % out.returncode
+
+    done = {'params': run['params'], 'rng_run': run['rng_run'], 'summary': parse_summary(out.stdout)}
+    with open(os.path.join(directory, 'done.json.tmp'), 'w') as f:
+        json.dump(done, f, indent=2)
+    os.replace(os.path.join(directory, 'done.json.tmp'), os.path.join(directory, 'done.json'))
+    return run['id'], 'done'
+
+
+def is_done(run):
+    try:
+        with open(os.path.join(run['dir'], 'done.json')) as f:
+            done = json.load(f)
+    except (OSError, ValueError):
+        return False
+    # The same directory with other parameters is a different sweep
+    return done['params'] == run['params'] and done['rng_run'] == run['rng_run']
+
+
+def read_columns(directory):
+    with open(os.path.join(directory, 'schema.txt')) as schema:
+        rows = int(schema.readline().split()[1])
+        columns = [line.split() for line in schema if line.strip()]
+    data = {}
+    for name, dtype in columns:
+        data[name] = np.fromfile(os.path.join(directory, name + '.bin'), dtype=dtype, count=rows)
+    return rows, columns, data
+
+
+def merge(args, runs):
+    index = []
+    parts = []
+    columns = None
+    for run in runs:
+        if not is_done(run):
+            continue
+        with open(os.path.join(run['dir'], 'done.json')) as f:
+            done = json.load(f)
+        row = {'run': run['id'], 'rng_run': run['rng_run']}
+        row.update(run['params'])
+        row.update(done['summary'])
+        index.append(row)
+        # telemetry, then telemetry-rank<N> of the other MPI ranks
+        for name in sorted(os.listdir(run['dir'])):
+            telemetry = os.path.join(run['dir'], name)
+            if name.startswith('telemetry') and os.path.exists(os.path.join(telemetry, 'schema.txt')):
+                rows, columns, data = read_columns(telemetry)
+                data['run'] = np.full(rows, run['id'], dtype='<u4')
+                parts.append(data)
+
+    if index:
+        with open(os.path.join(args.output, 'runs.csv'), 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=list(index[0].keys()))
+            writer.writeheader()
+            writer.writerows(index)
+
+    if parts:
+        merged = os.path.join(args.output, 'telemetry')
+        os.makedirs(merged, exist_ok=True)
+        columns = columns + [['run', '<u4']]
+        rows = 0
+        for name, dtype in columns:
+            values = np.concatenate([part[name] for part in parts]).astype(dtype, copy=False)
+            values.tofile(os.path.join(merged, name + '.bin'))
+            rows = len(values)
+        with open(os.path.join(merged, 'schema.txt'), 'w') as schema:
+            schema.write('rows %d\n' % rows)
+            for name, dtype in columns:
+                schema.write('%s %s\n' % (name, dtype))
+    return len(index)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Parameter sweep over scenario variants')
+    parser.add_argument('--binary', default=os.path.abspath('build/out'))
+    parser.add_argument('--config', default=os.path.abspath('scenario/scenario.json'))
+    parser.add_argument('--grid', action='append', default=[], help='key=v1,v2,... (repeatable)')
+    parser.add_argument('--seeds', type=int, default=1, help='Replicas of every combination')
+    parser.add_argument('--seed', type=int, default=1, help='ns-3 RngSeed shared by the sweep')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count())
+    parser.add_argument('--ranks', type=int, default=1, help='MPI ranks per run')
+    parser.add_argument('--mpiexec', default='mpiexec')
+    parser.add_argument('--output', default='results/sweep')
+    parser.add_argument('extra', nargs='*', help='More arguments for the simulation (after --)')
+    args = parser.parse_args()
+    args.binary = os.path.abspath(args.binary)
+    args.output = os.path.abspath(args.output)
+
+    with open(args.config) as f:
+        base = json.load(f)
+    grid = parse_grid(args.grid)
+    keys = [key for key, _ in grid]
+
+    runs = []
+    for values in itertools.product(*[values for _, values in grid]):
+        params = dict(zip(keys, values))
+        scenario = make_scenario(base, params)
+        for replica in range(args.seeds):
+            run_id = len(runs)
+            runs.append({'id': run_id, 'params': dict(params, replica=replica), 'rng_run': run_id + 1,
+                         'scenario': scenario, 'dir': os.path.join(args.output, 'runs', 'run-%05d' % run_id)})
+
+    pending = [run for run in runs if not is_done(run)]
+    print('%d runs, %d already done, %d to run on %d jobs' % (len(runs), len(runs) - len(pending), len(pending), args.jobs))
+
+    # The workers only wait on their simulation process
+    failed = 0
+    with concurrent.futures.ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        futures = [pool.submit(run_one, args, run) for run in pending]
+        for future in concurrent.futures.as_completed(futures):
+            run_id, status = future.result()
+            if status != 'done':
+                failed += 1
+            print('run %5d %s' % (run_id, status))
+
+    merged = merge(args, runs)
+    print('%d runs merged into %s, %d failed (run the sweep again to retry)' % (merged, args.output, failed))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,147 @@
+#include "AsyncTraceWriter.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Bytes taken from the pipe at once
+#define READ_CHUNK 65536
+// Pipe capacity asked for, the kernel default is 64 KiB
+#define PIPE_BYTES (1 << 20)
+
+AsyncTraceWriter::AsyncTraceWriter(size_t bufferBytes)
+    : bufferBytes(bufferBytes > 0 ? bufferBytes : 1), readFd(-1), writeFd(-1), fileFd(-1),
+      bytesIn(0), bytesOut(0), linesDropped(0) {}
+
+AsyncTraceWriter::~AsyncTraceWriter() {
+    close();
+}
+
+std::string AsyncTraceWriter::open(const std::string& path, Filter filter) {
+    close();
+    fileFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fileFd < 0) {
+        std::cerr << "Could not open " << path << ": " << strerror(errno) << std::endl;
+        return "";
+    }
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        std::cerr << "Could not create the pipe of " << path << ": " << strerror(errno) << std::endl;
+        ::close(fileFd);
+        fileFd = -1;
+        return "";
+    }
+    readFd = fds[0];
+    writeFd = fds[1];
+#ifdef F_SETPIPE_SZ
+    // Best effort, limited by /proc/sys/fs/pipe-max-size
+    fcntl(writeFd, F_SETPIPE_SZ, PIPE_BYTES);
+#endif
+    this->filter = filter;
+    out.reserve(bufferBytes + READ_CHUNK);
+    partial.clear();
+    bytesIn = 0;
+    bytesOut = 0;
+    linesDropped = 0;
+    writer = std::thread(&AsyncTraceWriter::run, this);
+    return "/dev/fd/" + std::to_string(writeFd);
+}
+
+bool AsyncTraceWriter::isOpen() const { return writer.joinable(); }
+
+void AsyncTraceWriter::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    // The thread sees the end of the pipe once the library closed its end too
+    ::close(writeFd);
+    writeFd = -1;
+    writer.join();
+    ::close(readFd);
+    readFd = -1;
+    if (fileFd >= 0) {
+        ::close(fileFd);
+        fileFd = -1;
+    }
+}
+
+void AsyncTraceWriter::run() {
+    std::vector<char> chunk(READ_CHUNK);
+    for (;;) {
+        ssize_t n = read(readFd, chunk.data(), chunk.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        bytesIn += n;
+        if (!filter) {
+            out.append(chunk.data(), n);
+        } else {
+            const char* p = chunk.data();
+            const char* end = p + n;
+            while (p < end) {
+                const char* newline = static_cast<const char*>(memchr(p, '\n', end - p));
+                if (!newline) {
+                    partial.append(p, end - p);
+                    break;
+                }
+                if (partial.empty()) {
+                    keep(p, newline - p);
+                } else {
+                    partial.append(p, newline - p);
+                    keep(partial.data(), partial.size());
+                    partial.clear();
+                }
+                p = newline + 1;
+            }
+        }
+        if (out.size() >= bufferBytes) {
+            drain();
+        }
+    }
+    // A last line without '\n' is kept as it is
+    out += partial;
+    partial.clear();
+    drain();
+}
+
+void AsyncTraceWriter::keep(const char* line, size_t length) {
+    if (!filter(line, length)) {
+        linesDropped++;
+        return;
+    }
+    out.append(line, length);
+    out += '\n';
+}
+
+void AsyncTraceWriter::drain() {
+    const char* p = out.data();
+    size_t left = out.size();
+    while (left > 0 && fileFd >= 0) {
+        ssize_t n = write(fileFd, p, left);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // Keep draining the pipe so the simulation does not block
+            std::cerr << "Trace write failed: " << strerror(errno) << ", dropping the rest" << std::endl;
+            ::close(fileFd);
+            fileFd = -1;
+            break;
+        }
+        p += n;
+        left -= n;
+        bytesOut += n;
+    }
+    out.clear();
+}
+
+uint64_t AsyncTraceWriter::getBytesIn() const { return bytesIn; }
+
+uint64_t AsyncTraceWriter::getBytesOut() const { return bytesOut; }
+
+uint64_t AsyncTraceWriter::getLinesDropped() const { return linesDropped; }
@@ -0,0 +1,67 @@
+#ifndef ASYNCTRACEWRITER_H
+#define ASYNCTRACEWRITER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+/*
+ * Background writer for the trace files of libraries that write through
+ * their own FILE* (NetAnim).
+ *
+ * open() creates a pipe and returns a /dev/fd path of its write end, to be
+ * handed to the library as its output file name. A writer thread drains
+ * the pipe, splits it into lines, passes every complete line through the
+ * optional filter and appends the kept ones to the real file in blocks of
+ * bufferBytes, so the simulation thread only formats the trace and blocks
+ * when the writer falls a whole pipe behind.
+ *
+ * The filter runs on the writer thread: it must only read state that is
+ * not changed while the writer is open.
+ */
+class AsyncTraceWriter {
+public:
+    // Keep the line (without its '\n')?
+    typedef std::function<bool(const char* line, size_t length)> Filter;
+
+    explicit AsyncTraceWriter(size_t bufferBytes = 1 << 20);
+    ~AsyncTraceWriter();
+
+    AsyncTraceWriter(const AsyncTraceWriter&) = delete;
+    AsyncTraceWriter& operator=(const AsyncTraceWriter&) = delete;
+
+    // Path for the library, empty when path or the pipe could not be
+    // opened. The library must open it before close()
+    std::string open(const std::string& path, Filter filter = Filter());
+    bool isOpen() const;
+
+    // Drain the pipe, write the rest and join the thread. The library must
+    // have closed its file, otherwise this waits for it
+    void close();
+
+    uint64_t getBytesIn() const;      // Written by the library
+    uint64_t getBytesOut() const;     // Written to the file
+    uint64_t getLinesDropped() const; // By the filter
+
+private:
+    void run();
+    void keep(const char* line, size_t length);
+    void drain();
+
+    size_t bufferBytes;
+    std::string out;        // Kept lines not written yet
+    std::string partial;    // Incomplete last line of a read
+    Filter filter;
+    int readFd;
+    int writeFd;
+    int fileFd;
+    std::thread writer;
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+    std::atomic<uint64_t> linesDropped;
+};
+
+#endif // ASYNCTRACEWRITER_H
@@ -0,0 +1,328 @@
+#include "PcapCapture.h"
+#include "../parser/ScenarioDocument.h"
+#include "ns3/callback.h"
+#include "ns3/energy-source-container.h"
+#include "ns3/radiotap-header.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+
+namespace {
+
+// Radiotap fields of a frame sent now, the legacy subset of
+// WifiPhyHelper::GetRadiotapHeader
+RadiotapHeader radiotapHeader(uint16_t channelFreqMhz, const WifiTxVector& txVector, uint16_t staId) {
+    RadiotapHeader header;
+    header.SetTsft(Simulator::Now().GetMicroSeconds());
+
+    // The sniffed frames include the FCS
+    uint8_t frameFlags = RadiotapHeader::FRAME_FLAG_FCS_INCLUDED;
+    if (txVector.GetPreambleType() == WIFI_PREAMBLE_SHORT) {
+        frameFlags |= RadiotapHeader::FRAME_FLAG_SHORT_PREAMBLE;
+    }
+    if (txVector.GetGuardInterval() == 400) {
+        frameFlags |= RadiotapHeader::FRAME_FLAG_SHORT_GUARD;
+    }
+    header.SetFrameFlags(frameFlags);
+
+    // Rate in 500 kbps units
+    WifiModulationClass modulation = txVector.GetMode(staId).GetModulationClass();
+    uint64_t rate = 0;
+    if (modulation != WIFI_MOD_CLASS_HT && modulation != WIFI_MOD_CLASS_VHT && modulation != WIFI_MOD_CLASS_HE) {
+        rate = txVector.GetMode(staId).GetDataRate(txVector.GetChannelWidth(), txVector.GetGuardInterval(), 1) *
+               txVector.GetNss(staId) / 500000;
+        header.SetRate(static_cast<uint8_t>(rate));
+    }
+    uint16_t channelFlags = 0;
+    if (rate == 2 || rate == 4 || rate == 10 || rate == 22) {
+        channelFlags |= RadiotapHeader::CHANNEL_FLAG_CCK;
+    } else {
+        channelFlags |= RadiotapHeader::CHANNEL_FLAG_OFDM;
+    }
+    channelFlags |= channelFreqMhz < 2500 ? RadiotapHeader::CHANNEL_FLAG_SPECTRUM_2GHZ
+                                          : RadiotapHeader::CHANNEL_FLAG_SPECTRUM_5GHZ;
+    header.SetChannelFrequencyAndFlags(channelFreqMhz, channelFlags);
+    return header;
+}
+
+} // namespace
+
+PcapCapture::PcapCapture(DroneFleet& droneFleet)
+    : fleet(droneFleet), config(Config{OFF, {}, Seconds(0), Seconds(0), 128, 1 << 20, Seconds(1), Seconds(10), 10,
+                                       Seconds(1)}),
+      ringUsed(0), dumped(false), captured(0), evicted(0), suppressed(0), dumps(0), framesWritten(0) {}
+
+bool PcapCapture::parse(const std::string& name, Mode& mode) {
+    if (name == "off") {
+        mode = OFF;
+    } else if (name == "full") {
+        mode = FULL;
+    } else if (name == "ring") {
+        mode = RING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string PcapCapture::name(Mode mode) {
+    switch (mode) {
+    case OFF:
+        return "off";
+    case FULL:
+        return "full";
+    case RING:
+        return "ring";
+    }
+    return "";
+}
+
+PcapCapture::Config PcapCapture::configFrom(const ScenarioDocument& scenario, Mode mode) {
+    Config config;
+    config.mode = mode;
+    config.start = Seconds(scenario.getDouble("PcapStart", 0));
+    config.stop = Seconds(scenario.getDouble("PcapStop", 0));
+    config.snapLength = static_cast<uint32_t>(std::max(1.0, scenario.getDouble("PcapSnapLength", 128)));
+    config.ringBytes = static_cast<size_t>(std::max(0.0, scenario.getDouble("PcapRingBytes", 1 << 20)));
+    config.postTrigger = Seconds(scenario.getDouble("PcapPostTrigger", 1));
+    config.holdoff = Seconds(scenario.getDouble("PcapHoldoff", 10));
+    config.burstDrops = static_cast<uint32_t>(std::max(1.0, scenario.getDouble("PcapBurstDrops", 10)));
+    config.burstWindow = Seconds(scenario.getDouble("PcapBurstWindow", 1));
+
+    const rapidjson::Document& document = scenario.getDocument();
+    if (!document.IsObject()) {
+        return config;
+    }
+    rapidjson::Value::ConstMemberIterator it = document.FindMember("PcapNodes");
+    if (it == document.MemberEnd() || !it->value.IsArray()) {
+        return config;
+    }
+    for (rapidjson::SizeType i = 0; i < it->value.Size(); i++) {
+        if (!it->value[i].IsUint()) {
+            std::cerr << "Skipping malformed entry " << i << " of PcapNodes" << std::endl;
+            continue;
+        }
+        config.nodes.push_back(it->value[i].GetUint());
+    }
+    return config;
+}
+
+void PcapCapture::setPredicate(Predicate framePredicate) {
+    predicate = framePredicate;
+}
+
+void PcapCapture::install(const Config& pcapConfig, YansWifiPhyHelper& phy, const std::string& filePrefix,
+                          const NetDeviceContainer& netDevices) {
+    config = pcapConfig;
+    prefix = filePrefix;
+    if (config.mode == OFF) {
+        return;
+    }
+    std::vector<Handle> handles;    // By node id
+    for (Handle handle = 0; handle < fleet.size(); ++handle) {
+        uint32_t node = fleet.get(handle).getNode()->GetId();
+        if (node >= handles.size()) {
+            handles.resize(node + 1, fleet.size());
+        }
+        handles[node] = handle;
+    }
+    // Only the captured drones trigger
+    batteryDone.assign(fleet.size(), true);
+
+    for (uint32_t i = 0; i < netDevices.GetN(); i++) {
+        Ptr<NetDevice> netDevice = netDevices.Get(i);
+        uint32_t node = netDevice->GetNode()->GetId();
+        if (!config.nodes.empty() && std::find(config.nodes.begin(), config.nodes.end(), node) == config.nodes.end()) {
+            continue;
+        }
+        if (config.mode == FULL) {
+            phy.EnablePcap(prefix, netDevice);
+            continue;
+        }
+        Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice>(netDevice);
+        if (!wifiDevice) {
+            continue;
+        }
+        uint32_t index = devices.size();
+        Handle handle = node < handles.size() ? handles[node] : fleet.size();
+        devices.push_back(Device{node, netDevice->GetIfIndex(), handle, Seconds(0), 0});
+        Ptr<WifiPhy> wifiPhy = wifiDevice->GetPhy();
+        wifiPhy->TraceConnectWithoutContext("MonitorSnifferTx", MakeCallback(&PcapCapture::sniffTx, this).Bind(index));
+        wifiPhy->TraceConnectWithoutContext("MonitorSnifferRx", MakeCallback(&PcapCapture::sniffRx, this).Bind(index));
+        wifiPhy->TraceConnectWithoutContext("PhyRxDrop", MakeCallback(&PcapCapture::rxDrop, this).Bind(index));
+        // Payloads failing to decode (a collision on Yans) never reach PhyRxDrop
+        wifiPhy->GetState()->TraceConnectWithoutContext("RxError",
+                                                        MakeCallback(&PcapCapture::rxError, this).Bind(index));
+
+        // Depletion of the battery of a captured drone
+        if (handle == fleet.size()) {
+            continue;
+        }
+        batteryDone[handle] = false;
+        Ptr<EnergySourceContainer> sources = netDevice->GetNode()->GetObject<EnergySourceContainer>();
+        if (!sources || sources->GetN() == 0) {
+            continue;
+        }
+        Ptr<BatteryMonitor> monitor = CreateObject<BatteryMonitor>();
+        monitor->SetEnergySource(sources->Get(0));
+        sources->Get(0)->AppendDeviceEnergyModel(monitor);
+        monitor->SetDepletionCallback(MakeCallback(&PcapCapture::depleted, this).Bind(handle));
+        monitors.push_back(monitor);
+    }
+    if (config.mode == RING) {
+        // The batteries rarely reach their cutoff before the drones used
+        // the energy they are given
+        fleet.setExhaustedCallback(MakeCallback(&PcapCapture::depleted, this));
+        std::ofstream(prefix + "-dumps.txt", std::ios::trunc);
+    }
+}
+
+bool PcapCapture::capturing() const {
+    Time now = Simulator::Now();
+    return now >= config.start && (config.stop.IsZero() || now < config.stop);
+}
+
+void PcapCapture::sniffTx(uint32_t device, Ptr<const Packet> packet, uint16_t channelFreqMhz, WifiTxVector txVector,
+                          MpduInfo aMpdu, uint16_t staId) {
+    if (!capturing()) {
+        return;
+    }
+    keep(device, packet, radiotapHeader(channelFreqMhz, txVector, staId), true);
+}
+
+void PcapCapture::sniffRx(uint32_t device, Ptr<const Packet> packet, uint16_t channelFreqMhz, WifiTxVector txVector,
+                          MpduInfo aMpdu, SignalNoiseDbm signalNoise, uint16_t staId) {
+    if (!capturing()) {
+        return;
+    }
+    RadiotapHeader header = radiotapHeader(channelFreqMhz, txVector, staId);
+    header.SetAntennaSignalPower(signalNoise.signal);
+    header.SetAntennaNoisePower(signalNoise.noise);
+    keep(device, packet, header, false);
+}
+
+void PcapCapture::keep(uint32_t device, Ptr<const Packet> packet, const Header& radiotap, bool tx) {
+    // The fragment shares the buffer of the packet until the header is added
+    Ptr<Packet> data = packet->CreateFragment(0, std::min(packet->GetSize(), config.snapLength));
+    data->AddHeader(radiotap);
+    ring.push_back(Frame{Simulator::Now(), device, data});
+    ringUsed += data->GetSize();
+    captured++;
+    while (ringUsed > config.ringBytes && !ring.empty()) {
+        ringUsed -= ring.front().data->GetSize();
+        ring.pop_front();
+        evicted++;
+    }
+    if (predicate && predicate(devices[device].node, packet, tx)) {
+        trigger("predicate");
+    }
+}
+
+void PcapCapture::rxDrop(uint32_t device, Ptr<const Packet> packet, WifiPhyRxfailureReason reason) {
+    // Collisions and header decoding failures, not the frames out of range
+    // or cut by a transmission of the device itself
+    switch (reason) {
+    case RXING:
+    case BUSY_DECODING_PREAMBLE:
+    case L_SIG_FAILURE:
+    case HT_SIG_FAILURE:
+    case SIG_A_FAILURE:
+    case SIG_B_FAILURE:
+    case U_SIG_FAILURE:
+    case EHT_SIG_FAILURE:
+    case PREAMBLE_DETECTION_PACKET_SWITCH:
+    case FRAME_CAPTURE_PACKET_SWITCH:
+        break;
+    default:
+        return;
+    }
+    countLoss(device);
+}
+
+void PcapCapture::rxError(uint32_t device, Ptr<const Packet> packet, double snr) {
+    countLoss(device);
+}
+
+void PcapCapture::countLoss(uint32_t device) {
+    if (!capturing()) {
+        return;
+    }
+    Device& d = devices[device];
+    Time now = Simulator::Now();
+    if (d.drops == 0 || now - d.windowStart > config.burstWindow) {
+        d.windowStart = now;
+        d.drops = 0;
+    }
+    if (++d.drops == config.burstDrops) {
+        trigger("loss burst");
+    }
+}
+
+void PcapCapture::depleted(Handle handle) {
+    if (batteryDone[handle]) {
+        return;
+    }
+    batteryDone[handle] = true;
+    trigger("battery");
+}
+
+void PcapCapture::trigger(const std::string& reason) {
+    if (config.mode != RING) {
+        return;
+    }
+    reasons[reason]++;
+    Time now = Simulator::Now();
+    if (pendingDump.IsRunning() || (dumped && now - lastDump < config.holdoff)) {
+        suppressed++;
+        return;
+    }
+    pendingReason = reason;
+    pendingDump = Simulator::Schedule(config.postTrigger, &PcapCapture::dump, this);
+}
+
+void PcapCapture::dump() {
+    std::vector<Ptr<PcapFileWrapper>> files(devices.size());
+    PcapHelper pcapHelper;
+    std::string base = prefix + "-dump" + std::to_string(dumps);
+    for (const Frame& frame : ring) {
+        Ptr<PcapFileWrapper>& file = files[frame.device];
+        if (!file) {
+            const Device& d = devices[frame.device];
+            file = pcapHelper.CreateFile(base + "-" + std::to_string(d.node) + "-" + std::to_string(d.index) + ".pcap",
+                                         std::ios::out, PcapHelper::DLT_IEEE802_11_RADIO);
+        }
+        file->Write(frame.time, frame.data);
+    }
+    std::ofstream log(prefix + "-dumps.txt", std::ios::app);
+    log << base << ": " << pendingReason << " at " << (Simulator::Now() - config.postTrigger).GetSeconds() << " s, "
+        << ring.size() << " frames from " << (ring.empty() ? 0 : ring.front().time.GetSeconds()) << " s" << std::endl;
+
+    framesWritten += ring.size();
+    dumps++;
+    ring.clear();
+    ringUsed = 0;
+    lastDump = Simulator::Now();
+    dumped = true;
+}
+
+void PcapCapture::report(std::ostream& os) const {
+    os << "Pcap: " << name(config.mode);
+    if (config.mode == RING) {
+        os << " (" << config.ringBytes / 1024 << " KiB, " << config.snapLength << " B snap) on " << devices.size()
+           << " devices; " << captured << " frames captured, " << evicted << " evicted; triggers";
+        if (reasons.empty()) {
+            os << " none";
+        }
+        for (const auto& reason : reasons) {
+            os << " " << reason.first << " " << reason.second;
+        }
+        os << " (" << suppressed << " held off); " << dumps << " dumps, " << framesWritten << " frames written";
+    }
+    os << std::endl;
+}
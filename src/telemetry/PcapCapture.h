@@ -0,0 +1,148 @@
+#ifndef PCAPCAPTURE_H
+#define PCAPCAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/event-id.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/phy-entity.h"
+#include "ns3/ptr.h"
+#include "ns3/wifi-phy-common.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/yans-wifi-helper.h"
+#include "../drone/DroneFleet.h"
+#include "../energy/battery-monitor.h"
+
+class ScenarioDocument;
+
+/*
+ * PCAP capture of the Wi-Fi cell of this rank.
+ *
+ *  - OFF: nothing is captured.
+ *  - FULL: EnablePcap on every selected device, one radiotap file per
+ *    device for the whole run (the former output).
+ *  - RING: the frames the selected devices send and receive within
+ *    [Start, Stop) are cut to SnapLength bytes and kept in memory, the
+ *    oldest dropped beyond RingBytes. The ring is only written out on a
+ *    trigger: a captured drone battery depleted or its energy used up, a
+ *    burst of BurstDrops frames lost on one device within BurstWindow
+ *    (dropped on a collision or a failed header, or with a payload that
+ *    failed to decode; not out of range or cut by its own transmission),
+ *    the predicate accepting a captured frame, or trigger(). The dump waits
+ *    PostTrigger to include what follows the event, and no dump starts
+ *    within Holdoff of the previous one.
+ *
+ * A dump writes <prefix>-dump<k>-<node>-<device>.pcap for every device
+ * with frames in the ring and a line to <prefix>-dumps.txt. The radiotap
+ * header of the ring frames holds the TSFT, flags, legacy rate, channel
+ * and RX signal/noise (no HT/VHT/HE MCS fields), and the records carry
+ * the cut length.
+ */
+class PcapCapture {
+public:
+    typedef DroneFleet::Handle Handle;
+
+    enum Mode { OFF, FULL, RING };
+
+    struct Config {
+        Mode mode;
+        std::vector<uint32_t> nodes;    // Node ids captured, every device when empty
+        ns3::Time start;
+        ns3::Time stop;                 // Zero for the end of the run
+        uint32_t snapLength;            // Bytes kept of every frame
+        size_t ringBytes;
+        ns3::Time postTrigger;
+        ns3::Time holdoff;
+        uint32_t burstDrops;            // Lost frames of a burst
+        ns3::Time burstWindow;
+    };
+
+    // Should the frame node sent (tx) or received trigger a dump?
+    typedef std::function<bool(uint32_t node, ns3::Ptr<const ns3::Packet> packet, bool tx)> Predicate;
+
+    explicit PcapCapture(DroneFleet& fleet);
+
+    // "off", "full" or "ring"
+    static bool parse(const std::string& name, Mode& mode);
+    static std::string name(Mode mode);
+
+    // Scenario "PcapNodes" (node ids), "PcapStart" and "PcapStop" (s, 0),
+    // "PcapSnapLength" (bytes, 128), "PcapRingBytes" (1 MiB),
+    // "PcapPostTrigger" (s, 1), "PcapHoldoff" (s, 10), "PcapBurstDrops"
+    // (10) and "PcapBurstWindow" (s, 1)
+    static Config configFrom(const ScenarioDocument& scenario, Mode mode);
+
+    void setPredicate(Predicate predicate);
+
+    // Capture the selected Wi-Fi devices, files named after prefix
+    void install(const Config& config, ns3::YansWifiPhyHelper& phy, const std::string& prefix,
+                 const ns3::NetDeviceContainer& devices);
+
+    // Dump the ring after PostTrigger, unless a dump is pending or held off
+    void trigger(const std::string& reason);
+
+    // Prints the frames captured, the triggers and the dumps
+    void report(std::ostream& os) const;
+
+private:
+    struct Device {
+        uint32_t node;
+        uint32_t index;             // Device index on the node
+        Handle handle;              // Drone of the node, fleet.size() for the AP
+        ns3::Time windowStart;      // Of the drop burst window
+        uint32_t drops;
+    };
+
+    struct Frame {
+        ns3::Time time;
+        uint32_t device;
+        ns3::Ptr<ns3::Packet> data; // Radiotap header and cut frame
+    };
+
+    bool capturing() const;
+    void sniffTx(uint32_t device, ns3::Ptr<const ns3::Packet> packet, uint16_t channelFreqMhz,
+                 ns3::WifiTxVector txVector, ns3::MpduInfo aMpdu, uint16_t staId);
+    void sniffRx(uint32_t device, ns3::Ptr<const ns3::Packet> packet, uint16_t channelFreqMhz,
+                 ns3::WifiTxVector txVector, ns3::MpduInfo aMpdu, ns3::SignalNoiseDbm signalNoise,
+                 uint16_t staId);
+    void keep(uint32_t device, ns3::Ptr<const ns3::Packet> packet, const ns3::Header& radiotap, bool tx);
+    void rxDrop(uint32_t device, ns3::Ptr<const ns3::Packet> packet, ns3::WifiPhyRxfailureReason reason);
+    void rxError(uint32_t device, ns3::Ptr<const ns3::Packet> packet, double snr);
+    // A frame lost on device, counted towards its burst
+    void countLoss(uint32_t device);
+    void depleted(Handle handle);
+    void dump();
+
+    DroneFleet& fleet;
+    Config config;
+    std::string prefix;
+    Predicate predicate;
+    std::vector<Device> devices;
+    std::vector<bool> batteryDone;  // Battery trigger fired or not captured, per drone
+    std::vector<ns3::Ptr<ns3::BatteryMonitor>> monitors;
+
+    std::deque<Frame> ring;
+    size_t ringUsed;                // Bytes
+    ns3::EventId pendingDump;
+    std::string pendingReason;
+    ns3::Time lastDump;
+    bool dumped;
+
+    uint64_t captured;
+    uint64_t evicted;
+    uint64_t suppressed;            // Triggers pending or held off
+    uint64_t dumps;
+    uint64_t framesWritten;
+    std::map<std::string, uint64_t> reasons;
+};
+
+#endif // PCAPCAPTURE_H
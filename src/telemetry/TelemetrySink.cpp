@@ -0,0 +1,243 @@
+#include "TelemetrySink.h"
+#include "ns3/simulator.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Rows the column files are grown by when full
+#define INITIAL_CAPACITY 65536
+
+bool parseTextRecord(const char* data, size_t length, TelemetryRecord& record) {
+    // Payload is NUL terminated by DroneLogic, do not trust it blindly
+    std::string text(data, strnlen(data, length));
+    const char* p = text.c_str();
+    char* end = nullptr;
+    double values[18];
+
+    for (int i = 0; i < 18; i++) {
+        values[i] = strtod(p, &end);
+        if (end == p) {
+            return false;
+        }
+        p = end;
+        // Time is printed as "+1e+09ns"
+        while (*p != '\0' && *p != ' ') {
+            p++;
+        }
+    }
+
+    record.droneId = static_cast<uint32_t>(values[0]);
+    record.x = values[1];
+    record.y = values[2];
+    record.z = values[3];
+    record.energyConsumed = values[4];
+    record.time = values[5] * 1e-9;
+    for (int i = 0; i < 6; i++) {
+        record.aoi[i] = values[6 + i];
+    }
+    record.current = values[12];
+    record.percentage = values[13];
+    record.mobilityA = values[14];
+    record.hardwareA = values[15];
+    record.computingA = values[16];
+    record.state = static_cast<int32_t>(values[17]);
+    return true;
+}
+
+TelemetrySink::TelemetrySink(size_t bufferRecords)
+    : bufferRecords(bufferRecords > 0 ? bufferRecords : 1), rows(0), capacity(0), opened(false) {
+    buffer.reserve(this->bufferRecords);
+
+    // Same column names as the old results.csv
+    addColumn("drone_id", "<u4", sizeof(uint32_t), offsetof(TelemetryRecord, droneId));
+    addColumn("x", "<f8", sizeof(double), offsetof(TelemetryRecord, x));
+    addColumn("y", "<f8", sizeof(double), offsetof(TelemetryRecord, y));
+    addColumn("z", "<f8", sizeof(double), offsetof(TelemetryRecord, z));
+    addColumn("battery_usage", "<f8", sizeof(double), offsetof(TelemetryRecord, energyConsumed));
+    addColumn("time", "<f8", sizeof(double), offsetof(TelemetryRecord, time));
+    const char* aoiNames[6] = {"aoi_start_x", "aoi_end_x", "aoi_start_y",
+                               "aoi_end_y", "aoi_start_z", "aoi_end_z"};
+    for (int i = 0; i < 6; i++) {
+        addColumn(aoiNames[i], "<f8", sizeof(double), offsetof(TelemetryRecord, aoi) + i * sizeof(double));
+    }
+    addColumn("current_draw", "<f8", sizeof(double), offsetof(TelemetryRecord, current));
+    addColumn("percentage", "<f8", sizeof(double), offsetof(TelemetryRecord, percentage));
+    addColumn("mobility_ampere", "<f8", sizeof(double), offsetof(TelemetryRecord, mobilityA));
+    addColumn("hardware_ampere", "<f8", sizeof(double), offsetof(TelemetryRecord, hardwareA));
+    addColumn("computing_ampere", "<f8", sizeof(double), offsetof(TelemetryRecord, computingA));
+    addColumn("state", "<i4", sizeof(int32_t), offsetof(TelemetryRecord, state));
+}
+
+TelemetrySink::~TelemetrySink() {
+    close();
+}
+
+void TelemetrySink::addColumn(const std::string& name, const std::string& dtype, size_t width, size_t offset) {
+    columns.push_back(Column{name, dtype, width, offset, -1, nullptr, 0});
+}
+
+bool TelemetrySink::open(const std::string& dir) {
+    close();
+    directory = dir;
+    rows = 0;
+    capacity = 0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Could not create " << directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    for (Column& column : columns) {
+        std::string path = directory + "/" + column.name + ".bin";
+        column.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (column.fd < 0) {
+            std::cerr << "Could not open " << path << ": " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+    }
+    opened = true;
+
+    if (!reserve(INITIAL_CAPACITY)) {
+        close();
+        return false;
+    }
+    writeSchema();
+    return true;
+}
+
+bool TelemetrySink::isOpen() const { return opened; }
+
+bool TelemetrySink::reserve(uint64_t needed) {
+    if (needed <= capacity) {
+        return true;
+    }
+    uint64_t newCapacity = capacity > 0 ? capacity : INITIAL_CAPACITY;
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    for (Column& column : columns) {
+        if (column.map) {
+            munmap(column.map, column.mapped);
+            column.map = nullptr;
+            column.mapped = 0;
+        }
+        size_t bytes = newCapacity * column.width;
+        if (ftruncate(column.fd, bytes) != 0) {
+            std::cerr << "Could not grow " << column.name << ".bin: " << strerror(errno) << std::endl;
+            return false;
+        }
+        void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, column.fd, 0);
+        if (map == MAP_FAILED) {
+            std::cerr << "Could not map " << column.name << ".bin: " << strerror(errno) << std::endl;
+            return false;
+        }
+        column.map = static_cast<char*>(map);
+        column.mapped = bytes;
+    }
+    capacity = newCapacity;
+    return true;
+}
+
+void TelemetrySink::append(const TelemetryRecord& record) {
+    if (!opened) {
+        return;
+    }
+    buffer.push_back(record);
+    if (buffer.size() >= bufferRecords) {
+        flush();
+    }
+}
+
+void TelemetrySink::flush() {
+    if (!opened || buffer.empty()) {
+        return;
+    }
+    if (!reserve(rows + buffer.size())) {
+        // Keep what is already on disk and stop recording
+        std::cerr << "Telemetry flush failed, dropping " << buffer.size() << " records" << std::endl;
+        buffer.clear();
+        close();
+        return;
+    }
+
+    // Transpose the staged rows into the columns
+    for (Column& column : columns) {
+        char* dst = column.map + rows * column.width;
+        for (const TelemetryRecord& record : buffer) {
+            memcpy(dst, reinterpret_cast<const char*>(&record) + column.offset, column.width);
+            dst += column.width;
+        }
+    }
+    // MAP_SHARED pages belong to the page cache, they survive a crash of
+    // the simulator without an explicit msync
+    rows += buffer.size();
+    buffer.clear();
+    writeSchema();
+}
+
+void TelemetrySink::flushEvery(ns3::Time interval) {
+    flushEvent = ns3::Simulator::Schedule(interval, &TelemetrySink::periodicFlush, this, interval);
+}
+
+void TelemetrySink::periodicFlush(ns3::Time interval) {
+    flush();
+    flushEvery(interval);
+}
+
+void TelemetrySink::close() {
+    ns3::Simulator::Cancel(flushEvent);
+    bool wasOpen = opened;
+    if (opened) {
+        flush();
+    }
+    for (Column& column : columns) {
+        if (column.map) {
+            munmap(column.map, column.mapped);
+            column.map = nullptr;
+            column.mapped = 0;
+        }
+        if (column.fd < 0) {
+            continue;
+        }
+        // Drop the unused tail of the reservation
+        if (ftruncate(column.fd, rows * column.width) != 0) {
+            std::cerr << "Could not trim " << column.name << ".bin" << std::endl;
+        }
+        ::close(column.fd);
+        column.fd = -1;
+    }
+    capacity = 0;
+    opened = false;
+    if (wasOpen) {
+        writeSchema();
+    }
+}
+
+uint64_t TelemetrySink::getRowCount() const { return rows; }
+
+void TelemetrySink::writeSchema() const {
+    // Write aside and rename, readers never see a half written schema
+    std::string path = directory + "/schema.txt";
+    std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not write " << path << std::endl;
+        return;
+    }
+    out << "rows " << rows << "\n";
+    for (const Column& column : columns) {
+        out << column.name << " " << column.dtype << "\n";
+    }
+    out.close();
+    std::rename(tmpPath.c_str(), path.c_str());
+}
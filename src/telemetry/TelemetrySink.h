@@ -0,0 +1,92 @@
+#ifndef TELEMETRYSINK_H
+#define TELEMETRYSINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+// One telemetry sample received by the edge server
+struct TelemetryRecord {
+    uint32_t droneId;
+    int32_t state;          // CustomMobilityModel state
+    double x;
+    double y;
+    double z;
+    double energyConsumed;  // Joules
+    double time;            // Seconds
+    double aoi[6];          // xMin xMax yMin yMax zMin zMax
+    double current;         // Total draw (A)
+    double percentage;      // Remaining battery (%)
+    double mobilityA;
+    double hardwareA;
+    double computingA;
+};
+
+// Parse the space separated text payload sent by DroneLogic
+bool parseTextRecord(const char* data, size_t length, TelemetryRecord& record);
+
+/*
+ * Streaming columnar writer for TelemetryRecord.
+ *
+ * Every field is stored in its own memory-mapped file (<dir>/<column>.bin)
+ * as a raw little-endian array, and <dir>/schema.txt holds the row count and
+ * the numpy dtype of every column, so plot.py can np.memmap the columns
+ * without parsing. Records are staged in a bounded buffer and moved into the
+ * mapped columns when it is full or on the periodic flush; the schema is
+ * rewritten on every flush, so a crash loses at most one buffer.
+ */
+class TelemetrySink {
+public:
+    explicit TelemetrySink(size_t bufferRecords = 1024);
+    ~TelemetrySink();
+
+    TelemetrySink(const TelemetrySink&) = delete;
+    TelemetrySink& operator=(const TelemetrySink&) = delete;
+
+    // Create the output directory and the column files
+    bool open(const std::string& directory);
+    bool isOpen() const;
+
+    void append(const TelemetryRecord& record);
+
+    // Move the staged records into the columns and publish the row count
+    void flush();
+
+    // Flush every interval of simulated time until close()
+    void flushEvery(ns3::Time interval);
+
+    // Flush, trim the files to their content and unmap them
+    void close();
+
+    uint64_t getRowCount() const;
+
+private:
+    struct Column {
+        std::string name;
+        std::string dtype;  // numpy dtype string
+        size_t width;
+        size_t offset;      // Offset of the field in TelemetryRecord
+        int fd;
+        char* map;
+        size_t mapped;      // Bytes currently mapped
+    };
+
+    void addColumn(const std::string& name, const std::string& dtype, size_t width, size_t offset);
+    bool reserve(uint64_t rows);
+    void writeSchema() const;
+    void periodicFlush(ns3::Time interval);
+
+    std::string directory;
+    std::vector<Column> columns;
+    std::vector<TelemetryRecord> buffer;
+    size_t bufferRecords;
+    uint64_t rows;
+    uint64_t capacity;  // Rows the mapped files can hold
+    bool opened;
+    ns3::EventId flushEvent;
+};
+
+#endif // TELEMETRYSINK_H
@@ -0,0 +1,164 @@
+#include "drone-telemetry-header.h"
+#include "ns3/log.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("DroneTelemetryHeader");
+
+NS_OBJECT_ENSURE_REGISTERED(DroneTelemetryHeader);
+
+// Size without the optional AoI block
+#define BASE_SIZE 52
+#define AOI_SIZE 24
+
+static void WriteFloat(Buffer::Iterator &i, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    i.WriteHtonU32(bits);
+}
+
+static float ReadFloat(Buffer::Iterator &i) {
+    uint32_t bits = i.ReadNtohU32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TypeId DroneTelemetryHeader::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::DroneTelemetryHeader")
+        .SetParent<Header>()
+        .SetGroupName("Network")
+        .AddConstructor<DroneTelemetryHeader>();
+    return tid;
+}
+
+TypeId DroneTelemetryHeader::GetInstanceTypeId(void) const {
+    return GetTypeId();
+}
+
+DroneTelemetryHeader::DroneTelemetryHeader()
+    : m_version(VERSION), m_flags(0), m_state(0), m_droneId(0), m_timestamp(0),
+      m_position{0, 0, 0}, m_energyConsumed(0), m_percentage(0), m_current(0),
+      m_mobilityA(0), m_hardwareA(0), m_computingA(0), m_aoi{0, 0, 0, 0, 0, 0} {}
+
+void DroneTelemetryHeader::Print(std::ostream &os) const {
+    os << "v" << (uint32_t)m_version << " drone=" << m_droneId << " state=" << (uint32_t)m_state
+       << " t=" << m_timestamp << "ns pos=(" << m_position[0] << "," << m_position[1] << ","
+       << m_position[2] << ") energy=" << m_energyConsumed << "J battery=" << m_percentage
+       << "% current=" << m_current << "A";
+    if (HasAoI()) {
+        os << " aoi=" << m_aoi[0] << "|" << m_aoi[1] << "|" << m_aoi[2] << "|" << m_aoi[3]
+           << "|" << m_aoi[4] << "|" << m_aoi[5];
+    }
+}
+
+uint32_t DroneTelemetryHeader::GetSerializedSize(void) const {
+    return GetSizeForFlags(m_flags);
+}
+
+uint32_t DroneTelemetryHeader::GetSizeForFlags(uint8_t flags) {
+    return BASE_SIZE + ((flags & FLAG_AOI) ? AOI_SIZE : 0);
+}
+
+void DroneTelemetryHeader::Serialize(Buffer::Iterator start) const {
+    Buffer::Iterator i = start;
+    i.WriteU8(m_version);
+    i.WriteU8(m_flags);
+    i.WriteU8(m_state);
+    i.WriteU8(0);
+    i.WriteHtonU32(m_droneId);
+    i.WriteHtonU64(m_timestamp);
+    for (int k = 0; k < 3; k++) {
+        WriteFloat(i, m_position[k]);
+    }
+    WriteFloat(i, m_energyConsumed);
+    WriteFloat(i, m_percentage);
+    WriteFloat(i, m_current);
+    WriteFloat(i, m_mobilityA);
+    WriteFloat(i, m_hardwareA);
+    WriteFloat(i, m_computingA);
+    if (HasAoI()) {
+        for (int k = 0; k < 6; k++) {
+            WriteFloat(i, m_aoi[k]);
+        }
+    }
+}
+
+uint32_t DroneTelemetryHeader::Deserialize(Buffer::Iterator start) {
+    Buffer::Iterator i = start;
+    m_version = i.ReadU8();
+    if (m_version != VERSION) {
+        NS_LOG_WARN("Unknown telemetry version " << (uint32_t)m_version);
+        return 0;
+    }
+    m_flags = i.ReadU8();
+    m_state = i.ReadU8();
+    i.ReadU8();
+    m_droneId = i.ReadNtohU32();
+    m_timestamp = i.ReadNtohU64();
+    for (int k = 0; k < 3; k++) {
+        m_position[k] = ReadFloat(i);
+    }
+    m_energyConsumed = ReadFloat(i);
+    m_percentage = ReadFloat(i);
+    m_current = ReadFloat(i);
+    m_mobilityA = ReadFloat(i);
+    m_hardwareA = ReadFloat(i);
+    m_computingA = ReadFloat(i);
+    if (HasAoI()) {
+        for (int k = 0; k < 6; k++) {
+            m_aoi[k] = ReadFloat(i);
+        }
+    }
+    return i.GetDistanceFrom(start);
+}
+
+void DroneTelemetryHeader::SetDroneId(uint32_t id) { m_droneId = id; }
+void DroneTelemetryHeader::SetState(uint8_t state) { m_state = state; }
+void DroneTelemetryHeader::SetTimestamp(Time timestamp) { m_timestamp = timestamp.GetNanoSeconds(); }
+
+void DroneTelemetryHeader::SetPosition(const Vector &position) {
+    m_position[0] = position.x;
+    m_position[1] = position.y;
+    m_position[2] = position.z;
+}
+
+void DroneTelemetryHeader::SetEnergyConsumed(double joules) { m_energyConsumed = joules; }
+void DroneTelemetryHeader::SetPercentage(double percentage) { m_percentage = percentage; }
+
+void DroneTelemetryHeader::SetCurrents(double current, double mobilityA, double hardwareA, double computingA) {
+    m_current = current;
+    m_mobilityA = mobilityA;
+    m_hardwareA = hardwareA;
+    m_computingA = computingA;
+}
+
+void DroneTelemetryHeader::SetAoI(const Box &aoi) {
+    m_aoi[0] = aoi.xMin;
+    m_aoi[1] = aoi.xMax;
+    m_aoi[2] = aoi.yMin;
+    m_aoi[3] = aoi.yMax;
+    m_aoi[4] = aoi.zMin;
+    m_aoi[5] = aoi.zMax;
+    m_flags |= FLAG_AOI;
+}
+
+uint8_t DroneTelemetryHeader::GetVersion(void) const { return m_version; }
+uint32_t DroneTelemetryHeader::GetDroneId(void) const { return m_droneId; }
+uint8_t DroneTelemetryHeader::GetState(void) const { return m_state; }
+Time DroneTelemetryHeader::GetTimestamp(void) const { return NanoSeconds(m_timestamp); }
+Vector DroneTelemetryHeader::GetPosition(void) const { return Vector(m_position[0], m_position[1], m_position[2]); }
+double DroneTelemetryHeader::GetEnergyConsumed(void) const { return m_energyConsumed; }
+double DroneTelemetryHeader::GetPercentage(void) const { return m_percentage; }
+double DroneTelemetryHeader::GetCurrent(void) const { return m_current; }
+double DroneTelemetryHeader::GetMobilityA(void) const { return m_mobilityA; }
+double DroneTelemetryHeader::GetHardwareA(void) const { return m_hardwareA; }
+double DroneTelemetryHeader::GetComputingA(void) const { return m_computingA; }
+bool DroneTelemetryHeader::HasAoI(void) const { return (m_flags & FLAG_AOI) != 0; }
+
+Box DroneTelemetryHeader::GetAoI(void) const {
+    return Box(m_aoi[0], m_aoi[1], m_aoi[2], m_aoi[3], m_aoi[4], m_aoi[5]);
+}
+
+} // namespace ns3
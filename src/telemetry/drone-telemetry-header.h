@@ -0,0 +1,84 @@
+#ifndef DRONE_TELEMETRY_HEADER_H
+#define DRONE_TELEMETRY_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/box.h"
+
+namespace ns3 {
+
+/*
+ * Packed binary telemetry sent by DroneLogic to the edge server.
+ *
+ * Layout (network byte order, 52 bytes, 76 with the AoI):
+ *   u8 version | u8 flags | u8 state | u8 reserved | u32 droneId
+ *   u64 timestamp (ns)
+ *   f32 x, y, z | f32 energyConsumed (J) | f32 percentage (%)
+ *   f32 current, mobilityA, hardwareA, computingA (A)
+ *   [f32 aoi xMin xMax yMin yMax zMin zMax]   if FLAG_AOI is set
+ *
+ * The AoI never changes during a flight, so drones only attach it now and
+ * then and the edge remembers the last one per drone.
+ */
+class DroneTelemetryHeader : public Header {
+public:
+  static const uint8_t VERSION = 1;
+  static const uint8_t FLAG_AOI = 0x01;
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  DroneTelemetryHeader();
+
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  // Bytes of a header carrying flags. Deserialize trusts the buffer to hold
+  // them, so check the packet size before RemoveHeader
+  static uint32_t GetSizeForFlags(uint8_t flags);
+
+  void SetDroneId(uint32_t id);
+  void SetState(uint8_t state);
+  void SetTimestamp(Time timestamp);
+  void SetPosition(const Vector &position);
+  void SetEnergyConsumed(double joules);
+  void SetPercentage(double percentage);
+  void SetCurrents(double current, double mobilityA, double hardwareA, double computingA);
+  void SetAoI(const Box &aoi);
+
+  uint8_t GetVersion(void) const;
+  uint32_t GetDroneId(void) const;
+  uint8_t GetState(void) const;
+  Time GetTimestamp(void) const;
+  Vector GetPosition(void) const;
+  double GetEnergyConsumed(void) const;
+  double GetPercentage(void) const;
+  double GetCurrent(void) const;
+  double GetMobilityA(void) const;
+  double GetHardwareA(void) const;
+  double GetComputingA(void) const;
+  bool HasAoI(void) const;
+  Box GetAoI(void) const;
+
+private:
+  uint8_t m_version;
+  uint8_t m_flags;
+  uint8_t m_state;
+  uint32_t m_droneId;
+  uint64_t m_timestamp;
+  float m_position[3];
+  float m_energyConsumed;
+  float m_percentage;
+  float m_current;
+  float m_mobilityA;
+  float m_hardwareA;
+  float m_computingA;
+  float m_aoi[6];
+};
+
+} // namespace ns3
+
+#endif // DRONE_TELEMETRY_HEADER_H
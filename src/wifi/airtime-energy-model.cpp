@@ -0,0 +1,224 @@
+#include "airtime-energy-model.h"
+#include "../energy/predictive-battery-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-phy-state-helper.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("WifiAirtimeEnergyModel");
+
+NS_OBJECT_ENSURE_REGISTERED(WifiAirtimeEnergyModel);
+
+TypeId WifiAirtimeEnergyModel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::WifiAirtimeEnergyModel")
+        .SetParent<DeviceEnergyModel>()
+        .SetGroupName("Energy")
+        .AddConstructor<WifiAirtimeEnergyModel>()
+        .AddAttribute("IdleCurrentA",
+                      "The default radio Idle current in Ampere.",
+                      DoubleValue(0.273),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_idleCurrentA),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("CcaBusyCurrentA",
+                      "The default radio CCA Busy State current in Ampere.",
+                      DoubleValue(0.273),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_ccaBusyCurrentA),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("TxCurrentA",
+                      "The radio TX current in Ampere.",
+                      DoubleValue(0.380),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_txCurrentA),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("RxCurrentA",
+                      "The radio RX current in Ampere.",
+                      DoubleValue(0.313),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_rxCurrentA),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("SwitchingCurrentA",
+                      "The default radio Channel Switch current in Ampere.",
+                      DoubleValue(0.273),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_switchingCurrentA),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("SleepCurrentA",
+                      "The radio Sleep current in Ampere.",
+                      DoubleValue(0.033),
+                      MakeDoubleAccessor(&WifiAirtimeEnergyModel::m_sleepCurrentA),
+                      MakeDoubleChecker<double>(0.0));
+    return tid;
+}
+
+WifiAirtimeEnergyModel::WifiAirtimeEnergyModel()
+    : m_idleCurrentA(0.273), m_ccaBusyCurrentA(0.273), m_txCurrentA(0.380), m_rxCurrentA(0.313),
+      m_switchingCurrentA(0.273), m_sleepCurrentA(0.033), m_totalEnergy(0), m_forward(false), m_charge(0),
+      m_current(0), m_owed(0), m_meanWindow(0) {}
+
+void WifiAirtimeEnergyModel::SetPhy(Ptr<WifiPhy> phy) {
+    NS_ASSERT(!m_phy);
+    m_phy = phy;
+    m_phy->GetState()->TraceConnectWithoutContext("State",
+                                                  MakeCallback(&WifiAirtimeEnergyModel::StateLogged, this));
+    // Batteries compute their voltage on their first update only, and the
+    // first states are logged before it. A source charging the interval to
+    // come is charged the state the PHY starts in
+    m_current = GetStateA(m_phy->GetState()->GetState());
+    if (m_source) {
+        m_source->UpdateEnergySource();
+    }
+}
+
+void WifiAirtimeEnergyModel::SetEnergySource(Ptr<EnergySource> source) {
+    m_source = source;
+    m_forward = DynamicCast<PredictiveBatteryModel>(source) != nullptr;
+    m_lastPoll = Simulator::Now();
+}
+
+double WifiAirtimeEnergyModel::GetTotalEnergyConsumption(void) const {
+    return m_totalEnergy;
+}
+
+void WifiAirtimeEnergyModel::ChangeState(int newState) {}
+
+double WifiAirtimeEnergyModel::GetStateA(WifiPhyState state) const {
+    switch (state) {
+    case WifiPhyState::IDLE:
+        return m_idleCurrentA;
+    case WifiPhyState::CCA_BUSY:
+        return m_ccaBusyCurrentA;
+    case WifiPhyState::TX:
+        return m_txCurrentA;
+    case WifiPhyState::RX:
+        return m_rxCurrentA;
+    case WifiPhyState::SWITCHING:
+        return m_switchingCurrentA;
+    case WifiPhyState::SLEEP:
+        return m_sleepCurrentA;
+    default:
+        return 0;
+    }
+}
+
+double WifiAirtimeEnergyModel::GetReportedCurrentA(void) const {
+    return m_current;
+}
+
+double WifiAirtimeEnergyModel::GetOwedCharge(void) const {
+    return m_owed;
+}
+
+void WifiAirtimeEnergyModel::StateLogged(Time start, Time duration, WifiPhyState state) {
+    double current = GetStateA(state);
+    Time end = start + duration;
+    m_totalEnergy += current * duration.GetSeconds() * (m_source ? m_source->GetSupplyVoltage() : 0);
+
+    // Up to the last poll the interval was charged at the state estimated
+    // then, the difference goes to the next poll
+    Time charged = std::min(end, m_lastPoll);
+    Time at = start;
+    while (at < charged && !m_estimated.empty()) {
+        Span& estimate = m_estimated.front();
+        if (estimate.end <= at) {
+            m_estimated.pop_front();
+        } else if (estimate.start > at) {
+            Time next = std::min(estimate.start, charged);
+            m_charge += current * (next - at).GetSeconds();
+            at = next;
+        } else {
+            Time next = std::min(estimate.end, charged);
+            m_charge += (current - estimate.currentA) * (next - at).GetSeconds();
+            at = next;
+            if (estimate.end <= charged) {
+                m_estimated.pop_front();
+            } else {
+                estimate.start = charged;
+            }
+        }
+    }
+    if (at < charged) {
+        m_charge += current * (charged - at).GetSeconds();
+    }
+    // The rest as the polls reach it
+    if (end > m_lastPoll) {
+        m_pending.push_back(Span{std::max(start, m_lastPoll), end, current});
+    }
+    m_loggedUntil = std::max(m_loggedUntil, end);
+}
+
+double WifiAirtimeEnergyModel::SettleCharge(void) const {
+    Time now = Simulator::Now();
+    double charge = m_charge;
+    m_charge = 0;
+    while (!m_pending.empty() && m_pending.front().start < now) {
+        Span& span = m_pending.front();
+        Time end = std::min(span.end, now);
+        charge += span.currentA * (end - span.start).GetSeconds();
+        if (span.end > now) {
+            span.start = now;
+            break;
+        }
+        m_pending.pop_front();
+    }
+    // Not logged yet: the state in progress
+    Time from = std::max(m_loggedUntil, m_lastPoll);
+    if (from < now) {
+        double current = m_phy ? GetStateA(m_phy->GetState()->GetState()) : 0;
+        charge += current * (now - from).GetSeconds();
+        if (!m_estimated.empty() && m_estimated.back().end == from && m_estimated.back().currentA == current) {
+            m_estimated.back().end = now;
+        } else {
+            m_estimated.push_back(Span{from, now, current});
+        }
+    }
+    m_lastPoll = now;
+    return charge;
+}
+
+double WifiAirtimeEnergyModel::DoGetCurrentA(void) const {
+    Time now = Simulator::Now();
+    if (now <= m_lastPoll) {
+        return m_current;
+    }
+    double window = (now - m_lastPoll).GetSeconds();
+    double charge = SettleCharge();
+    double lowest = std::min({m_idleCurrentA, m_ccaBusyCurrentA, m_txCurrentA, m_rxCurrentA, m_switchingCurrentA,
+                              m_sleepCurrentA});
+    double highest = std::max({m_idleCurrentA, m_ccaBusyCurrentA, m_txCurrentA, m_rxCurrentA, m_switchingCurrentA,
+                               m_sleepCurrentA});
+    if (m_forward) {
+        // The previous report was charged over this window, this one is
+        // charged over the next
+        m_owed += charge - m_current * window;
+        m_meanWindow = m_meanWindow > 0 ? 0.875 * m_meanWindow + 0.125 * window : window;
+        m_current = std::clamp(charge / window + m_owed / m_meanWindow, lowest, highest);
+    } else {
+        // Charged over this window, what the state currents cannot cover in
+        // it (a late correction) is carried to the next
+        m_owed += charge;
+        m_current = std::clamp(m_owed / window, lowest, highest);
+        m_owed -= m_current * window;
+    }
+    return m_current;
+}
+
+void WifiAirtimeEnergyModel::HandleEnergyDepletion(void) {
+    // The PHY stays on: the STA MAC switches it off itself once it misses the
+    // AP beacons, and a second SetOffMode is fatal
+    NS_LOG_DEBUG("Energy depleted");
+}
+
+void WifiAirtimeEnergyModel::HandleEnergyRecharged(void) {
+    NS_LOG_DEBUG("Energy recharged");
+}
+
+void WifiAirtimeEnergyModel::HandleEnergyChanged(void) {}
+
+void WifiAirtimeEnergyModel::DoDispose(void) {
+    m_source = nullptr;
+    m_phy = nullptr;
+    DeviceEnergyModel::DoDispose();
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+#ifndef AIRTIME_ENERGY_MODEL_H
+#define AIRTIME_ENERGY_MODEL_H
+
+#include "ns3/device-energy-model.h"
+#include "ns3/energy-source.h"
+#include "ns3/nstime.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-phy-state.h"
+
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * Wi-Fi radio draw charged from the airtime the PHY spent in each state.
+ *
+ * WifiRadioEnergyModel updates the energy source on every PHY state change,
+ * that is a battery recomputation and a rescheduled update event for every
+ * frame every PHY in range hears. Here the "State" trace of the PHY only
+ * records the intervals it logs, and the charge is settled when the energy
+ * source polls the device models. A poll charges exactly the time since the
+ * previous one: the logged intervals are split at the poll, and the time
+ * the PHY has not logged yet (the state in progress) is charged at the
+ * present state, corrected when its interval is logged.
+ *
+ * The current reported depends on how the source integrates it:
+ *  - sources charging the interval since their last update at the current
+ *    polled at its end (GenericBatteryModel, the ns-3 ones): the mean
+ *    current of that interval, the charge is the airtime one.
+ *  - PredictiveBatteryModel, charging the interval to come at the current
+ *    polled at its start: the mean of the last interval plus the charge
+ *    still owed spread over a mean interval, kept within the state
+ *    currents. What the battery has charged trails the airtime by the owed
+ *    charge, GetOwedCharge().
+ * Either way the current stays within the state currents.
+ *
+ * Depletion does not switch the PHY off, like the flight draw it is left to
+ * the battery readings.
+ */
+class WifiAirtimeEnergyModel : public DeviceEnergyModel {
+public:
+  static TypeId GetTypeId(void);
+  WifiAirtimeEnergyModel();
+
+  // Follow the state of the PHY, once
+  void SetPhy(Ptr<WifiPhy> phy);
+
+  void SetEnergySource(Ptr<EnergySource> source) override;
+  double GetTotalEnergyConsumption(void) const override;
+  // The PHY state comes from its trace
+  void ChangeState(int newState) override;
+  void HandleEnergyDepletion(void) override;
+  void HandleEnergyRecharged(void) override;
+  void HandleEnergyChanged(void) override;
+
+  double GetStateA(WifiPhyState state) const;
+  // Current reported on the last poll
+  double GetReportedCurrentA(void) const;
+  // A s of airtime not charged yet to a PredictiveBatteryModel, negative
+  // when overcharged
+  double GetOwedCharge(void) const;
+
+private:
+  // Interval at a given current
+  struct Span {
+    Time start;
+    Time end;
+    double currentA;
+  };
+
+  double DoGetCurrentA(void) const override;
+  void DoDispose(void) override;
+
+  void StateLogged(Time start, Time duration, WifiPhyState state);
+  // Charge (A s) of the time since the last poll, which moves to now
+  double SettleCharge(void) const;
+
+  Ptr<EnergySource> m_source;
+  Ptr<WifiPhy> m_phy;
+  double m_idleCurrentA;
+  double m_ccaBusyCurrentA;
+  double m_txCurrentA;
+  double m_rxCurrentA;
+  double m_switchingCurrentA;
+  double m_sleepCurrentA;
+
+  double m_totalEnergy;            //!< J, up to the last logged state
+  bool m_forward;                  //!< Source charges the interval to come
+  Time m_loggedUntil;              //!< End of the latest logged interval
+  // Logged past the last poll (a TX is logged when it starts), not charged
+  mutable std::deque<Span> m_pending;
+  // Before the last poll, charged at the state then in progress
+  mutable std::deque<Span> m_estimated;
+  mutable double m_charge;         //!< A s owed to the next poll
+  mutable double m_current;        //!< Reported on the last poll
+  mutable double m_owed;           //!< A s the forward source is behind
+  mutable double m_meanWindow;     //!< s between polls, averaged
+  mutable Time m_lastPoll;
+};
+
+} // namespace ns3
+
+#endif // AIRTIME_ENERGY_MODEL_H
@@ -0,0 +1,292 @@
+#include "range-culled-wifi-channel.h"
+#include "ns3/boolean.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("RangeCulledWifiChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(RangeCulledWifiChannel);
+NS_OBJECT_ENSURE_REGISTERED(RangeCulledWifiPhy);
+
+TypeId RangeCulledWifiChannel::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::RangeCulledWifiChannel")
+        .SetParent<YansWifiChannel>()
+        .SetGroupName("Wifi")
+        .AddConstructor<RangeCulledWifiChannel>()
+        .AddAttribute("MaxRange",
+                      "Distance (m) past which no PHY can receive, 0 for unbounded, negative to "
+                      "estimate it from the loss model.",
+                      DoubleValue(-1.0),
+                      MakeDoubleAccessor(&RangeCulledWifiChannel::m_maxRange),
+                      MakeDoubleChecker<double>())
+        .AddAttribute("MaxSpeed",
+                      "Upper bound of the speed of the PHYs (m/s), widens the grid search between refreshes.",
+                      DoubleValue(60.0),
+                      MakeDoubleAccessor(&RangeCulledWifiChannel::m_maxSpeed),
+                      MakeDoubleChecker<double>(0.0))
+        .AddAttribute("GridRefresh",
+                      "Interval between two rebuilds of the position grid.",
+                      TimeValue(Seconds(1)),
+                      MakeTimeAccessor(&RangeCulledWifiChannel::m_refresh),
+                      MakeTimeChecker())
+        .AddAttribute("PowerCulling",
+                      "Skip the PHYs whose rx power is below their sensitivity.",
+                      BooleanValue(true),
+                      MakeBooleanAccessor(&RangeCulledWifiChannel::m_powerCulling),
+                      MakeBooleanChecker());
+    return tid;
+}
+
+RangeCulledWifiChannel::RangeCulledWifiChannel()
+    : m_maxRange(-1.0), m_maxSpeed(60.0), m_refresh(Seconds(1)), m_powerCulling(true), m_devices(0),
+      m_range(0), m_rangeKnown(false), m_scheduled(0), m_outOfRange(0), m_belowSensitivity(0) {}
+
+void RangeCulledWifiChannel::SetPropagationLossModel(const Ptr<PropagationLossModel> loss) {
+    m_loss = loss;
+    YansWifiChannel::SetPropagationLossModel(loss);
+}
+
+void RangeCulledWifiChannel::SetPropagationDelayModel(const Ptr<PropagationDelayModel> delay) {
+    m_delay = delay;
+    YansWifiChannel::SetPropagationDelayModel(delay);
+}
+
+void RangeCulledWifiChannel::SetRangeModel(const Ptr<PropagationLossModel> loss) {
+    m_rangeModel = loss;
+    m_rangeKnown = false;
+}
+
+double RangeCulledWifiChannel::GetRange(void) const {
+    return m_range;
+}
+
+uint64_t RangeCulledWifiChannel::GetScheduled(void) const {
+    return m_scheduled;
+}
+
+uint64_t RangeCulledWifiChannel::GetOutOfRange(void) const {
+    return m_outOfRange;
+}
+
+uint64_t RangeCulledWifiChannel::GetBelowSensitivity(void) const {
+    return m_belowSensitivity;
+}
+
+int64_t RangeCulledWifiChannel::CellKey(int64_t x, int64_t y) const {
+    return (x << 32) ^ (y & 0xffffffff);
+}
+
+void RangeCulledWifiChannel::Refresh(void) const {
+    // PHYs in the order of YansWifiChannel, through their devices
+    if (GetNDevices() != m_devices) {
+        m_devices = GetNDevices();
+        m_phys.clear();
+        std::set<const YansWifiPhy*> seen;
+        for (std::size_t i = 0; i < m_devices; i++) {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(GetDevice(i));
+            if (!device) {
+                continue;
+            }
+            for (const Ptr<WifiPhy>& phy : device->GetPhys()) {
+                Ptr<YansWifiPhy> yans = DynamicCast<YansWifiPhy>(phy);
+                if (yans && yans->GetChannel() == this && seen.insert(PeekPointer(yans)).second) {
+                    m_phys.push_back(yans);
+                }
+            }
+        }
+        m_rangeKnown = false;
+    }
+
+    if (!m_rangeKnown) {
+        m_range = m_maxRange > 0 ? m_maxRange : 0;
+        if (m_maxRange < 0 && !m_phys.empty()) {
+            double txPower = -1e9;
+            double threshold = 1e9;
+            for (const Ptr<YansWifiPhy>& phy : m_phys) {
+                txPower = std::max(txPower, phy->GetTxPowerEnd() + phy->GetTxGain());
+                threshold = std::min(threshold, phy->GetRxSensitivity() - phy->GetRxGain());
+            }
+            m_range = EstimateRange(m_rangeModel ? m_rangeModel : m_loss, txPower, threshold);
+        }
+        m_rangeKnown = true;
+        NS_LOG_INFO("Range " << m_range << " m over " << m_phys.size() << " PHYs");
+    }
+
+    m_cells.clear();
+    m_positions.resize(m_phys.size());
+    for (uint32_t i = 0; i < m_phys.size(); i++) {
+        m_positions[i] = m_phys[i]->GetMobility()->GetPosition();
+        if (m_range > 0) {
+            int64_t x = static_cast<int64_t>(std::floor(m_positions[i].x / m_range));
+            int64_t y = static_cast<int64_t>(std::floor(m_positions[i].y / m_range));
+            m_cells[CellKey(x, y)].push_back(i);
+        }
+    }
+    m_built = Simulator::Now();
+}
+
+bool RangeCulledWifiChannel::CanReceive(Ptr<YansWifiPhy> receiver, double rxPowerDbm, uint16_t width) const {
+    // Same test as Receive
+    return rxPowerDbm + receiver->GetRxGain() >= receiver->GetRxSensitivity() + RatioToDb(width / 20.0);
+}
+
+void RangeCulledWifiChannel::Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const {
+    NS_LOG_FUNCTION(this << sender << ppdu << txPowerDbm);
+    if (m_devices != GetNDevices() || Simulator::Now() - m_built >= m_refresh || m_positions.empty()) {
+        Refresh();
+    }
+    Ptr<MobilityModel> senderMobility = sender->GetMobility();
+    NS_ASSERT(senderMobility);
+    Vector from = senderMobility->GetPosition();
+
+    m_candidates.clear();
+    if (m_range > 0) {
+        // A receiver may have moved since the grid was built
+        double slack = m_maxSpeed * (Simulator::Now() - m_built).GetSeconds();
+        double reach = m_range + slack;
+        int64_t span = static_cast<int64_t>(std::ceil(reach / m_range));
+        int64_t cx = static_cast<int64_t>(std::floor(from.x / m_range));
+        int64_t cy = static_cast<int64_t>(std::floor(from.y / m_range));
+        for (int64_t y = cy - span; y <= cy + span; y++) {
+            for (int64_t x = cx - span; x <= cx + span; x++) {
+                auto cell = m_cells.find(CellKey(x, y));
+                if (cell == m_cells.end()) {
+                    continue;
+                }
+                for (uint32_t i : cell->second) {
+                    if (CalculateDistance(from, m_positions[i]) <= reach) {
+                        m_candidates.push_back(i);
+                    }
+                }
+            }
+        }
+        std::sort(m_candidates.begin(), m_candidates.end());
+        m_outOfRange += m_phys.size() - m_candidates.size();
+    } else {
+        for (uint32_t i = 0; i < m_phys.size(); i++) {
+            m_candidates.push_back(i);
+        }
+    }
+
+    uint16_t width = ppdu->GetTxChannelWidth();
+    for (uint32_t i : m_candidates) {
+        const Ptr<YansWifiPhy>& receiver = m_phys[i];
+        if (receiver == sender || receiver->GetChannelNumber() != sender->GetChannelNumber()) {
+            continue;
+        }
+        Ptr<MobilityModel> receiverMobility = receiver->GetMobility();
+        if (m_range > 0 && !m_powerCulling && CalculateDistance(from, receiverMobility->GetPosition()) > m_range) {
+            m_outOfRange++;
+            continue;
+        }
+        double rxPowerDbm = m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
+        if (m_powerCulling && !CanReceive(receiver, rxPowerDbm, width)) {
+            m_belowSensitivity++;
+            continue;
+        }
+        Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+        Ptr<NetDevice> device = receiver->GetDevice();
+        uint32_t node = device ? device->GetNode()->GetId() : 0xffffffff;
+        Simulator::ScheduleWithContext(node, delay, &RangeCulledWifiChannel::Receive, receiver, ppdu, rxPowerDbm);
+        m_scheduled++;
+    }
+}
+
+void RangeCulledWifiChannel::Receive(Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, double rxPowerDbm) {
+    NS_LOG_FUNCTION(phy << ppdu << rxPowerDbm);
+    uint16_t txWidth = ppdu->GetTxChannelWidth();
+    if ((rxPowerDbm + phy->GetRxGain()) < phy->GetRxSensitivity() + RatioToDb(txWidth / 20.0)) {
+        NS_LOG_INFO("Received signal too weak to process: " << rxPowerDbm << " dBm");
+        return;
+    }
+    RxPowerWattPerChannelBand rxPowerW;
+    rxPowerW.insert({{{0, 0}, {0, 0}}, (DbmToW(rxPowerDbm + phy->GetRxGain()))}); // dummy band for YANS
+    phy->StartReceivePreamble(ppdu, rxPowerW, ppdu->GetTxDuration());
+}
+
+double RangeCulledWifiChannel::EstimateRange(Ptr<PropagationLossModel> loss, double txPowerDbm,
+                                             double thresholdDbm) {
+    if (!loss) {
+        return 0;
+    }
+    Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+    Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+    Vector direction;
+    auto reaches = [&](double distance) {
+        b->SetPosition(Vector(direction.x * distance, direction.y * distance, direction.z * distance));
+        return loss->CalcRxPower(txPowerDbm, a, b) >= thresholdDbm;
+    };
+
+    // Elevation dependent models lose less upwards, keep the longest reach
+    // of a horizontal, a diagonal and a vertical probe
+    const Vector directions[3] = {Vector(1, 0, 0), Vector(M_SQRT1_2, 0, M_SQRT1_2), Vector(0, 0, 1)};
+    double range = 0;
+    for (const Vector& probe : directions) {
+        direction = probe;
+        // Double until out of reach, then bisect
+        double near = 0;
+        double far = 1;
+        while (reaches(far)) {
+            near = far;
+            far *= 2;
+            if (far > 1e5) {
+                return 0;
+            }
+        }
+        for (int i = 0; i < 30 && far - near > 0.01; i++) {
+            double mid = (near + far) / 2;
+            if (reaches(mid)) {
+                near = mid;
+            } else {
+                far = mid;
+            }
+        }
+        range = std::max(range, far);
+    }
+    return range;
+}
+
+void RangeCulledWifiChannel::DoDispose(void) {
+    m_phys.clear();
+    m_cells.clear();
+    m_loss = nullptr;
+    m_delay = nullptr;
+    m_rangeModel = nullptr;
+    YansWifiChannel::DoDispose();
+}
+
+TypeId RangeCulledWifiPhy::GetTypeId(void) {
+    static TypeId tid = TypeId("ns3::RangeCulledWifiPhy")
+        .SetParent<YansWifiPhy>()
+        .SetGroupName("Wifi")
+        .AddConstructor<RangeCulledWifiPhy>();
+    return tid;
+}
+
+void RangeCulledWifiPhy::StartTx(Ptr<const WifiPpdu> ppdu) {
+    Ptr<RangeCulledWifiChannel> channel = DynamicCast<RangeCulledWifiChannel>(GetChannel());
+    if (!channel) {
+        YansWifiPhy::StartTx(ppdu);
+        return;
+    }
+    channel->Send(this, ppdu, GetTxPowerForTransmission(ppdu) + GetTxGain());
+}
+
+RangeCulledWifiPhyHelper::RangeCulledWifiPhyHelper() {
+    m_phys.front().SetTypeId("ns3::RangeCulledWifiPhy");
+}
+
+} // namespace ns3
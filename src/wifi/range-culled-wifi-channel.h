@@ -0,0 +1,112 @@
+#ifndef RANGE_CULLED_WIFI_CHANNEL_H
+#define RANGE_CULLED_WIFI_CHANNEL_H
+
+#include "ns3/nstime.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/vector.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * YansWifiChannel that only schedules a reception on the PHYs a frame can
+ * actually reach.
+ *
+ * YansWifiChannel::Send schedules a Receive event on every other PHY and
+ * the ones below their sensitivity drop the frame when it fires, so every
+ * broadcast costs one event per PHY of the simulation. Here:
+ *  - the PHYs are bucketed by position in a grid of MaxRange cells, and a
+ *    frame only looks at the cells within MaxRange (plus the distance a
+ *    receiver may have flown, at MaxSpeed, since the grid was built);
+ *  - with PowerCulling the rx power of the remaining PHYs is compared with
+ *    their sensitivity before scheduling, the same test Receive does.
+ * The PHYs that still receive get their events in the YansWifiChannel order.
+ *
+ * A negative MaxRange is estimated from the loss model, the distance past
+ * which the strongest transmitter falls below the lowest sensitivity in any
+ * of a horizontal, diagonal or vertical direction; this assumes a
+ * deterministic loss growing with distance. Zero disables the grid.
+ *
+ * Only RangeCulledWifiPhy transmits through Send (YansWifiChannel::Send is
+ * not virtual), RangeCulledWifiPhyHelper installs it.
+ */
+class RangeCulledWifiChannel : public YansWifiChannel {
+public:
+  static TypeId GetTypeId(void);
+  RangeCulledWifiChannel();
+
+  // Also kept here, the ones of YansWifiChannel are private
+  void SetPropagationLossModel(const Ptr<PropagationLossModel> loss);
+  void SetPropagationDelayModel(const Ptr<PropagationDelayModel> delay);
+  // Model probed for a negative MaxRange, the loss model by default (use
+  // the uncached one when the loss is cached per position cell)
+  void SetRangeModel(const Ptr<PropagationLossModel> loss);
+
+  void Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
+
+  // Range in use, 0 when unbounded
+  double GetRange(void) const;
+  uint64_t GetScheduled(void) const;
+  uint64_t GetOutOfRange(void) const;
+  uint64_t GetBelowSensitivity(void) const;
+
+  // Distance past which txPowerDbm falls below thresholdDbm, 0 if it
+  // never does within 100 km
+  static double EstimateRange(Ptr<PropagationLossModel> loss, double txPowerDbm, double thresholdDbm);
+
+private:
+  void DoDispose(void) override;
+
+  static void Receive(Ptr<YansWifiPhy> receiver, Ptr<const WifiPpdu> ppdu, double rxPowerDbm);
+  void Refresh(void) const;
+  int64_t CellKey(int64_t x, int64_t y) const;
+  bool CanReceive(Ptr<YansWifiPhy> receiver, double rxPowerDbm, uint16_t width) const;
+
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+  Ptr<PropagationLossModel> m_rangeModel;
+  double m_maxRange;
+  double m_maxSpeed;
+  Time m_refresh;
+  bool m_powerCulling;
+
+  // PHYs in YansWifiChannel order and their grid
+  mutable std::vector<Ptr<YansWifiPhy>> m_phys;
+  mutable std::vector<Vector> m_positions;   //!< At the last Refresh
+  mutable std::unordered_map<int64_t, std::vector<uint32_t>> m_cells;
+  mutable std::size_t m_devices;
+  mutable double m_range;
+  mutable bool m_rangeKnown;
+  mutable Time m_built;
+  mutable std::vector<uint32_t> m_candidates;
+
+  mutable uint64_t m_scheduled;
+  mutable uint64_t m_outOfRange;
+  mutable uint64_t m_belowSensitivity;
+};
+
+// YansWifiPhy sending through RangeCulledWifiChannel::Send
+class RangeCulledWifiPhy : public YansWifiPhy {
+public:
+  static TypeId GetTypeId(void);
+
+  void StartTx(Ptr<const WifiPpdu> ppdu) override;
+};
+
+// YansWifiPhyHelper creating RangeCulledWifiPhy
+class RangeCulledWifiPhyHelper : public YansWifiPhyHelper {
+public:
+  RangeCulledWifiPhyHelper();
+};
+
+} // namespace ns3
+
+#endif // RANGE_CULLED_WIFI_CHANNEL_H